@@ -12,6 +12,9 @@
  * - Real-time line detection
  * - Web interface for camera feed and settings
  * - Optimized settings for different lighting conditions
+ * - Binary line-state link to the robot controller over UART (LineLink)
+ * - Multi-client MJPEG stream that never slows down detection
+ * - Raw frame recording (/capture-raw) for offline replay and benchmarking
  */
 
 #include "esp_camera.h"
@@ -22,7 +25,12 @@
 #include "soc/soc.h"
 #include "soc/rtc_cntl_reg.h"
 #include "esp_http_server.h"
+#include "lwip/sockets.h"
 #include <WiFi.h>
+#include <Preferences.h>
+#include <stddef.h>
+#include <LineVision.h>
+#include <LineLink.h>
 
 // WiFi credentials
 const char* ssid = "ESP32-CAM-LineBot";
@@ -46,6 +54,18 @@ const char* password = "linedetect123";
 #define HREF_GPIO_NUM     23
 #define PCLK_GPIO_NUM     22
 
+// UART link to the robot controller (SD card slot pins, SD unused)
+#define LINK_TX_PIN       14
+#define LINK_RX_PIN       15
+#define LINK_BAUD         LINE_LINK_DEFAULT_BAUD
+
+// Camera mounting (see ROBOT_GEOMETRY.md, section 9)
+#define CAMERA_HEIGHT_MM      120.0
+#define CAMERA_TILT_DEG       35.0
+#define CAMERA_HFOV_DEG       60.0
+#define CAMERA_OFFSET_MM      40.0
+#define SHARP_TURN_CURVATURE  6.0   // 1/m
+
 // Camera settings for line detection
 typedef struct {
     int brightness;    // -2 to 2
@@ -156,11 +176,153 @@ CameraSettings presets[3] = {
 };
 
 int currentPreset = 2; // Default to high contrast preset
+
+// Desired settings (written by /control) and what the sensor registers hold.
+// Only differing fields are written, between frames, by the detection loop.
 CameraSettings currentSettings;
+CameraSettings appliedSettings;
+bool appliedSettingsValid = false;
+volatile bool settingsDirty = false;
+portMUX_TYPE settingsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Saved settings in NVS
+#define NVS_NAMESPACE       "camera"
+#define NVS_SETTINGS_SLOTS  4       // Slot 0 is applied at boot
+
+// CameraSettings field descriptor for /control and register diffing
+typedef struct {
+    const char* name;
+    size_t offset;
+    int minValue;
+    int maxValue;
+    int (*apply)(sensor_t* s, int value);
+} CameraSettingField;
+
+#define SETTING_FIELD(field, lo, hi, setter) \
+    { #field, offsetof(CameraSettings, field), lo, hi, [](sensor_t* s, int v) { return s->setter(s, v); } }
+
+// Same order as the original applyCameraSettings (exposure/gain modes before values)
+const CameraSettingField settingFields[] = {
+    SETTING_FIELD(brightness,    -2,    2, set_brightness),
+    SETTING_FIELD(contrast,      -2,    2, set_contrast),
+    SETTING_FIELD(saturation,    -2,    2, set_saturation),
+    SETTING_FIELD(sharpness,     -2,    2, set_sharpness),
+    SETTING_FIELD(quality,       10,   63, set_quality),
+    SETTING_FIELD(whitebal,       0,    1, set_whitebal),
+    SETTING_FIELD(awb_gain,       0,    1, set_awb_gain),
+    SETTING_FIELD(wb_mode,        0,    4, set_wb_mode),
+    SETTING_FIELD(exposure_ctrl,  0,    1, set_exposure_ctrl),
+    SETTING_FIELD(aec2,           0,    1, set_aec2),
+    SETTING_FIELD(ae_level,      -2,    2, set_ae_level),
+    SETTING_FIELD(aec_value,      0, 1200, set_aec_value),
+    SETTING_FIELD(gain_ctrl,      0,    1, set_gain_ctrl),
+    SETTING_FIELD(agc_gain,       0,   30, set_agc_gain),
+    { "gainceiling", offsetof(CameraSettings, gainceiling), 0, 6,
+      [](sensor_t* s, int v) { return s->set_gainceiling(s, (gainceiling_t)v); } },
+    SETTING_FIELD(bpc,            0,    1, set_bpc),
+    SETTING_FIELD(wpc,            0,    1, set_wpc),
+    SETTING_FIELD(raw_gma,        0,    1, set_raw_gma),
+    SETTING_FIELD(lenc,           0,    1, set_lenc),
+    SETTING_FIELD(hmirror,        0,    1, set_hmirror),
+    SETTING_FIELD(vflip,          0,    1, set_vflip),
+    SETTING_FIELD(dcw,            0,    1, set_dcw),
+    SETTING_FIELD(colorbar,       0,    1, set_colorbar),
+};
+
+#define SETTING_FIELD_COUNT (int)(sizeof(settingFields) / sizeof(settingFields[0]))
+static_assert(sizeof(settingFields) / sizeof(settingFields[0]) <= 32, "field masks are 32-bit");
 
 httpd_handle_t camera_httpd = NULL;
 httpd_handle_t stream_httpd = NULL;
 
+// MJPEG stream parameters
+#define STREAM_MAX_CLIENTS   3      // Simultaneous /stream viewers
+#define STREAM_MAX_FPS       10     // Stream rate cap, independent of detection rate
+#define STREAM_JPEG_QUALITY  80     // fmt2jpg quality (0-100)
+#define STREAM_TASK_STACK    8192
+
+static const char* STREAM_HTTP_HEADER =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: multipart/x-mixed-replace;boundary=frame\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "Cache-Control: no-cache\r\n"
+    "\r\n";
+static const char* STREAM_PART = "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n";
+static const char* STREAM_PART_TAIL = "\r\n";
+
+// Encoded frame shared by all clients, freed with the last reference
+typedef struct {
+    uint8_t* buf;
+    size_t len;
+    int refs;
+} StreamJpeg;
+
+// One /stream viewer
+typedef struct {
+    int fd;                  // Socket, -1 = free slot
+    bool closing;            // Session ended in httpd; the stream task closes fd and frees the slot
+    uint32_t intervalMs;     // Per-client pacing (?fps=)
+    uint32_t lastFrameMs;
+    StreamJpeg* jpeg;        // Frame being sent, NULL when idle
+    char part[80];           // Multipart header of the current frame
+    size_t partLen;
+    size_t sent;             // Bytes of header + JPEG + tail already sent
+    uint32_t framesSent;
+    uint32_t framesDropped;
+} StreamClient;
+
+// Grayscale frame handed from the detection loop to the stream task
+typedef struct {
+    uint8_t* pixels;
+    int width;
+    int height;
+    RowCentroid centroids[CURVE_FIT_MAX_POINTS];
+    int centroidCount;
+    LineEstimate estimate;
+} StreamSnapshot;
+
+StreamClient streamClients[STREAM_MAX_CLIENTS];
+volatile int streamClientCount = 0;
+SemaphoreHandle_t streamClientsMutex = NULL;
+
+StreamSnapshot streamSnapshots[2];
+size_t streamSnapshotCapacity = 0;
+int streamReadyIndex = -1;   // Newest snapshot waiting for the encoder
+int streamBusyIndex = -1;    // Snapshot being encoded
+SemaphoreHandle_t streamFrameMutex = NULL;
+TaskHandle_t streamTaskHandle = NULL;
+uint32_t streamLastPublishMs = 0;
+bool streamOverlay = true;   // Draw scan band and centroids (?overlay=0 to disable)
+
+// /capture-raw recording: the detection loop copies frames into a ring,
+// the HTTP handler drains it (the loop keeps the camera, as for /stream)
+#define RAW_CAPTURE_MAX_FRAMES   300
+#define RAW_CAPTURE_SLOTS_PSRAM  16     // Ring of frame copies: ~300 KB at QQVGA
+#define RAW_CAPTURE_SLOTS_DRAM   2      // Without PSRAM
+#define RAW_CAPTURE_TIMEOUT_MS   1000   // No frame from the loop for this long - end the recording
+
+typedef struct {
+    uint8_t* pixels;
+    size_t len;
+    uint32_t timestampUs;
+    bool full;               // Copied by the loop, not yet sent
+} RawCaptureSlot;
+
+RawCaptureSlot rawSlots[RAW_CAPTURE_SLOTS_PSRAM];
+int rawSlotCount = 0;
+size_t rawSlotCapacity = 0;
+volatile bool rawCapturing = false;   // Loop copies frames while set
+int rawWanted = 0;                    // Frames the request asked for
+int rawQueued = 0;                    // Frames copied so far
+int rawWriteIndex = 0;
+int rawWidth = 0;                     // Frame size of the recording
+int rawHeight = 0;
+bool rawWrongFormat = false;          // Recording ended on a non-grayscale frame
+volatile uint32_t rawDropped = 0;     // Ring full or handler busy - frame skipped
+volatile size_t rawFrameBytes = 0;    // Size of the loop's last frame
+SemaphoreHandle_t rawCaptureMutex = NULL;
+TaskHandle_t rawReaderTask = NULL;
+
 // Line detection parameters
 #define LINE_THRESHOLD 128  // Threshold for binary conversion
 #define MIN_LINE_WIDTH 10   // Minimum width to consider as a line
@@ -171,9 +333,32 @@ typedef struct {
     int linePosition;     // Position from left (0-100%)
     int lineWidth;        // Width of detected line
     int confidence;       // Confidence level (0-100)
+    float heading;        // Line heading in radians (+ = right)
+    float curvature;      // Line curvature in 1/m (+ = right)
 } LineDetectionResult;
 
-LineDetectionResult lastResult = {false, 0, 0, 0};
+LineDetectionResult lastResult = {false, 0, 0, 0, 0.0, 0.0};
+
+LineDetector lineDetector;
+LineEstimate lastEstimate;
+uint16_t linkSeq = 0;
+
+// Connected components for crossings, branches and side markers
+BlobLabeler blobLabeler;
+JunctionClassifier junctionClassifier;
+SceneInfo lastScene = {JUNCTION_NONE, 0, -1, -1, 0, false, false};
+
+// Line-contrast exposure control (/control?line_aec=1). Replaces the sensor
+// AEC/AGC, which targets average brightness, with a loop that maximizes the
+// line / field histogram separation measured by the detector.
+#define LINE_AEC_MIN_EXPOSURE  8
+#define LINE_AEC_MAX_EXPOSURE  600   // Longer exposures blur the line at speed
+#define LINE_AEC_MAX_GAIN      12    // agc_gain index (OV2640 table), 12 = 13x
+#define LINE_AEC_SETTLE_FRAMES 3     // OV2640 needs ~2 frames to apply a new exposure
+
+ContrastExposure exposureControl;
+bool lineAecEnabled = false;
+volatile int lineAecRequest = -1;   // Set by /control, consumed in loop()
 
 void setup() {
     WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0); // Disable brownout detector
@@ -191,8 +376,24 @@ void setup() {
         return;
     }
     
-    // Load preset configuration
-    loadPreset(currentPreset);
+    // Load preset configuration (NVS slot 0 overrides the built-in preset)
+    CameraSettings saved;
+    if (loadSettingsSlot(0, saved)) {
+        commitSettings(saved);
+        Serial.println("Loaded camera settings from NVS slot 0");
+    } else {
+        loadPreset(currentPreset);
+    }
+    applyCameraSettings();
+    
+    // Line detector and UART link to the robot
+    lineDetector.setMounting(CAMERA_HEIGHT_MM, CAMERA_TILT_DEG, CAMERA_HFOV_DEG, CAMERA_OFFSET_MM);
+    lineDetector.setThreshold(LINE_THRESHOLD);
+    lineDetector.setMinWidth(MIN_LINE_WIDTH);
+    exposureControl.setLimits(LINE_AEC_MIN_EXPOSURE, LINE_AEC_MAX_EXPOSURE, LINE_AEC_MAX_GAIN);
+    exposureControl.setSettleFrames(LINE_AEC_SETTLE_FRAMES);
+    Serial1.begin(LINK_BAUD, SERIAL_8N1, LINK_RX_PIN, LINK_TX_PIN);
+    Serial.printf("Line link: UART1 TX=GPIO%d @ %d baud\n", LINK_TX_PIN, LINK_BAUD);
     
     // Start WiFi Access Point
     WiFi.softAP(ssid, password);
@@ -206,7 +407,9 @@ void setup() {
     Serial.print("AP IP address: ");
     Serial.println(IP);
     
-    // Start web server
+    // Start web server and the stream task
+    initStreaming();
+    rawCaptureMutex = xSemaphoreCreateMutex();
     startCameraServer();
     
     Serial.println("\n=================================");
@@ -216,14 +419,19 @@ void setup() {
     Serial.print("http://");
     Serial.println(IP);
     Serial.println("\nEndpoints:");
-    Serial.println("  /           - Camera stream");
+    Serial.println("  /           - Web interface");
+    Serial.println("  :81/stream  - MJPEG stream (?fps=1..10, ?overlay=0|1)");
     Serial.println("  /capture    - Single frame capture");
     Serial.println("  /settings   - Adjust camera settings");
     Serial.println("  /detect     - Line detection status");
+    Serial.println("  /capture-raw - Raw grayscale frames for tools/replay (?frames=N, ?format=pgm)");
     Serial.println("=================================\n");
 }
 
 void loop() {
+    // Pending /control changes are written here, between frames
+    applyCameraSettings();
+    
     // Perform line detection
     camera_fb_t * fb = esp_camera_fb_get();
     if (!fb) {
@@ -234,17 +442,30 @@ void loop() {
     
     // Detect line in the captured frame
     detectLine(fb);
+    analyzeScene(fb);
+    
+    // Step exposure toward maximum line contrast (applied before the next frame)
+    updateLineExposure();
+    
+    // Publish to the robot controller as soon as the estimate is ready
+    sendLineState(fb);
+    
+    // Hand a copy to the stream task if a viewer is due a frame
+    publishStreamFrame(fb);
+    
+    // And to /capture-raw if a recording is running
+    recordRawFrame(fb);
     
     // Return the frame buffer
     esp_camera_fb_return(fb);
     
-    // Print detection result
-    if (lastResult.lineDetected) {
+    // Print detection result (throttled - Serial is much slower than the link)
+    static unsigned long lastPrintTime = 0;
+    if (lastResult.lineDetected && millis() - lastPrintTime > 500) {
         Serial.printf("Line detected at position %d%% (width: %dpx, confidence: %d%%)\n", 
                       lastResult.linePosition, lastResult.lineWidth, lastResult.confidence);
+        lastPrintTime = millis();
     }
-    
-    delay(100); // Adjust based on your needs
 }
 
 bool initCamera() {
@@ -268,15 +489,15 @@ bool initCamera() {
     config.pin_pwdn = PWDN_GPIO_NUM;
     config.pin_reset = RESET_GPIO_NUM;
     config.xclk_freq_hz = 20000000;
-    config.pixel_format = PIXFORMAT_JPEG;
+    config.pixel_format = PIXFORMAT_GRAYSCALE;  // Detection works on raw pixels
     
-    // Init with high specs to pre-allocate larger buffers
+    // Small frames keep detection and the UART link at full frame rate
     if(psramFound()){
-        config.frame_size = FRAMESIZE_QVGA; // 320x240
+        config.frame_size = FRAMESIZE_QQVGA; // 160x120
         config.jpeg_quality = 10;
         config.fb_count = 2;
     } else {
-        config.frame_size = FRAMESIZE_QVGA;
+        config.frame_size = FRAMESIZE_QQVGA;
         config.jpeg_quality = 12;
         config.fb_count = 1;
     }
@@ -291,72 +512,230 @@ bool initCamera() {
     sensor_t * s = esp_camera_sensor_get();
     
     // Initial sensor settings for line detection
-    s->set_framesize(s, FRAMESIZE_QVGA); // 320x240
+    s->set_framesize(s, FRAMESIZE_QQVGA); // 160x120
     
     Serial.println("Camera initialized successfully!");
     return true;
 }
 
+int settingValue(const CameraSettings& settings, int field) {
+    return *(const int*)((const uint8_t*)&settings + settingFields[field].offset);
+}
+
+void setSettingValue(CameraSettings& settings, int field, int value) {
+    *(int*)((uint8_t*)&settings + settingFields[field].offset) = value;
+}
+
+// Replace the desired settings; the detection loop writes them between frames
+void commitSettings(const CameraSettings& settings) {
+    portENTER_CRITICAL(&settingsMux);
+    currentSettings = settings;
+    settingsDirty = true;
+    portEXIT_CRITICAL(&settingsMux);
+}
+
+// Merge only the fields in fieldMask (bit i = settingFields[i]) into the
+// desired settings, so fields changed meanwhile by another task survive
+void commitSettingFields(const CameraSettings& settings, uint32_t fieldMask) {
+    portENTER_CRITICAL(&settingsMux);
+    for (int i = 0; i < SETTING_FIELD_COUNT; i++) {
+        if (fieldMask & (1u << i)) {
+            setSettingValue(currentSettings, i, settingValue(settings, i));
+        }
+    }
+    settingsDirty = true;
+    portEXIT_CRITICAL(&settingsMux);
+}
+
+// Manual exposure and gain from line AEC; the rest of the settings stay as they are
+void commitExposure(int exposure, int gain) {
+    portENTER_CRITICAL(&settingsMux);
+    currentSettings.exposure_ctrl = 0;   // A preset loaded meanwhile may have re-enabled AEC
+    currentSettings.aec2 = 0;
+    currentSettings.gain_ctrl = 0;
+    currentSettings.aec_value = exposure;
+    currentSettings.agc_gain = gain;
+    settingsDirty = true;
+    portEXIT_CRITICAL(&settingsMux);
+}
+
+CameraSettings getCurrentSettings() {
+    portENTER_CRITICAL(&settingsMux);
+    CameraSettings settings = currentSettings;
+    portEXIT_CRITICAL(&settingsMux);
+    return settings;
+}
+
 void loadPreset(int presetIndex) {
     if (presetIndex < 0 || presetIndex > 2) {
         presetIndex = 2; // Default to high contrast
     }
     
-    currentSettings = presets[presetIndex];
-    applyCameraSettings();
+    commitSettings(presets[presetIndex]);
     
     const char* presetNames[] = {"Bright Lighting", "Low Light", "High Contrast (Line Detection)"};
     Serial.printf("Loaded preset %d: %s\n", presetIndex, presetNames[presetIndex]);
 }
 
+// Write only the registers that differ from what the sensor already has.
+// Called from the detection loop between esp_camera_fb_return and the next
+// esp_camera_fb_get. With fb_count=2 in continuous grab mode the DMA keeps
+// filling the other buffer meanwhile, so the next frame or two may be
+// exposed partly with the old settings (line AEC waits LINE_AEC_SETTLE_FRAMES).
 void applyCameraSettings() {
+    if (!settingsDirty) {
+        return;
+    }
+    
+    portENTER_CRITICAL(&settingsMux);
+    CameraSettings target = currentSettings;
+    settingsDirty = false;
+    portEXIT_CRITICAL(&settingsMux);
+    
     sensor_t * s = esp_camera_sensor_get();
     
-    s->set_brightness(s, currentSettings.brightness);
-    s->set_contrast(s, currentSettings.contrast);
-    s->set_saturation(s, currentSettings.saturation);
-    s->set_sharpness(s, currentSettings.sharpness);
-    s->set_quality(s, currentSettings.quality);
-    s->set_whitebal(s, currentSettings.whitebal);
-    s->set_awb_gain(s, currentSettings.awb_gain);
-    s->set_wb_mode(s, currentSettings.wb_mode);
-    s->set_exposure_ctrl(s, currentSettings.exposure_ctrl);
-    s->set_aec2(s, currentSettings.aec2);
-    s->set_ae_level(s, currentSettings.ae_level);
-    s->set_aec_value(s, currentSettings.aec_value);
-    s->set_gain_ctrl(s, currentSettings.gain_ctrl);
-    s->set_agc_gain(s, currentSettings.agc_gain);
-    s->set_gainceiling(s, (gainceiling_t)currentSettings.gainceiling);
-    s->set_bpc(s, currentSettings.bpc);
-    s->set_wpc(s, currentSettings.wpc);
-    s->set_raw_gma(s, currentSettings.raw_gma);
-    s->set_lenc(s, currentSettings.lenc);
-    s->set_hmirror(s, currentSettings.hmirror);
-    s->set_vflip(s, currentSettings.vflip);
-    s->set_dcw(s, currentSettings.dcw);
-    s->set_colorbar(s, currentSettings.colorbar);
-    
-    Serial.println("Camera settings applied");
+    for (int i = 0; i < SETTING_FIELD_COUNT; i++) {
+        int value = settingValue(target, i);
+        if (!appliedSettingsValid || settingValue(appliedSettings, i) != value) {
+            settingFields[i].apply(s, value);
+        }
+    }
+    
+    appliedSettings = target;
+    appliedSettingsValid = true;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// Saved presets (NVS)
+// ═══════════════════════════════════════════════════════════════════════════
+
+bool saveSettingsSlot(int slot, const CameraSettings& settings) {
+    if (slot < 0 || slot >= NVS_SETTINGS_SLOTS) return false;
+    
+    char key[8];
+    snprintf(key, sizeof(key), "slot%d", slot);
+    
+    Preferences prefs;
+    prefs.begin(NVS_NAMESPACE, false);
+    size_t written = prefs.putBytes(key, &settings, sizeof(CameraSettings));
+    prefs.end();
+    
+    Serial.printf("Camera settings saved to NVS slot %d\n", slot);
+    return written == sizeof(CameraSettings);
+}
+
+bool loadSettingsSlot(int slot, CameraSettings& settings) {
+    if (slot < 0 || slot >= NVS_SETTINGS_SLOTS) return false;
+    
+    char key[8];
+    snprintf(key, sizeof(key), "slot%d", slot);
+    
+    Preferences prefs;
+    prefs.begin(NVS_NAMESPACE, true);
+    bool ok = prefs.getBytesLength(key) == sizeof(CameraSettings) &&
+              prefs.getBytes(key, &settings, sizeof(CameraSettings)) == sizeof(CameraSettings);
+    prefs.end();
+    
+    return ok;
 }
 
 void detectLine(camera_fb_t * fb) {
-    // Simple line detection algorithm
-    // This analyzes the middle horizontal line of the image
+    // Row centroids -> floor projection -> robust curve fit (LineVision)
     
-    if (fb->format != PIXFORMAT_JPEG) {
+    if (fb->format != PIXFORMAT_GRAYSCALE) {
         lastResult.lineDetected = false;
+        lastEstimate.detected = false;
         return;
     }
     
-    // For this basic implementation, we'll analyze pixel intensities
-    // In a real application, you would decode the JPEG and process the raw pixels
+    LineEstimate estimate;
+    lineDetector.detect(fb->buf, fb->width, fb->height, estimate);
+    
+    lastResult.lineDetected = estimate.detected;
+    lastResult.linePosition = estimate.positionPercent;
+    lastResult.lineWidth = estimate.widthPx;
+    lastResult.confidence = estimate.confidence;
+    lastResult.heading = estimate.headingRad;
+    lastResult.curvature = estimate.curvature;
     
-    // For demonstration, we'll set a mock result
-    // In production, implement proper image processing
-    lastResult.lineDetected = true;
-    lastResult.linePosition = 50; // Center
-    lastResult.lineWidth = 20;
-    lastResult.confidence = 85;
+    lastEstimate = estimate;
+}
+
+void analyzeScene(camera_fb_t * fb) {
+    // All dark runs, not just the first per row, so crossings and markers show up
+    if (fb->format != PIXFORMAT_GRAYSCALE) {
+        lastScene.junction = JUNCTION_NONE;
+        lastScene.exits = 0;
+        lastScene.markerLeft = false;
+        lastScene.markerRight = false;
+        return;
+    }
+    blobLabeler.label(fb->buf, fb->width, fb->height, lineDetector.getThreshold());
+    junctionClassifier.classify(blobLabeler, lastScene);
+}
+
+void updateLineExposure() {
+    int request = lineAecRequest;
+    if (request >= 0) {
+        lineAecRequest = -1;
+        lineAecEnabled = request != 0;
+        if (lineAecEnabled) {
+            // Start from the values the sensor is using now, in manual mode
+            CameraSettings settings = getCurrentSettings();
+            exposureControl.reset(settings.aec_value, settings.agc_gain);
+            commitExposure(settings.aec_value, settings.agc_gain);
+        } else {
+            lineDetector.setThreshold(LINE_THRESHOLD);
+        }
+        Serial.printf("Line-contrast exposure %s\n", lineAecEnabled ? "enabled" : "disabled");
+    }
+    if (!lineAecEnabled) return;
+    
+    const ContrastStats& stats = lineDetector.getContrast();
+    
+    // Exposure moves the peaks, so binarize between them instead of at a fixed level
+    if (stats.valid) {
+        lineDetector.setThreshold((stats.linePeak + stats.fieldPeak) / 2);
+    }
+    
+    int exposure, gain;
+    if (exposureControl.update(stats, exposure, gain)) {
+        commitExposure(exposure, gain);   // Only the changed registers are written
+    }
+}
+
+void sendLineState(camera_fb_t * fb) {
+    // Capture time from the driver (esp_timer, same clock as micros())
+    uint32_t captureUs = (uint32_t)(fb->timestamp.tv_sec * 1000000ULL + fb->timestamp.tv_usec);
+    
+    LineLinkState state;
+    state.seq = linkSeq++;
+    state.captureUs = captureUs;
+    state.latencyUs = (uint32_t)micros() - captureUs;
+    state.positionMm = lastEstimate.positionMm;
+    state.headingRad = lastEstimate.headingRad;
+    state.curvature = lastEstimate.curvature;
+    state.refForwardMm = (int16_t)lastEstimate.refForwardMm;
+    state.confidence = (uint8_t)lastEstimate.confidence;
+    state.flags = 0;
+    if (lastEstimate.detected) {
+        state.flags |= LINE_LINK_FLAG_DETECTED;
+    }
+    if (abs(lastEstimate.curvature) > SHARP_TURN_CURVATURE || abs(lastEstimate.headingRad) > 30.0 * DEG_TO_RAD) {
+        state.flags |= LINE_LINK_FLAG_SHARP_TURN;
+    }
+    if (lastScene.junction != JUNCTION_NONE) {
+        state.flags |= LINE_LINK_FLAG_JUNCTION;
+        if (lastScene.exits & JUNCTION_EXIT_LEFT) state.flags |= LINE_LINK_FLAG_EXIT_LEFT;
+        if (lastScene.exits & JUNCTION_EXIT_RIGHT) state.flags |= LINE_LINK_FLAG_EXIT_RIGHT;
+        if (lastScene.exits & JUNCTION_EXIT_AHEAD) state.flags |= LINE_LINK_FLAG_EXIT_AHEAD;
+    }
+    if (lastScene.markerLeft) state.flags |= LINE_LINK_FLAG_MARKER_L;
+    if (lastScene.markerRight) state.flags |= LINE_LINK_FLAG_MARKER_R;
+    
+    uint8_t frame[LINE_LINK_MAX_FRAME];
+    size_t len = lineLinkEncodeState(state, frame);
+    Serial1.write(frame, len);  // Goes to the UART FIFO, does not block for 26 bytes
 }
 
 // Web server handlers
@@ -386,7 +765,7 @@ static esp_err_t index_handler(httpd_req_t *req) {
         <h1>ESP32-CAM Line Detection System</h1>
         
         <h2>Camera Stream</h2>
-        <img class="stream" src="/stream" id="stream">
+        <img class="stream" id="stream">
         
         <div class="status" id="status">
             <strong>Status:</strong> <span id="statusText">Initializing...</span>
@@ -457,6 +836,9 @@ static esp_err_t index_handler(httpd_req_t *req) {
                 });
         }
         
+        // Stream is served by the second httpd instance on port 81
+        document.getElementById('stream').src = 'http://' + location.hostname + ':81/stream';
+        
         // Update detection status every second
         setInterval(updateDetection, 1000);
         
@@ -474,95 +856,654 @@ static esp_err_t index_handler(httpd_req_t *req) {
     return httpd_resp_send(req, html, strlen(html));
 }
 
+// ═══════════════════════════════════════════════════════════════════════════
+// MJPEG streaming
+//
+// The detection loop owns the camera. When a stream frame is due it copies
+// the grayscale frame into a snapshot (try-lock, never waits) and wakes the
+// stream task on core 0, which draws the overlay, encodes one JPEG and
+// shares it between all clients. Each client is paced independently and a
+// client whose socket is backed up skips frames, always getting the newest
+// one once it catches up.
+// ═══════════════════════════════════════════════════════════════════════════
+
 static esp_err_t stream_handler(httpd_req_t *req) {
-    camera_fb_t * fb = NULL;
-    esp_err_t res = ESP_OK;
-    size_t _jpg_buf_len = 0;
-    uint8_t * _jpg_buf = NULL;
-    char * part_buf[64];
+    char query[64];
+    char param[8];
+    int fps = STREAM_MAX_FPS;
     
-    static const char* _STREAM_CONTENT_TYPE = "multipart/x-mixed-replace;boundary=frame";
-    static const char* _STREAM_BOUNDARY = "\r\n--frame\r\n";
-    static const char* _STREAM_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n";
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "fps", param, sizeof(param)) == ESP_OK) {
+            fps = constrain(atoi(param), 1, STREAM_MAX_FPS);
+        }
+        if (httpd_query_key_value(query, "overlay", param, sizeof(param)) == ESP_OK) {
+            streamOverlay = atoi(param) != 0;
+        }
+    }
+    
+    int fd = httpd_req_to_sockfd(req);
+    
+    xSemaphoreTake(streamClientsMutex, portMAX_DELAY);
+    StreamClient* client = NULL;
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (streamClients[i].fd < 0) {
+            client = &streamClients[i];
+            break;
+        }
+    }
     
-    res = httpd_resp_set_type(req, _STREAM_CONTENT_TYPE);
-    if(res != ESP_OK){
-        return res;
+    if (!client) {
+        xSemaphoreGive(streamClientsMutex);
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_type(req, "text/plain");
+        return httpd_resp_send(req, "Too many stream clients", HTTPD_RESP_USE_STRLEN);
     }
     
-    while(true){
-        fb = esp_camera_fb_get();
-        if (!fb) {
-            Serial.println("Camera capture failed");
-            res = ESP_FAIL;
-        } else {
-            if(fb->format != PIXFORMAT_JPEG){
-                bool jpeg_converted = frame2jpg(fb, 80, &_jpg_buf, &_jpg_buf_len);
-                esp_camera_fb_return(fb);
-                fb = NULL;
-                if(!jpeg_converted){
-                    Serial.println("JPEG compression failed");
-                    res = ESP_FAIL;
-                }
-            } else {
-                _jpg_buf_len = fb->len;
-                _jpg_buf = fb->buf;
+    // The response header goes out directly, frames follow from the stream task
+    if (send(fd, STREAM_HTTP_HEADER, strlen(STREAM_HTTP_HEADER), 0) < 0) {
+        xSemaphoreGive(streamClientsMutex);
+        return ESP_FAIL;
+    }
+    
+    client->fd = fd;
+    client->closing = false;
+    client->intervalMs = 1000 / fps;
+    client->lastFrameMs = 0;
+    client->jpeg = NULL;
+    client->partLen = 0;
+    client->sent = 0;
+    client->framesSent = 0;
+    client->framesDropped = 0;
+    streamClientCount++;
+    xSemaphoreGive(streamClientsMutex);
+    
+    Serial.printf("Stream client connected (fd %d, %d fps)\n", fd, fps);
+    
+    // Keep the session open: httpd calls stream_close_fn when the peer goes away
+    return ESP_OK;
+}
+
+// httpd leaves closing the socket to close_fn. A stream slot's socket is
+// closed by the stream task when it frees the slot: closed here, lwIP could
+// hand the same fd number to a new viewer while the old slot still has it
+static void stream_close_fn(httpd_handle_t hd, int sockfd) {
+    bool deferred = false;
+    xSemaphoreTake(streamClientsMutex, portMAX_DELAY);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (streamClients[i].fd == sockfd) {
+            streamClients[i].closing = true;  // Released by the stream task
+            deferred = true;
+        }
+    }
+    xSemaphoreGive(streamClientsMutex);
+    if (!deferred) {
+        close(sockfd);
+    }
+}
+
+void initStreaming() {
+    streamClientsMutex = xSemaphoreCreateMutex();
+    streamFrameMutex = xSemaphoreCreateMutex();
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        streamClients[i].fd = -1;
+        streamClients[i].jpeg = NULL;
+    }
+    
+    // Core 0 with WiFi - encoding never competes with detection on core 1
+    xTaskCreatePinnedToCore(streamTask, "StreamTask", STREAM_TASK_STACK, NULL, 1, &streamTaskHandle, 0);
+}
+
+// Called from the detection loop for every frame - must stay cheap
+void publishStreamFrame(camera_fb_t * fb) {
+    if (streamClientCount == 0 || fb->format != PIXFORMAT_GRAYSCALE) {
+        return;
+    }
+    
+    uint32_t now = millis();
+    if (now - streamLastPublishMs < 1000 / STREAM_MAX_FPS) {
+        return;
+    }
+    
+    // Never wait for the stream task - skip this frame instead
+    if (xSemaphoreTake(streamFrameMutex, 0) != pdTRUE) {
+        return;
+    }
+    
+    size_t size = fb->width * fb->height;
+    if (size > streamSnapshotCapacity) {
+        // (Re)allocate only while no snapshot is being encoded
+        if (streamBusyIndex >= 0) {
+            xSemaphoreGive(streamFrameMutex);
+            return;
+        }
+        for (int i = 0; i < 2; i++) {
+            free(streamSnapshots[i].pixels);
+            streamSnapshots[i].pixels = (uint8_t*)(psramFound() ? ps_malloc(size) : malloc(size));
+        }
+        streamSnapshotCapacity = (streamSnapshots[0].pixels && streamSnapshots[1].pixels) ? size : 0;
+        streamReadyIndex = -1;
+        if (streamSnapshotCapacity == 0) {
+            xSemaphoreGive(streamFrameMutex);
+            return;
+        }
+    }
+    
+    // Overwrite the pending snapshot if the encoder has not taken it yet
+    int index = (streamBusyIndex == 0) ? 1 : 0;
+    StreamSnapshot& snap = streamSnapshots[index];
+    memcpy(snap.pixels, fb->buf, size);
+    snap.width = fb->width;
+    snap.height = fb->height;
+    const RowCentroid* centroids = lineDetector.getCentroids(snap.centroidCount);
+    memcpy(snap.centroids, centroids, snap.centroidCount * sizeof(RowCentroid));
+    snap.estimate = lastEstimate;
+    streamReadyIndex = index;
+    xSemaphoreGive(streamFrameMutex);
+    
+    streamLastPublishMs = now;
+    xTaskNotifyGive(streamTaskHandle);
+}
+
+// Detected line and scan band drawn into the snapshot before encoding
+void drawStreamOverlay(StreamSnapshot& snap) {
+    uint8_t* p = snap.pixels;
+    int w = snap.width;
+    int h = snap.height;
+    
+    // Scan band limits (dotted)
+    int bandRows[2] = {h / 6, (5 * h) / 6 - 1};
+    for (int i = 0; i < 2; i++) {
+        for (int x = 0; x < w; x += 2) {
+            p[bandRows[i] * w + x] = 255;
+        }
+    }
+    
+    // Row centroids as white marks on the dark line
+    for (int i = 0; i < snap.centroidCount; i++) {
+        int x = snap.centroids[i].centerQ8 >> ROW_CENTER_SHIFT;
+        int row = snap.centroids[i].row;
+        for (int dx = -1; dx <= 1; dx++) {
+            if (x + dx >= 0 && x + dx < w) {
+                p[row * w + x + dx] = 255;
             }
         }
-        if(res == ESP_OK){
-            size_t hlen = snprintf((char *)part_buf, 64, _STREAM_PART, _jpg_buf_len);
-            res = httpd_resp_send_chunk(req, (const char *)part_buf, hlen);
+    }
+    
+    // Robot center tick at the bottom
+    for (int y = h - 6; y < h; y++) {
+        p[y * w + w / 2] = 128;
+    }
+}
+
+// Take the newest snapshot and encode it; NULL if there is nothing new
+StreamJpeg* encodeStreamSnapshot() {
+    xSemaphoreTake(streamFrameMutex, portMAX_DELAY);
+    if (streamReadyIndex < 0) {
+        xSemaphoreGive(streamFrameMutex);
+        return NULL;
+    }
+    streamBusyIndex = streamReadyIndex;
+    streamReadyIndex = -1;
+    xSemaphoreGive(streamFrameMutex);
+    
+    StreamSnapshot& snap = streamSnapshots[streamBusyIndex];
+    if (streamOverlay) {
+        drawStreamOverlay(snap);
+    }
+    
+    StreamJpeg* jpeg = (StreamJpeg*)malloc(sizeof(StreamJpeg));
+    bool ok = jpeg && fmt2jpg(snap.pixels, snap.width * snap.height, snap.width, snap.height,
+                              PIXFORMAT_GRAYSCALE, STREAM_JPEG_QUALITY, &jpeg->buf, &jpeg->len);
+    
+    xSemaphoreTake(streamFrameMutex, portMAX_DELAY);
+    streamBusyIndex = -1;
+    xSemaphoreGive(streamFrameMutex);
+    
+    if (!ok) {
+        Serial.println("JPEG compression failed");
+        free(jpeg);
+        return NULL;
+    }
+    jpeg->refs = 1;
+    return jpeg;
+}
+
+void releaseStreamJpeg(StreamJpeg* jpeg) {
+    if (--jpeg->refs == 0) {
+        free(jpeg->buf);
+        free(jpeg);
+    }
+}
+
+// Continue sending the current frame to one client without blocking.
+// Returns false on a socket error.
+bool sendStreamClient(StreamClient& client) {
+    const uint8_t* parts[3] = {(const uint8_t*)client.part, client.jpeg->buf, (const uint8_t*)STREAM_PART_TAIL};
+    size_t sizes[3] = {client.partLen, client.jpeg->len, strlen(STREAM_PART_TAIL)};
+    size_t total = sizes[0] + sizes[1] + sizes[2];
+    
+    // Part header, JPEG and tail in one vectored send, resuming after a partial write
+    struct iovec iov[3];
+    int iovcnt = 0;
+    size_t skip = client.sent;
+    for (int i = 0; i < 3; i++) {
+        if (skip >= sizes[i]) {
+            skip -= sizes[i];
+            continue;
         }
-        if(res == ESP_OK){
-            res = httpd_resp_send_chunk(req, (const char *)_jpg_buf, _jpg_buf_len);
+        iov[iovcnt].iov_base = (void*)(parts[i] + skip);
+        iov[iovcnt].iov_len = sizes[i] - skip;
+        iovcnt++;
+        skip = 0;
+    }
+    
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+    
+    ssize_t n = sendmsg(client.fd, &msg, MSG_DONTWAIT);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK;  // Backed up, try later
+    }
+    
+    client.sent += n;
+    if (client.sent >= total) {
+        releaseStreamJpeg(client.jpeg);
+        client.jpeg = NULL;
+        client.framesSent++;
+    }
+    return true;
+}
+
+// Hand the new frame to due clients and flush pending data.
+// Returns true while some client still has unsent data.
+bool serviceStreamClients(StreamJpeg* jpeg) {
+    bool pending = false;
+    uint32_t now = millis();
+    
+    xSemaphoreTake(streamClientsMutex, portMAX_DELAY);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        StreamClient& client = streamClients[i];
+        if (client.fd < 0) continue;
+        
+        if (client.closing) {
+            if (client.jpeg) {
+                releaseStreamJpeg(client.jpeg);
+                client.jpeg = NULL;
+            }
+            Serial.printf("Stream client closed (fd %d, sent %u, dropped %u)\n",
+                          client.fd, client.framesSent, client.framesDropped);
+            close(client.fd);  // Deferred by stream_close_fn, now the fd may be reused
+            client.fd = -1;
+            streamClientCount--;
+            continue;
         }
-        if(res == ESP_OK){
-            res = httpd_resp_send_chunk(req, _STREAM_BOUNDARY, strlen(_STREAM_BOUNDARY));
+        
+        if (jpeg) {
+            if (client.jpeg) {
+                client.framesDropped++;  // Still sending an older frame
+            } else if (now - client.lastFrameMs >= client.intervalMs) {
+                jpeg->refs++;
+                client.jpeg = jpeg;
+                client.partLen = snprintf(client.part, sizeof(client.part), STREAM_PART, (unsigned)jpeg->len);
+                client.sent = 0;
+                client.lastFrameMs = now;
+            }
         }
-        if(fb){
-            esp_camera_fb_return(fb);
-            fb = NULL;
-            _jpg_buf = NULL;
-        } else if(_jpg_buf){
-            free(_jpg_buf);
-            _jpg_buf = NULL;
+        
+        if (client.jpeg) {
+            if (!sendStreamClient(client)) {
+                // Let httpd close the session; stream_close_fn marks the slot
+                httpd_sess_trigger_close(stream_httpd, client.fd);
+            } else if (client.jpeg) {
+                pending = true;
+            }
         }
-        if(res != ESP_OK){
-            break;
+    }
+    xSemaphoreGive(streamClientsMutex);
+    
+    return pending;
+}
+
+void streamTask(void* parameter) {
+    bool pending = false;
+    
+    while (true) {
+        // Wake on a new snapshot, or soon again while a client is backed up
+        ulTaskNotifyTake(pdTRUE, pending ? pdMS_TO_TICKS(5) : pdMS_TO_TICKS(100));
+        
+        StreamJpeg* jpeg = encodeStreamSnapshot();
+        pending = serviceStreamClients(jpeg);
+        if (jpeg) {
+            releaseStreamJpeg(jpeg);  // Drop the task's own reference
         }
     }
-    return res;
 }
 
+// /control?field=value[&field=value...]  - any CameraSettings field, as a batch
+// /control?preset=N                      - built-in preset (0-2)
+// /control?load=N / ?save=N              - NVS slot (0 is applied at boot)
+// /control?line_aec=0|1                  - line-contrast exposure control
+// Without parameters returns the current settings as JSON.
 static esp_err_t control_handler(httpd_req_t *req) {
-    char buf[128];
-    size_t buf_len;
-    char param[32];
-    
-    buf_len = httpd_req_get_url_query_len(req) + 1;
-    if (buf_len > 1) {
-        if (httpd_req_get_url_query_str(req, buf, buf_len) == ESP_OK) {
-            // Check for preset
-            if (httpd_query_key_value(buf, "preset", param, sizeof(param)) == ESP_OK) {
-                int preset = atoi(param);
-                loadPreset(preset);
+    char query[512];
+    char param[16];
+    int changed = 0;
+    bool replaceAll = false;     // Preset or saved slot: the whole set
+    uint32_t fieldMask = 0;      // Fields given in the query
+    
+    CameraSettings updated = getCurrentSettings();
+    
+    size_t queryLen = httpd_req_get_url_query_len(req) + 1;
+    if (queryLen > sizeof(query)) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Query too long");
+        return ESP_FAIL;
+    }
+    
+    bool haveQuery = queryLen > 1 && httpd_req_get_url_query_str(req, query, queryLen) == ESP_OK;
+    int saveSlot = -1;
+    
+    if (haveQuery) {
+        // Base: preset or saved slot, then individual fields on top
+        if (httpd_query_key_value(query, "preset", param, sizeof(param)) == ESP_OK) {
+            int preset = atoi(param);
+            if (preset < 0 || preset > 2) {
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "preset must be 0-2");
+                return ESP_FAIL;
+            }
+            updated = presets[preset];
+            replaceAll = true;
+            changed++;
+        }
+        if (httpd_query_key_value(query, "load", param, sizeof(param)) == ESP_OK) {
+            if (!loadSettingsSlot(atoi(param), updated)) {
+                httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No saved settings in this slot");
+                return ESP_FAIL;
+            }
+            replaceAll = true;
+            changed++;
+        }
+        
+        // Validate the whole batch before committing anything
+        for (int i = 0; i < SETTING_FIELD_COUNT; i++) {
+            if (httpd_query_key_value(query, settingFields[i].name, param, sizeof(param)) != ESP_OK) {
+                continue;
+            }
+            int value = atoi(param);
+            if (value < settingFields[i].minValue || value > settingFields[i].maxValue) {
+                char message[64];
+                snprintf(message, sizeof(message), "%s must be %d..%d",
+                         settingFields[i].name, settingFields[i].minValue, settingFields[i].maxValue);
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, message);
+                return ESP_FAIL;
+            }
+            fieldMask |= 1u << i;
+            if (settingValue(updated, i) != value) {
+                setSettingValue(updated, i, value);
+                changed++;
+            }
+        }
+        
+        if (httpd_query_key_value(query, "line_aec", param, sizeof(param)) == ESP_OK) {
+            lineAecRequest = atoi(param) != 0 ? 1 : 0;
+        }
+        
+        if (httpd_query_key_value(query, "save", param, sizeof(param)) == ESP_OK) {
+            saveSlot = atoi(param);
+            if (saveSlot < 0 || saveSlot >= NVS_SETTINGS_SLOTS) {
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "save slot out of range");
+                return ESP_FAIL;
             }
-            // Add more control parameters as needed
         }
     }
     
-    httpd_resp_set_type(req, "text/plain");
-    return httpd_resp_send(req, "OK", 2);
+    // The snapshot above may be older than a line-AEC commit from the
+    // detection loop: write back only what this request set
+    if (replaceAll) {
+        commitSettings(updated);
+    } else if (fieldMask) {
+        commitSettingFields(updated, fieldMask);
+    }
+    updated = getCurrentSettings();
+    if (changed > 0) {
+        Serial.printf("Camera settings: %d change(s) from /control\n", changed);
+    }
+    if (saveSlot >= 0) {
+        saveSettingsSlot(saveSlot, updated);
+    }
+    
+    // Respond with the resulting settings
+    char json[640];
+    bool lineAec = lineAecRequest >= 0 ? lineAecRequest != 0 : lineAecEnabled;
+    int len = snprintf(json, sizeof(json), "{\"changed\":%d,\"line_aec\":%d", changed, lineAec ? 1 : 0);
+    for (int i = 0; i < SETTING_FIELD_COUNT && len < (int)sizeof(json); i++) {
+        len += snprintf(json + len, sizeof(json) - len, ",\"%s\":%d",
+                        settingFields[i].name, settingValue(updated, i));
+    }
+    if (len < (int)sizeof(json)) {
+        len += snprintf(json + len, sizeof(json) - len, "}");
+    }
+    
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, json, strlen(json));
+}
+
+// Called from the detection loop for every frame - must stay cheap
+void recordRawFrame(camera_fb_t * fb) {
+    rawFrameBytes = fb->len;
+    if (!rawCapturing) {
+        return;
+    }
+    
+    // Never wait for the HTTP handler - skip this frame instead
+    if (xSemaphoreTake(rawCaptureMutex, 0) != pdTRUE) {
+        rawDropped++;
+        return;
+    }
+    
+    if (rawCapturing && rawQueued < rawWanted) {
+        if (fb->format != PIXFORMAT_GRAYSCALE || fb->len > rawSlotCapacity ||
+            (rawQueued > 0 && ((int)fb->width != rawWidth || (int)fb->height != rawHeight))) {
+            rawWrongFormat = fb->format != PIXFORMAT_GRAYSCALE;
+            rawCapturing = false;   // Mode or frame size changed: end the file here
+        } else if (rawSlots[rawWriteIndex].full) {
+            rawDropped++;           // WiFi behind - the recording gets a gap
+        } else {
+            RawCaptureSlot& slot = rawSlots[rawWriteIndex];
+            memcpy(slot.pixels, fb->buf, fb->len);
+            slot.len = fb->len;
+            slot.timestampUs = (uint32_t)(fb->timestamp.tv_sec * 1000000ULL + fb->timestamp.tv_usec);
+            slot.full = true;
+            if (rawQueued == 0) {
+                rawWidth = fb->width;
+                rawHeight = fb->height;
+            }
+            rawWriteIndex = (rawWriteIndex + 1) % rawSlotCount;
+            rawQueued++;
+        }
+        if (rawQueued >= rawWanted) {
+            rawCapturing = false;
+        }
+    }
+    xSemaphoreGive(rawCaptureMutex);
+    
+    xTaskNotifyGive(rawReaderTask);
+}
+
+// Ring for one recording; only called while rawCapturing is clear
+bool allocRawCapture(size_t size) {
+    int count = psramFound() ? RAW_CAPTURE_SLOTS_PSRAM : RAW_CAPTURE_SLOTS_DRAM;
+    for (int i = 0; i < count; i++) {
+        rawSlots[i].pixels = (uint8_t*)(psramFound() ? ps_malloc(size) : malloc(size));
+        rawSlots[i].full = false;
+        if (!rawSlots[i].pixels) {
+            rawSlotCount = i;
+            return false;
+        }
+    }
+    rawSlotCount = count;
+    rawSlotCapacity = size;
+    return true;
+}
+
+void freeRawCapture() {
+    for (int i = 0; i < rawSlotCount; i++) {
+        free(rawSlots[i].pixels);
+        rawSlots[i].pixels = NULL;
+    }
+    rawSlotCount = 0;
+    rawSlotCapacity = 0;
+}
+
+// /capture-raw?frames=N   - N consecutive grayscale frames (1-300) as an LVRF
+//                           container (see lib/LineVision/src/FrameContainer.h)
+// /capture-raw?format=pgm - one frame as binary PGM
+// Recordings replay on a PC with tools/replay. Frames come from the
+// detection loop through a ring (recordRawFrame); if WiFi falls behind
+// the ring fills and frames are skipped, so use the timestamps for the
+// real spacing.
+static esp_err_t capture_raw_handler(httpd_req_t *req) {
+    char query[64];
+    char param[16];
+    int frames = 1;
+    bool pgm = false;
+    
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "frames", param, sizeof(param)) == ESP_OK) {
+            frames = atoi(param);
+        }
+        if (httpd_query_key_value(query, "format", param, sizeof(param)) == ESP_OK) {
+            pgm = strcmp(param, "pgm") == 0;
+        }
+    }
+    if (frames < 1 || frames > RAW_CAPTURE_MAX_FRAMES) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "frames must be 1-300");
+        return ESP_FAIL;
+    }
+    if (pgm) frames = 1;
+    
+    // One recording at a time; the loop does not touch the ring until rawCapturing is set
+    xSemaphoreTake(rawCaptureMutex, portMAX_DELAY);
+    bool busy = rawSlotCount > 0;
+    size_t frameBytes = rawFrameBytes;
+    if (!busy && (frameBytes == 0 || !allocRawCapture(frameBytes))) {
+        freeRawCapture();
+        xSemaphoreGive(rawCaptureMutex);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
+                            frameBytes == 0 ? "No frame from the camera" : "No memory for the recording");
+        return ESP_FAIL;
+    }
+    if (!busy) {
+        rawWanted = frames;
+        rawQueued = 0;
+        rawWriteIndex = 0;
+        rawDropped = 0;
+        rawWrongFormat = false;
+        rawReaderTask = xTaskGetCurrentTaskHandle();
+        rawCapturing = true;
+    }
+    xSemaphoreGive(rawCaptureMutex);
+    if (busy) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Recording already in progress");
+        return ESP_FAIL;
+    }
+    
+    int sent = 0;
+    int readIndex = 0;
+    esp_err_t res = ESP_OK;
+    while (res == ESP_OK && sent < frames) {
+        // Next slot in order; the loop does not write a full slot
+        xSemaphoreTake(rawCaptureMutex, portMAX_DELAY);
+        bool ready = rawSlots[readIndex].full;
+        bool ended = !rawCapturing && !ready;
+        xSemaphoreGive(rawCaptureMutex);
+        if (ended) break;
+        if (!ready) {
+            if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(RAW_CAPTURE_TIMEOUT_MS)) == 0) break;
+            continue;
+        }
+        
+        RawCaptureSlot& slot = rawSlots[readIndex];
+        if (sent == 0) {
+            httpd_resp_set_type(req, pgm ? "image/x-portable-graymap" : "application/octet-stream");
+            httpd_resp_set_hdr(req, "Content-Disposition",
+                               pgm ? "attachment; filename=frame.pgm" : "attachment; filename=frames.lvr");
+            if (pgm) {
+                char header[32];
+                int len = snprintf(header, sizeof(header), "P5\n%d %d\n255\n", rawWidth, rawHeight);
+                res = httpd_resp_send_chunk(req, header, len);
+            } else {
+                // Frame count 0 - "until EOF": the recording may end early
+                FrameFileHeader fileHeader;
+                fileHeader.version = FRAME_CONTAINER_VERSION;
+                fileHeader.width = rawWidth;
+                fileHeader.height = rawHeight;
+                fileHeader.format = FRAME_CONTAINER_FORMAT_GRAY8;
+                fileHeader.frameCount = 0;
+                uint8_t header[FRAME_CONTAINER_FILE_HEADER];
+                frameEncodeFileHeader(fileHeader, header);
+                res = httpd_resp_send_chunk(req, (const char *)header, sizeof(header));
+            }
+        }
+        if (res == ESP_OK && !pgm) {
+            FrameHeader frameHeader;
+            frameHeader.timestampUs = slot.timestampUs;
+            frameHeader.length = slot.len;
+            uint8_t header[FRAME_CONTAINER_FRAME_HEADER];
+            frameEncodeFrameHeader(frameHeader, header);
+            res = httpd_resp_send_chunk(req, (const char *)header, sizeof(header));
+        }
+        if (res == ESP_OK) {
+            res = httpd_resp_send_chunk(req, (const char *)slot.pixels, slot.len);
+        }
+        
+        xSemaphoreTake(rawCaptureMutex, portMAX_DELAY);
+        slot.full = false;
+        xSemaphoreGive(rawCaptureMutex);
+        readIndex = (readIndex + 1) % rawSlotCount;
+        sent++;
+    }
+    
+    xSemaphoreTake(rawCaptureMutex, portMAX_DELAY);
+    rawCapturing = false;
+    bool wrongFormat = rawWrongFormat;
+    uint32_t dropped = rawDropped;
+    freeRawCapture();
+    xSemaphoreGive(rawCaptureMutex);
+    
+    if (sent > 1 || dropped > 0) {
+        Serial.printf("Raw capture: %d frames sent, %u skipped\n", sent, (unsigned)dropped);
+    }
+    if (res != ESP_OK) return ESP_FAIL;   // Client went away
+    if (sent == 0) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
+                            wrongFormat ? "Camera is not in grayscale mode" : "No frame from the camera");
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
 }
 
 static esp_err_t detect_handler(httpd_req_t *req) {
-    char json[200];
+    const ContrastStats& contrast = lineDetector.getContrast();
+    char json[320];
     snprintf(json, sizeof(json),
-             "{\"detected\":%s,\"position\":%d,\"width\":%d,\"confidence\":%d}",
+             "{\"detected\":%s,\"position\":%d,\"width\":%d,\"confidence\":%d,"
+             "\"heading\":%.3f,\"curvature\":%.2f,"
+             "\"line_level\":%d,\"field_level\":%d,\"separation\":%d,"
+             "\"junction\":\"%s\",\"marker_left\":%s,\"marker_right\":%s}",
              lastResult.lineDetected ? "true" : "false",
              lastResult.linePosition,
              lastResult.lineWidth,
-             lastResult.confidence);
+             lastResult.confidence,
+             lastResult.heading,
+             lastResult.curvature,
+             contrast.linePeak,
+             contrast.fieldPeak,
+             contrast.separation,
+             junctionName(lastScene.junction),
+             lastScene.markerLeft ? "true" : "false",
+             lastScene.markerRight ? "true" : "false");
     
     httpd_resp_set_type(req, "application/json");
     return httpd_resp_send(req, json, strlen(json));
@@ -599,14 +1540,26 @@ void startCameraServer() {
         .user_ctx  = NULL
     };
     
+    httpd_uri_t capture_raw_uri = {
+        .uri       = "/capture-raw",
+        .method    = HTTP_GET,
+        .handler   = capture_raw_handler,
+        .user_ctx  = NULL
+    };
+    
     if (httpd_start(&camera_httpd, &config) == ESP_OK) {
         httpd_register_uri_handler(camera_httpd, &index_uri);
         httpd_register_uri_handler(camera_httpd, &control_uri);
         httpd_register_uri_handler(camera_httpd, &detect_uri);
+        httpd_register_uri_handler(camera_httpd, &capture_raw_uri);
     }
     
+    // Stream sockets stay open after the handler returns; the stream task
+    // writes to them and stream_close_fn releases them
     config.server_port += 1;
     config.ctrl_port += 1;
+    config.max_open_sockets = STREAM_MAX_CLIENTS + 1;
+    config.close_fn = stream_close_fn;
     if (httpd_start(&stream_httpd, &config) == ESP_OK) {
         httpd_register_uri_handler(stream_httpd, &stream_uri);
     }
@@ -16,6 +16,7 @@
 #include "esp_camera.h"
 #include "soc/soc.h"
 #include "soc/rtc_cntl_reg.h"
+#include <LineVision.h>
 
 // Camera pins (AI-Thinker ESP32-CAM)
 #define PWDN_GPIO_NUM     32
@@ -45,13 +46,33 @@
 #define LINE_THRESHOLD    128
 #define MIN_LINE_WIDTH    10
 
+// Camera mounting (see ROBOT_GEOMETRY.md, section 9)
+#define CAMERA_HEIGHT_MM      120.0  // Lens height above the floor
+#define CAMERA_TILT_DEG       35.0   // Downward tilt of the optical axis
+#define CAMERA_HFOV_DEG       60.0   // Horizontal field of view (OV2640 stock lens)
+#define CAMERA_OFFSET_MM      40.0   // Lens position ahead of the wheel axle
+#define WHEEL_BASE_MM         125.0  // Distance between the drive wheels
+
+// Curve fit parameters
+#define FIT_ROW_STEP          3      // Scan every 3rd row for centroids
+#define FIT_INLIER_MM         8.0    // Max distance of a centroid from the curve
+#define SHARP_TURN_CURVATURE  6.0    // 1/m, i.e. radius below ~170 mm
+
 // Curve detection variables
 int lineCenterTop = -1;
 int lineCenterMiddle = -1;
 int lineCenterBottom = -1;
-float curveAngle = 0.0;
+float curveAngle = 0.0;      // Line heading in degrees (+ = turning right)
+float lineCurvature = 0.0;   // Line curvature in 1/m (+ = turning right)
 bool sharpTurnDetected = false;
 
+// Floor projection and robust curve fit
+GroundProjection groundProjection;
+CurveFit curveFit;
+LineCurve lineCurve;
+int projectionWidth = 0;
+int projectionHeight = 0;
+
 // Motor control parameters
 #define BASE_SPEED        150    // Base PWM speed (0-255)
 #define MAX_SPEED         255
@@ -61,6 +82,7 @@ bool sharpTurnDetected = false;
 float Kp = 2.0;   // Proportional gain
 float Ki = 0.0;   // Integral gain (usually 0 for line following)
 float Kd = 1.0;   // Derivative gain
+float Kff = 1.0;  // Curvature feed-forward gain (1.0 = pure geometry)
 
 // PID variables
 float previousError = 0;
@@ -159,11 +181,15 @@ void loop() {
         // PID control with adjusted gains
         float control = calculatePID(error, currentKp, currentKd);
         
+        // Feed-forward: wheel speed difference needed to follow the
+        // fitted curvature, v(1 ± k*B/2) for a differential drive
+        control += Kff * BASE_SPEED * lineCurvature * (WHEEL_BASE_MM / 2.0) / 1000.0;
+        
         // Apply motor control
         setMotorSpeeds(control);
         
-        Serial.printf("Pos: %d%%, Error: %.1f, Angle: %.1f°, Control: %.1f\n", 
-                      mainPosition, error, curveAngle, control);
+        Serial.printf("Pos: %d%%, Error: %.1f, Angle: %.1f°, Curv: %.2f 1/m, Control: %.1f\n", 
+                      mainPosition, error, curveAngle, lineCurvature, control);
     } else {
         // Line lost - enter search mode
         handleLineLost();
@@ -279,85 +305,66 @@ int detectLine(camera_fb_t* fb) {
 }
 
 // Enhanced multi-region line detection for curves and sharp turns
-void detectLineInRegion(camera_fb_t* fb, int startRow, int endRow, int& centerX) {
-    uint8_t* pixels = fb->buf;
-    int width = fb->width;
-    int rowStep = 3;
+// (the region scan lives in LineVision/RegionScan so it can be replayed on a host)
+void detectLineMultiRegion(camera_fb_t* fb) {
+    int height = fb->height;
     
-    int totalDarkStart = 0;
-    int totalDarkEnd = 0;
-    int detectionCount = 0;
+    // Detect line in three regions for curve detection
+    RegionCenters centers;
+    scanThreeRegions(fb->buf, fb->width, height, 3, LINE_THRESHOLD, MIN_LINE_WIDTH, centers);
+    lineCenterTop = centers.top;
+    lineCenterMiddle = centers.middle;
+    lineCenterBottom = centers.bottom;
     
-    for (int row = startRow; row < endRow; row += rowStep) {
-        int darkStart = -1;
-        int darkEnd = -1;
-        bool inDarkLine = false;
-        
-        for (int x = 0; x < width; x++) {
-            int idx = row * width + x;
-            
-            if (!inDarkLine && pixels[idx] < LINE_THRESHOLD) {
-                darkStart = x;
-                inDarkLine = true;
-            } else if (inDarkLine && pixels[idx] >= LINE_THRESHOLD) {
-                darkEnd = x - 1;
-                break;
-            }
-        }
-        
-        if (inDarkLine && darkEnd == -1) {
-            darkEnd = width - 1;
-        }
-        
-        if (darkStart != -1 && darkEnd != -1 && (darkEnd - darkStart) >= MIN_LINE_WIDTH) {
-            totalDarkStart += darkStart;
-            totalDarkEnd += darkEnd;
-            detectionCount++;
-        }
-    }
+    // Fit heading and curvature on the floor plane
+    curveAngle = 0.0;
+    lineCurvature = 0.0;
+    sharpTurnDetected = false;
     
-    if (detectionCount > 0) {
-        int avgDarkStart = totalDarkStart / detectionCount;
-        int avgDarkEnd = totalDarkEnd / detectionCount;
-        centerX = (avgDarkStart + avgDarkEnd) / 2;
-    } else {
-        centerX = -1;
+    if (fitLineCurve(fb)) {
+        curveAngle = lineCurve.headingRad * RAD_TO_DEG;
+        lineCurvature = lineCurve.curvature;
+        sharpTurnDetected = (abs(curveAngle) > 30.0) || (abs(lineCurvature) > SHARP_TURN_CURVATURE);
     }
 }
 
-void detectLineMultiRegion(camera_fb_t* fb) {
-    int height = fb->height;
+// Per-row centroids -> floor coordinates -> robust quadratic fit
+bool fitLineCurve(camera_fb_t* fb) {
     int width = fb->width;
+    int height = fb->height;
     
-    // Detect line in three regions for curve detection
-    int topStart = height / 6;
-    int topEnd = height / 3;
-    detectLineInRegion(fb, topStart, topEnd, lineCenterTop);
-    
-    int middleStart = height / 3;
-    int middleEnd = (2 * height) / 3;
-    detectLineInRegion(fb, middleStart, middleEnd, lineCenterMiddle);
-    
-    int bottomStart = (2 * height) / 3;
-    int bottomEnd = (5 * height) / 6;
-    detectLineInRegion(fb, bottomStart, bottomEnd, lineCenterBottom);
+    // (Re)build the homography when the frame size changes
+    if (width != projectionWidth || height != projectionHeight) {
+        groundProjection.setMounting(width, height, CAMERA_HEIGHT_MM, CAMERA_TILT_DEG,
+                                     CAMERA_HFOV_DEG, CAMERA_OFFSET_MM);
+        curveFit.setInlierTolerance(FIT_INLIER_MM);
+        projectionWidth = width;
+        projectionHeight = height;
+    }
     
-    // Calculate curve angle
-    curveAngle = 0.0;
-    sharpTurnDetected = false;
+    RowCentroid centroids[CURVE_FIT_MAX_POINTS];
+    int count = scanRowCentroids(fb->buf, width, height, height / 6, (5 * height) / 6,
+                                 FIT_ROW_STEP, LINE_THRESHOLD, MIN_LINE_WIDTH,
+                                 centroids, CURVE_FIT_MAX_POINTS);
+    
+    curveFit.reset();
+    float nearestForward = 1e9;
+    for (int i = 0; i < count; i++) {
+        float u = centroids[i].centerQ8 / (float)(1 << ROW_CENTER_SHIFT);
+        float forward, lateral;
+        if (groundProjection.project(u, centroids[i].row, forward, lateral)) {
+            curveFit.addPoint(forward, lateral);
+            if (forward < nearestForward) nearestForward = forward;
+        }
+    }
     
-    // Calculate curve based on position differences
-    if (lineCenterBottom >= 0 && lineCenterTop >= 0) {
-        float displacement = lineCenterBottom - lineCenterTop;
-        float verticalDistance = width * 0.4;
-        curveAngle = atan(displacement / verticalDistance) * 180.0 / 3.14159;
-        sharpTurnDetected = (abs(curveAngle) > 30.0);
-    } else if (lineCenterBottom >= 0 && lineCenterMiddle >= 0) {
-        float displacement = lineCenterBottom - lineCenterMiddle;
-        float verticalDistance = width * 0.3;
-        curveAngle = atan(displacement / verticalDistance) * 180.0 / 3.14159;
-        sharpTurnDetected = (abs(curveAngle) > 30.0);
+    if (curveFit.getPointCount() < 2) {
+        lineCurve.valid = false;
+        return false;
     }
+    
+    // Report the curve at the closest visible point of the line
+    return curveFit.fit(nearestForward, lineCurve);
 }
 
 float calculatePID(float error, float kp = Kp, float kd = Kd) {
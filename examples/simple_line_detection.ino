@@ -14,6 +14,7 @@
 #include "esp_camera.h"
 #include "soc/soc.h"
 #include "soc/rtc_cntl_reg.h"
+#include <LineVision.h>
 
 // Camera pins for AI-Thinker ESP32-CAM
 #define PWDN_GPIO_NUM     32
@@ -211,82 +212,17 @@ int detectLine(camera_fb_t* fb) {
 }
 
 // Enhanced multi-region line detection for curves and sharp turns
-void detectLineInRegion(camera_fb_t* fb, int startRow, int endRow, int& centerX) {
-    uint8_t* pixels = fb->buf;
-    int width = fb->width;
-    int rowStep = 3;
-    
-    int totalDarkStart = 0;
-    int totalDarkEnd = 0;
-    int detectionCount = 0;
-    
-    for (int row = startRow; row < endRow; row += rowStep) {
-        int darkStart = -1;
-        int darkEnd = -1;
-        bool inDarkLine = false;
-        
-        for (int x = 0; x < width; x++) {
-            int idx = row * width + x;
-            
-            if (!inDarkLine && pixels[idx] < LINE_THRESHOLD) {
-                darkStart = x;
-                inDarkLine = true;
-            } else if (inDarkLine && pixels[idx] >= LINE_THRESHOLD) {
-                darkEnd = x - 1;
-                break;
-            }
-        }
-        
-        if (inDarkLine && darkEnd == -1) {
-            darkEnd = width - 1;
-        }
-        
-        if (darkStart != -1 && darkEnd != -1 && (darkEnd - darkStart) >= MIN_LINE_WIDTH) {
-            totalDarkStart += darkStart;
-            totalDarkEnd += darkEnd;
-            detectionCount++;
-        }
-    }
-    
-    if (detectionCount > 0) {
-        int avgDarkStart = totalDarkStart / detectionCount;
-        int avgDarkEnd = totalDarkEnd / detectionCount;
-        centerX = (avgDarkStart + avgDarkEnd) / 2;
-    } else {
-        centerX = -1;
-    }
-}
-
+// (the region scan lives in LineVision/RegionScan so it can be replayed on a host)
 void detectLineMultiRegion(camera_fb_t* fb) {
-    int height = fb->height;
-    int width = fb->width;
-    
-    // Detect line in three regions
-    int topStart = height / 6;
-    int topEnd = height / 3;
-    detectLineInRegion(fb, topStart, topEnd, lineCenterTop);
-    
-    int middleStart = height / 3;
-    int middleEnd = (2 * height) / 3;
-    detectLineInRegion(fb, middleStart, middleEnd, lineCenterMiddle);
-    
-    int bottomStart = (2 * height) / 3;
-    int bottomEnd = (5 * height) / 6;
-    detectLineInRegion(fb, bottomStart, bottomEnd, lineCenterBottom);
+    RegionCenters centers;
+    scanThreeRegions(fb->buf, fb->width, fb->height, 3, LINE_THRESHOLD, MIN_LINE_WIDTH, centers);
+    lineCenterTop = centers.top;
+    lineCenterMiddle = centers.middle;
+    lineCenterBottom = centers.bottom;
     
     // Calculate curve angle
-    curveAngle = 0.0;
     sharpTurnDetected = false;
-    
-    if (lineCenterBottom >= 0 && lineCenterTop >= 0) {
-        float displacement = lineCenterBottom - lineCenterTop;
-        float verticalDistance = width * 0.4;
-        curveAngle = atan(displacement / verticalDistance) * 180.0 / 3.14159;
-        sharpTurnDetected = (abs(curveAngle) > 30.0);
-    } else if (lineCenterBottom >= 0 && lineCenterMiddle >= 0) {
-        float displacement = lineCenterBottom - lineCenterMiddle;
-        float verticalDistance = width * 0.3;
-        curveAngle = atan(displacement / verticalDistance) * 180.0 / 3.14159;
+    if (regionCurveAngle(centers, fb->width, curveAngle)) {
         sharpTurnDetected = (abs(curveAngle) > 30.0);
     }
 }
@@ -0,0 +1,182 @@
+#include "LineLink.h"
+
+// Nibble table for CRC-16/CCITT-FALSE: small enough for DRAM, 2 lookups per byte
+static const uint16_t CRC_NIBBLE[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t lineLinkCrc16(const uint8_t* data, size_t len, uint16_t crc) {
+    for (size_t i = 0; i < len; i++) {
+        crc = (uint16_t)((crc << 4) ^ CRC_NIBBLE[((crc >> 12) ^ (data[i] >> 4)) & 0x0F]);
+        crc = (uint16_t)((crc << 4) ^ CRC_NIBBLE[((crc >> 12) ^ (data[i] & 0x0F)) & 0x0F]);
+    }
+    return crc;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// Little-endian helpers
+// ═══════════════════════════════════════════════════════════════════════════
+
+static void put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Round and saturate a scaled value to int16
+static int16_t toQ(float value, float scale) {
+    float v = value * scale;
+    if (v > 32767.0f) return 32767;
+    if (v < -32768.0f) return -32768;
+    return (int16_t)(v >= 0 ? v + 0.5f : v - 0.5f);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// Encoder
+// ═══════════════════════════════════════════════════════════════════════════
+
+size_t lineLinkEncodeState(const LineLinkState& state, uint8_t* out) {
+    out[0] = LINE_LINK_SYNC0;
+    out[1] = LINE_LINK_SYNC1;
+    out[2] = LINE_LINK_MSG_LINE_STATE;
+    out[3] = LINE_LINK_LINE_STATE_SIZE;
+    put16(out + 4, state.seq);
+
+    // Payload: fixed-point fields
+    uint8_t* p = out + LINE_LINK_HEADER_SIZE;
+    put32(p + 0, state.captureUs);
+    put32(p + 4, state.latencyUs);
+    put16(p + 8, (uint16_t)toQ(state.positionMm, 10.0f));     // 0.1 mm
+    put16(p + 10, (uint16_t)toQ(state.headingRad, 1000.0f));  // mrad
+    put16(p + 12, (uint16_t)toQ(state.curvature, 100.0f));    // 0.01 1/m
+    put16(p + 14, (uint16_t)state.refForwardMm);
+    p[16] = state.confidence;
+    p[17] = state.flags;
+
+    size_t body = 2 + 2 + LINE_LINK_LINE_STATE_SIZE;  // type, len, seq, payload
+    uint16_t crc = lineLinkCrc16(out + 2, body);
+    put16(out + 2 + body, crc);
+
+    return LINE_LINK_HEADER_SIZE + LINE_LINK_LINE_STATE_SIZE + LINE_LINK_CRC_SIZE;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// Parser
+// ═══════════════════════════════════════════════════════════════════════════
+
+LineLinkParser::LineLinkParser()
+    : length(0), expected(0), haveSeq(false), lastSeq(0), lastCaptureUs(0),
+      framesOk(0), crcErrors(0), framesLost(0), resyncs(0) {
+    state.seq = 0;
+    state.captureUs = 0;
+    state.latencyUs = 0;
+    state.positionMm = 0.0f;
+    state.headingRad = 0.0f;
+    state.curvature = 0.0f;
+    state.refForwardMm = 0;
+    state.confidence = 0;
+    state.flags = 0;
+}
+
+bool LineLinkParser::feed(uint8_t byte) {
+    // Hunt for the sync pattern
+    if (length == 0) {
+        if (byte == LINE_LINK_SYNC0) buffer[length++] = byte;
+        return false;
+    }
+    if (length == 1) {
+        if (byte == LINE_LINK_SYNC1) {
+            buffer[length++] = byte;
+        } else if (byte != LINE_LINK_SYNC0) {
+            length = 0;
+        }
+        return false;
+    }
+
+    buffer[length++] = byte;
+
+    // Header complete: validate the payload length
+    if (length == LINE_LINK_HEADER_SIZE) {
+        uint8_t payloadLen = buffer[3];
+        if (payloadLen > LINE_LINK_MAX_PAYLOAD) {
+            length = 0;
+            return false;
+        }
+        expected = LINE_LINK_HEADER_SIZE + payloadLen + LINE_LINK_CRC_SIZE;
+        return false;
+    }
+
+    if (length < LINE_LINK_HEADER_SIZE || length < expected) {
+        return false;
+    }
+
+    bool ok = finishFrame();
+    length = 0;
+    return ok;
+}
+
+bool LineLinkParser::finishFrame() {
+    size_t body = expected - 2 - LINE_LINK_CRC_SIZE;
+    uint16_t crc = lineLinkCrc16(buffer + 2, body);
+    if (crc != get16(buffer + 2 + body)) {
+        crcErrors++;
+        return false;
+    }
+
+    uint8_t type = buffer[2];
+    uint8_t payloadLen = buffer[3];
+    if (type != LINE_LINK_MSG_LINE_STATE || payloadLen < LINE_LINK_LINE_STATE_SIZE) {
+        return false;  // Unknown message - ignore
+    }
+
+    const uint8_t* p = buffer + LINE_LINK_HEADER_SIZE;
+    uint16_t seq = get16(buffer + 4);
+    uint32_t captureUs = get32(p + 0);
+    if (haveSeq) {
+        /*
+         * Forward gap - frames lost. A repeated number or a jump back is a
+         * resync, not a loss. A camera restart numbers from zero again, which
+         * after more than 0x8000 frames looks like a forward step, so it is
+         * told by the camera clock starting over instead
+         */
+        uint16_t step = (uint16_t)(seq - lastSeq);
+        bool restarted = captureUs < lastCaptureUs &&
+                         (uint32_t)(captureUs - lastCaptureUs) > LINE_LINK_MAX_GAP_US;
+        if (step == 0 || step > 0x8000 || restarted) {
+            resyncs++;
+        } else {
+            framesLost += step - 1;
+        }
+    }
+    haveSeq = true;
+    lastSeq = seq;
+    lastCaptureUs = captureUs;
+
+    state.seq = seq;
+    state.captureUs = captureUs;
+    state.latencyUs = get32(p + 4);
+    state.positionMm = (int16_t)get16(p + 8) / 10.0f;
+    state.headingRad = (int16_t)get16(p + 10) / 1000.0f;
+    state.curvature = (int16_t)get16(p + 12) / 100.0f;
+    state.refForwardMm = (int16_t)get16(p + 14);
+    state.confidence = p[16];
+    state.flags = p[17];
+
+    framesOk++;
+    return true;
+}
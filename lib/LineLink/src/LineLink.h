@@ -0,0 +1,102 @@
+#ifndef LINE_LINK_H
+#define LINE_LINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * LineLink - compact binary protocol from the ESP32-CAM to the robot
+ * controller over UART.
+ *
+ * Frame layout (multi-byte fields little-endian):
+ *
+ *   0xA5 0x5A | type | len | seq (2) | payload (len) | crc16 (2)
+ *
+ * The CRC is CRC-16/CCITT-FALSE over type..payload. A line state frame is
+ * 26 bytes, about 280 us on the wire at 921600 baud.
+ */
+
+#define LINE_LINK_SYNC0          0xA5
+#define LINE_LINK_SYNC1          0x5A
+#define LINE_LINK_HEADER_SIZE    6
+#define LINE_LINK_CRC_SIZE       2
+#define LINE_LINK_MAX_PAYLOAD    32
+#define LINE_LINK_MAX_FRAME      (LINE_LINK_HEADER_SIZE + LINE_LINK_MAX_PAYLOAD + LINE_LINK_CRC_SIZE)
+
+#define LINE_LINK_DEFAULT_BAUD   921600
+
+// Camera clock going back by more than this is a camera restart, not the
+// micros() wrap-around (every ~71.6 min)
+#define LINE_LINK_MAX_GAP_US     10000000UL
+
+// Message types
+#define LINE_LINK_MSG_LINE_STATE 0x01
+
+// LineLinkState::flags
+#define LINE_LINK_FLAG_DETECTED   0x01  // Line visible in this frame
+#define LINE_LINK_FLAG_SHARP_TURN 0x02  // Curvature or heading beyond the sharp turn limit
+#define LINE_LINK_FLAG_JUNCTION   0x04  // Crossing, T, branch, corner or fork ahead
+#define LINE_LINK_FLAG_MARKER_L   0x08  // Side marker left of the line
+#define LINE_LINK_FLAG_MARKER_R   0x10  // Side marker right of the line
+#define LINE_LINK_FLAG_EXIT_LEFT  0x20  // Junction exits (valid with FLAG_JUNCTION)
+#define LINE_LINK_FLAG_EXIT_RIGHT 0x40
+#define LINE_LINK_FLAG_EXIT_AHEAD 0x80
+
+#define LINE_LINK_LINE_STATE_SIZE 18
+
+// Line estimate as seen by the camera, in robot units
+typedef struct {
+    uint16_t seq;            // Frame sequence number (wraps)
+    uint32_t captureUs;      // Camera clock at frame capture (micros)
+    uint32_t latencyUs;      // Capture -> transmit delay on the camera
+    float positionMm;        // Lateral offset at refForwardMm (+ = right)
+    float headingRad;        // Line direction vs. robot forward (+ = right)
+    float curvature;         // 1/m (+ = turning right)
+    int16_t refForwardMm;    // Distance ahead of the wheel axle the values refer to
+    uint8_t confidence;      // 0-100
+    uint8_t flags;           // LINE_LINK_FLAG_*
+} LineLinkState;
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+uint16_t lineLinkCrc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF);
+
+// Encode a line state frame into out (at least LINE_LINK_MAX_FRAME bytes).
+// Returns the frame length.
+size_t lineLinkEncodeState(const LineLinkState& state, uint8_t* out);
+
+// Byte-wise frame parser for the receiving side
+class LineLinkParser {
+private:
+    uint8_t buffer[LINE_LINK_MAX_FRAME];
+    size_t length;
+    size_t expected;
+
+    LineLinkState state;
+    bool haveSeq;
+    uint16_t lastSeq;
+    uint32_t lastCaptureUs;
+
+    uint32_t framesOk;
+    uint32_t crcErrors;
+    uint32_t framesLost;
+    uint32_t resyncs;
+
+    bool finishFrame();
+
+public:
+    LineLinkParser();
+
+    // Feed one byte. Returns true when a valid line state frame completed.
+    bool feed(uint8_t byte);
+
+    // Last decoded line state
+    const LineLinkState& getState() const { return state; }
+
+    // Link statistics
+    uint32_t getFramesOk() const { return framesOk; }
+    uint32_t getCrcErrors() const { return crcErrors; }
+    uint32_t getFramesLost() const { return framesLost; }  // Sequence gaps
+    uint32_t getResyncs() const { return resyncs; }        // Repeats and restarts
+};
+
+#endif // LINE_LINK_H
@@ -0,0 +1,190 @@
+#include "BlobLabeler.h"
+#include <math.h>
+
+BlobLabeler::BlobLabeler()
+    : runCount(0), rows(0), width(0), truncated(false),
+      blobCount(0), minArea(4) {
+    rowFirstRun[0] = 0;
+}
+
+int BlobLabeler::find(int run) {
+    // Path halving
+    while (parent[run] != run) {
+        parent[run] = parent[parent[run]];
+        run = parent[run];
+    }
+    return run;
+}
+
+void BlobLabeler::unite(int a, int b) {
+    int ra = find(a);
+    int rb = find(b);
+    if (ra == rb) return;
+    // Lower index becomes the root, so roots come before their members
+    if (ra < rb) parent[rb] = ra;
+    else parent[ra] = rb;
+}
+
+int BlobLabeler::label(const uint8_t* pixels, int w, int h, uint8_t threshold) {
+    runCount = 0;
+    blobCount = 0;
+    truncated = false;
+    width = w;
+    rows = 0;
+    rowFirstRun[0] = 0;
+
+    if (!pixels || w <= 0 || h <= 0) return 0;
+    if (h > BLOB_MAX_ROWS) h = BLOB_MAX_ROWS;
+
+    int prevStart = 0;
+    int prevEnd = 0;
+
+    for (int row = 0; row < h; row++) {
+        rowFirstRun[row] = (int16_t)runCount;
+        const uint8_t* line = pixels + row * w;
+        int prev = prevStart;
+        int x = 0;
+
+        while (x < w) {
+            while (x < w && line[x] >= threshold) x++;
+            if (x >= w) break;
+
+            int x0 = x;
+            while (x < w && line[x] < threshold) x++;
+            int x1 = x - 1;
+
+            if (runCount >= BLOB_MAX_RUNS) {
+                truncated = true;
+                break;
+            }
+
+            int index = runCount++;
+            runs[index].x0 = (int16_t)x0;
+            runs[index].x1 = (int16_t)x1;
+            runs[index].row = (int16_t)row;
+            runs[index].blob = -1;
+            parent[index] = (int16_t)index;
+
+            // Previous-row runs are sorted by x: skip the ones ending left of
+            // this run (they cannot touch later runs either), merge overlaps
+            while (prev < prevEnd && runs[prev].x1 + 1 < x0) prev++;
+            for (int p = prev; p < prevEnd && runs[p].x0 <= x1 + 1; p++) {
+                unite(p, index);
+            }
+        }
+
+        rows = row + 1;
+        if (truncated) break;
+        prevStart = rowFirstRun[row];
+        prevEnd = runCount;
+    }
+    rowFirstRun[rows] = (int16_t)runCount;
+
+    collectBlobs();
+    return blobCount;
+}
+
+void BlobLabeler::collectBlobs() {
+    // Areas per root
+    for (int i = 0; i < runCount; i++) rootArea[i] = 0;
+    for (int i = 0; i < runCount; i++) {
+        int root = find(i);
+        parent[i] = (int16_t)root;
+        rootArea[root] += runs[i].x1 - runs[i].x0 + 1;
+    }
+
+    // Keep the largest roots, sorted by area (insertion into a short list)
+    int16_t order[BLOB_MAX_COUNT];
+    int kept = 0;
+    for (int i = 0; i < runCount; i++) {
+        rootSlot[i] = -1;
+        if (parent[i] != i || rootArea[i] < minArea) continue;
+
+        int pos = kept < BLOB_MAX_COUNT ? kept : BLOB_MAX_COUNT;
+        while (pos > 0 && rootArea[order[pos - 1]] < rootArea[i]) pos--;
+        if (pos >= BLOB_MAX_COUNT) continue;
+
+        int last = kept < BLOB_MAX_COUNT ? kept : BLOB_MAX_COUNT - 1;
+        for (int j = last; j > pos; j--) order[j] = order[j - 1];
+        order[pos] = (int16_t)i;
+        if (kept < BLOB_MAX_COUNT) kept++;
+    }
+    for (int s = 0; s < kept; s++) rootSlot[order[s]] = (int16_t)s;
+    blobCount = kept;
+
+    // Raw moments per kept blob
+    int64_t sumX[BLOB_MAX_COUNT] = {0};
+    int64_t sumY[BLOB_MAX_COUNT] = {0};
+    int64_t sumXX[BLOB_MAX_COUNT] = {0};
+    int64_t sumYY[BLOB_MAX_COUNT] = {0};
+    int64_t sumXY[BLOB_MAX_COUNT] = {0};
+
+    for (int s = 0; s < kept; s++) {
+        blobs[s].area = rootArea[order[s]];
+        blobs[s].minX = INT16_MAX;
+        blobs[s].minY = INT16_MAX;
+        blobs[s].maxX = -1;
+        blobs[s].maxY = -1;
+    }
+
+    for (int i = 0; i < runCount; i++) {
+        int s = rootSlot[parent[i]];
+        runs[i].blob = (int16_t)s;
+        if (s < 0) continue;
+
+        const BlobRun& run = runs[i];
+        int64_t a = run.x0;
+        int64_t b = run.x1;
+        int64_t y = run.row;
+        int64_t n = b - a + 1;
+        // Closed forms of sum(x) and sum(x^2) over [a, b]
+        int64_t sx = n * (a + b) / 2;
+        int64_t sxx = (b * (b + 1) * (2 * b + 1) - (a - 1) * a * (2 * a - 1)) / 6;
+
+        sumX[s] += sx;
+        sumY[s] += n * y;
+        sumXX[s] += sxx;
+        sumYY[s] += n * y * y;
+        sumXY[s] += sx * y;
+
+        Blob& blob = blobs[s];
+        if (run.x0 < blob.minX) blob.minX = run.x0;
+        if (run.x1 > blob.maxX) blob.maxX = run.x1;
+        if (run.row < blob.minY) blob.minY = run.row;
+        if (run.row > blob.maxY) blob.maxY = run.row;
+    }
+
+    for (int s = 0; s < kept; s++) {
+        Blob& blob = blobs[s];
+        float area = (float)blob.area;
+        blob.cx = sumX[s] / area;
+        blob.cy = sumY[s] / area;
+
+        // Central second moments (pixel variance)
+        float mu20 = sumXX[s] / area - blob.cx * blob.cx + 1.0f / 12.0f;
+        float mu02 = sumYY[s] / area - blob.cy * blob.cy + 1.0f / 12.0f;
+        float mu11 = sumXY[s] / area - blob.cx * blob.cy;
+
+        blob.orientationRad = 0.5f * atan2f(2.0f * mu11, mu20 - mu02);
+
+        float common = sqrtf((mu20 - mu02) * (mu20 - mu02) + 4.0f * mu11 * mu11);
+        float major = 0.5f * (mu20 + mu02 + common);
+        float minor = 0.5f * (mu20 + mu02 - common);
+        blob.elongation = minor > 1e-6f ? sqrtf(major / minor) : 1000.0f;
+
+        blob.edges = 0;
+        if (blob.minX == 0) blob.edges |= BLOB_EDGE_LEFT;
+        if (blob.maxX == width - 1) blob.edges |= BLOB_EDGE_RIGHT;
+        if (blob.minY == 0) blob.edges |= BLOB_EDGE_TOP;
+        if (blob.maxY == rows - 1) blob.edges |= BLOB_EDGE_BOTTOM;
+    }
+}
+
+const BlobRun* BlobLabeler::getRowRuns(int row, int& count) const {
+    if (row < 0 || row >= rows) {
+        count = 0;
+        return runs;
+    }
+    count = rowFirstRun[row + 1] - rowFirstRun[row];
+    return runs + rowFirstRun[row];
+}
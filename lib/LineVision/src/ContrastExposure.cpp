@@ -0,0 +1,149 @@
+#include "ContrastExposure.h"
+
+// Relative step limits (fraction of the current light level per step)
+#define EXPOSURE_MIN_STEP   0.04f
+#define EXPOSURE_MAX_STEP   0.25f
+#define EXPOSURE_START_STEP 0.15f
+
+// Separation change (gray levels) treated as noise
+#define SEPARATION_HYSTERESIS 4
+
+// Hard limits before extremum seeking takes over
+#define FIELD_CLIP_LIMIT 30      // permille of saturated pixels
+#define FIELD_MIN_LEVEL  120     // field peak below this is underexposed
+
+// Converged: frames to hold before probing again
+#define EXPOSURE_HOLD_FRAMES 60
+
+/*
+ * agc_gain is an index, not a multiplier: esp32-camera writes
+ * agc_gain_tbl[index] to the OV2640 GAIN register, whose gain is
+ * (bit7+1)(bit6+1)(bit5+1)(bit4+1)(1 + bits[3:0]/16).
+ */
+static const uint8_t OV2640_GAIN_REGISTER[] = {
+    0x00, 0x10, 0x18, 0x30, 0x34, 0x38, 0x3C, 0x70, 0x72, 0x74, 0x76,
+    0x78, 0x7A, 0x7C, 0x7E, 0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6,
+    0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF
+};
+#define OV2640_GAIN_STEPS (int)(sizeof(OV2640_GAIN_REGISTER) / sizeof(OV2640_GAIN_REGISTER[0]))
+
+float ContrastExposure::gainMultiplier(int gain) {
+    if (gain < 0) gain = 0;
+    if (gain >= OV2640_GAIN_STEPS) gain = OV2640_GAIN_STEPS - 1;
+    uint8_t reg = OV2640_GAIN_REGISTER[gain];
+    float multiplier = 1.0f + (reg & 0x0F) / 16.0f;
+    for (int bit = 4; bit < 8; bit++) {
+        if (reg & (1 << bit)) multiplier *= 2.0f;
+    }
+    return multiplier;
+}
+
+ContrastExposure::ContrastExposure()
+    : level(300.0f), minExposure(8), maxExposure(600), maxGain(12),
+      step(EXPOSURE_START_STEP), direction(1), lastSeparation(0), haveLast(false),
+      settleFrames(3), framesToWait(0), holdFrames(0) {
+}
+
+void ContrastExposure::setLimits(int minExp, int maxExp, int gainLimit) {
+    minExposure = minExp < 1 ? 1 : minExp;
+    maxExposure = maxExp < minExposure ? minExposure : maxExp;
+    maxGain = gainLimit < 0 ? 0 : gainLimit;
+    if (maxGain > OV2640_GAIN_STEPS - 1) maxGain = OV2640_GAIN_STEPS - 1;
+}
+
+void ContrastExposure::reset(int exposure, int gain) {
+    if (exposure < minExposure) exposure = minExposure;
+    if (exposure > maxExposure) exposure = maxExposure;
+    if (gain < 0) gain = 0;
+    if (gain > maxGain) gain = maxGain;
+
+    level = (float)exposure * gainMultiplier(gain);
+    step = EXPOSURE_START_STEP;
+    direction = 1;
+    haveLast = false;
+    framesToWait = settleFrames;
+    holdFrames = 0;
+}
+
+void ContrastExposure::split(int& exposure, int& gain) const {
+    // Lowest gain that reaches the level within maxExposure, exposure makes
+    // up the rest: the level stays continuous across gain steps
+    gain = 0;
+    while (gain < maxGain && level > maxExposure * gainMultiplier(gain)) {
+        gain++;
+    }
+    exposure = (int)(level / gainMultiplier(gain) + 0.5f);
+    if (exposure < minExposure) exposure = minExposure;
+    if (exposure > maxExposure) exposure = maxExposure;
+}
+
+bool ContrastExposure::update(const ContrastStats& stats, int& exposure, int& gain) {
+    if (framesToWait > 0) {
+        framesToWait--;
+        return false;
+    }
+
+    // Line out of view: nothing to optimize, keep the current exposure
+    if (!stats.valid) return false;
+
+    // Hard limits override the hold
+    if (stats.clippedPermille > FIELD_CLIP_LIMIT) {
+        direction = -1;
+        haveLast = false;
+        holdFrames = 0;
+    } else if (stats.fieldPeak < FIELD_MIN_LEVEL) {
+        direction = 1;
+        haveLast = false;
+        holdFrames = 0;
+    } else if (holdFrames > 0) {
+        holdFrames--;
+        if (holdFrames == 0) haveLast = false;  // Re-measure before probing
+        return false;
+    } else if (haveLast) {
+        int change = stats.separation - lastSeparation;
+        if (change < -SEPARATION_HYSTERESIS) {
+            // Went past the optimum: turn back with a smaller step
+            direction = -direction;
+            step *= 0.5f;
+            if (step < EXPOSURE_MIN_STEP) {
+                step = EXPOSURE_MIN_STEP;
+                holdFrames = EXPOSURE_HOLD_FRAMES;
+            }
+        } else if (change > SEPARATION_HYSTERESIS) {
+            step *= 1.25f;
+            if (step > EXPOSURE_MAX_STEP) step = EXPOSURE_MAX_STEP;
+        } else if (step <= EXPOSURE_MIN_STEP) {
+            // Flat at the smallest step: converged, stop flickering
+            lastSeparation = stats.separation;
+            holdFrames = EXPOSURE_HOLD_FRAMES;
+            return false;
+        }
+    }
+
+    lastSeparation = stats.separation;
+    haveLast = true;
+
+    int oldExposure, oldGain;
+    split(oldExposure, oldGain);
+
+    // Step until the registers change: a step smaller than one exposure
+    // count is not a limit, only a limit turns the search around
+    float maxLevel = (float)maxExposure * gainMultiplier(maxGain);
+    while (true) {
+        level *= 1.0f + direction * step;
+        if (level < minExposure) level = minExposure;
+        if (level > maxLevel) level = maxLevel;
+
+        split(exposure, gain);
+        if (exposure != oldExposure || gain != oldGain) break;
+
+        if (level <= minExposure || level >= maxLevel) {
+            // Pinned at a limit: try the other way next time
+            direction = -direction;
+            return false;
+        }
+    }
+
+    framesToWait = settleFrames;
+    return true;
+}
@@ -0,0 +1,55 @@
+#ifndef CONTRAST_EXPOSURE_H
+#define CONTRAST_EXPOSURE_H
+
+#include "ContrastStats.h"
+
+/*
+ * Closed-loop exposure / gain controller that maximizes the separation
+ * between the line and field histogram peaks instead of the average
+ * brightness the OV2640 AEC targets.
+ *
+ * Exposure and gain are driven as one "light level" (exposure times the
+ * gain multiplier), exposure first up to maxExposure (longer exposures blur
+ * the line at speed), gain above that. Gain is the esp32-camera agc_gain
+ * index (0-30), mapped to the OV2640 multiplier through the driver's
+ * register table. The level is moved by extremum seeking: keep
+ * stepping while separation improves, reverse and halve the step when it
+ * gets worse. Changes are rate limited: one step per settleFrames frames
+ * and at most maxStep relative change per step.
+ */
+class ContrastExposure {
+private:
+    float level;            // exposure * gainMultiplier(gain)
+    int minExposure;
+    int maxExposure;
+    int maxGain;
+
+    float step;             // Relative step size
+    int direction;          // +1 brighter, -1 darker
+    int lastSeparation;
+    bool haveLast;
+
+    int settleFrames;       // Frames for a new exposure to show up
+    int framesToWait;
+    int holdFrames;         // Converged: frames until the next probe
+
+    void split(int& exposure, int& gain) const;
+
+public:
+    // Sensor gain for an agc_gain index (1x at 0)
+    static float gainMultiplier(int gain);
+
+    ContrastExposure();
+
+    // exposure: aec_value range, gain: agc_gain range
+    void setLimits(int minExposure, int maxExposure, int maxGain);
+    void setSettleFrames(int frames) { settleFrames = frames; }
+
+    // Start from the current sensor values
+    void reset(int exposure, int gain);
+
+    // Feed one frame. Returns true when new exposure/gain should be applied.
+    bool update(const ContrastStats& stats, int& exposure, int& gain);
+};
+
+#endif // CONTRAST_EXPOSURE_H
@@ -0,0 +1,83 @@
+#include "ContrastStats.h"
+
+// Minimum share of samples in each class for a bimodal histogram (permille)
+#define CONTRAST_MIN_CLASS 20
+
+void measureContrast(const uint8_t* pixels, int width, int height,
+                     int startRow, int endRow, int rowStep,
+                     ContrastStats& out) {
+    out.valid = false;
+    out.linePeak = 0;
+    out.fieldPeak = 0;
+    out.threshold = 128;
+    out.separation = 0;
+    out.clippedPermille = 0;
+    out.linePermille = 0;
+
+    if (!pixels || width <= 0 || rowStep <= 0) return;
+    if (startRow < 0) startRow = 0;
+    if (endRow > height) endRow = height;
+
+    uint32_t histogram[CONTRAST_BINS] = {0};
+    uint32_t total = 0;
+    uint32_t clipped = 0;
+
+    for (int row = startRow; row < endRow; row += rowStep) {
+        const uint8_t* line = pixels + row * width;
+        for (int x = 0; x < width; x += 2) {
+            uint8_t p = line[x];
+            histogram[p >> 2]++;
+            if (p >= 248) clipped++;
+            total++;
+        }
+    }
+    if (total == 0) return;
+
+    out.clippedPermille = (uint16_t)((clipped * 1000) / total);
+
+    // Otsu: maximize between-class variance over the 64 bins
+    uint32_t sumAll = 0;
+    for (int i = 0; i < CONTRAST_BINS; i++) sumAll += i * histogram[i];
+
+    uint32_t weightLow = 0;
+    uint32_t sumLow = 0;
+    float bestVariance = -1.0f;
+    int split = CONTRAST_BINS / 2;
+
+    for (int t = 0; t < CONTRAST_BINS - 1; t++) {
+        weightLow += histogram[t];
+        sumLow += t * histogram[t];
+        uint32_t weightHigh = total - weightLow;
+        if (weightLow == 0 || weightHigh == 0) continue;
+
+        float meanLow = (float)sumLow / weightLow;
+        float meanHigh = (float)(sumAll - sumLow) / weightHigh;
+        float diff = meanHigh - meanLow;
+        float variance = (float)weightLow * (float)weightHigh * diff * diff;
+        if (variance > bestVariance) {
+            bestVariance = variance;
+            split = t + 1;
+        }
+    }
+
+    // Peaks on each side of the split
+    int lowPeak = 0;
+    int highPeak = split;
+    uint32_t lowCount = 0;
+    for (int i = 0; i < split; i++) {
+        lowCount += histogram[i];
+        if (histogram[i] > histogram[lowPeak]) lowPeak = i;
+    }
+    for (int i = split; i < CONTRAST_BINS; i++) {
+        if (histogram[i] > histogram[highPeak]) highPeak = i;
+    }
+
+    out.threshold = (uint8_t)(split << 2);
+    out.linePeak = (uint8_t)((lowPeak << 2) + 2);
+    out.fieldPeak = (uint8_t)((highPeak << 2) + 2);
+    out.separation = out.fieldPeak - out.linePeak;
+    out.linePermille = (uint16_t)((lowCount * 1000) / total);
+
+    out.valid = out.linePermille >= CONTRAST_MIN_CLASS &&
+                out.linePermille <= 1000 - CONTRAST_MIN_CLASS;
+}
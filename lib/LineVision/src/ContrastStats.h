@@ -0,0 +1,32 @@
+#ifndef CONTRAST_STATS_H
+#define CONTRAST_STATS_H
+
+#include <stdint.h>
+
+/*
+ * Line / field separation of a grayscale frame.
+ *
+ * A 64-bin histogram of the scan band is split with Otsu's method; the
+ * most common level on each side is taken as the line and field peak.
+ * Exposure is good for detection when the peaks are far apart and the
+ * field is not clipped.
+ */
+
+#define CONTRAST_BINS 64
+
+typedef struct {
+    bool valid;              // Both line and field are present in the band
+    uint8_t linePeak;        // Most common dark level
+    uint8_t fieldPeak;       // Most common bright level
+    uint8_t threshold;       // Otsu split between the two classes
+    int separation;          // fieldPeak - linePeak
+    uint16_t clippedPermille; // Share of saturated pixels (>= 248), 0-1000
+    uint16_t linePermille;   // Share of pixels below the threshold, 0-1000
+} ContrastStats;
+
+// Sample rows [startRow, endRow) every rowStep rows and every 2nd column
+void measureContrast(const uint8_t* pixels, int width, int height,
+                     int startRow, int endRow, int rowStep,
+                     ContrastStats& out);
+
+#endif // CONTRAST_STATS_H
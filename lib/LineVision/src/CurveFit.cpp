@@ -0,0 +1,202 @@
+#include "CurveFit.h"
+#include <math.h>
+
+// ═══════════════════════════════════════════════════════════════════════════
+// QuadraticFit
+// ═══════════════════════════════════════════════════════════════════════════
+
+QuadraticFit::QuadraticFit() {
+    reset();
+}
+
+void QuadraticFit::reset() {
+    n = 0;
+    for (int i = 0; i < 5; i++) st[i] = 0;
+    for (int i = 0; i < 3; i++) sx[i] = 0;
+}
+
+void QuadraticFit::add(int32_t tQ, int32_t xQ) {
+    int64_t t = tQ;
+    int64_t t2 = t * t;
+
+    n++;
+    st[0] += 1;
+    st[1] += t;
+    st[2] += t2;
+    st[3] += t2 * t;
+    st[4] += t2 * t2;
+    sx[0] += xQ;
+    sx[1] += (int64_t)xQ * t;
+    sx[2] += (int64_t)xQ * t2;
+}
+
+bool QuadraticFit::solve(float& a, float& b, float& c) const {
+    if (n == 0) return false;
+
+    const double scale = (double)(1 << CURVE_FIT_SHIFT);
+    double s0 = (double)st[0], s1 = (double)st[1], s2 = (double)st[2];
+    double s3 = (double)st[3], s4 = (double)st[4];
+    double x0 = (double)sx[0], x1 = (double)sx[1], x2 = (double)sx[2];
+
+    // Full quadratic (Cramer's rule on the normal equations)
+    if (n >= 3) {
+        double det = s0 * (s2 * s4 - s3 * s3) - s1 * (s1 * s4 - s3 * s2) + s2 * (s1 * s3 - s2 * s2);
+        double norm = s0 * s2 * s4;
+        if (norm > 0 && fabs(det) > norm * 1e-9) {
+            double da = x0 * (s2 * s4 - s3 * s3) - s1 * (x1 * s4 - s3 * x2) + s2 * (x1 * s3 - s2 * x2);
+            double db = s0 * (x1 * s4 - x2 * s3) - x0 * (s1 * s4 - s3 * s2) + s2 * (s1 * x2 - x1 * s2);
+            double dc = s0 * (s2 * x2 - s3 * x1) - s1 * (s1 * x2 - s2 * x1) + x0 * (s1 * s3 - s2 * s2);
+            a = (float)(da / det / scale);
+            b = (float)(db / det);
+            c = (float)(dc / det * scale);
+            return true;
+        }
+    }
+
+    // Straight line
+    if (n >= 2) {
+        double det = s0 * s2 - s1 * s1;
+        if (s0 * s2 > 0 && fabs(det) > s0 * s2 * 1e-9) {
+            a = (float)((x0 * s2 - s1 * x1) / det / scale);
+            b = (float)((s0 * x1 - s1 * x0) / det);
+            c = 0.0f;
+            return true;
+        }
+    }
+
+    // All points at the same distance: position only
+    a = (float)(x0 / s0 / scale);
+    b = 0.0f;
+    c = 0.0f;
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// CurveFit
+// ═══════════════════════════════════════════════════════════════════════════
+
+CurveFit::CurveFit()
+    : count(0), inlierToleranceMm(8.0f), iterations(24), rngState(CURVE_FIT_SEED) {
+}
+
+void CurveFit::reset() {
+    count = 0;
+}
+
+bool CurveFit::addPoint(float forwardMm, float lateralMm) {
+    if (count >= CURVE_FIT_MAX_POINTS) return false;
+    forward[count] = forwardMm;
+    lateral[count] = lateralMm;
+    count++;
+    return true;
+}
+
+uint32_t CurveFit::nextRandom() {
+    // xorshift32, reseeded by every fit()
+    uint32_t x = rngState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rngState = x;
+    return x;
+}
+
+bool CurveFit::fit(float refForwardMm, LineCurve& out) {
+    out.valid = false;
+    out.positionMm = 0.0f;
+    out.headingRad = 0.0f;
+    out.curvature = 0.0f;
+    out.refForwardMm = refForwardMm;
+    out.rmsMm = 0.0f;
+    out.inliers = 0;
+    out.points = count;
+
+    if (count == 0) return false;
+
+    // Same seed every frame: the result depends only on this frame's
+    // points, so replays can be compared frame by frame
+    rngState = CURVE_FIT_SEED;
+
+    bool inlier[CURVE_FIT_MAX_POINTS];
+    for (int i = 0; i < count; i++) inlier[i] = true;
+
+    // RANSAC: keep the 3-point model with the most support
+    if (count > 3) {
+        int bestSupport = 0;
+        float bestError = 0.0f;
+        bool bestMask[CURVE_FIT_MAX_POINTS];
+
+        for (int iter = 0; iter < iterations; iter++) {
+            int i = nextRandom() % count;
+            int j = nextRandom() % count;
+            int k = nextRandom() % count;
+            if (i == j || j == k || i == k) continue;
+
+            float t1 = forward[i] - refForwardMm, x1 = lateral[i];
+            float t2 = forward[j] - refForwardMm, x2 = lateral[j];
+            float t3 = forward[k] - refForwardMm, x3 = lateral[k];
+            if (fabsf(t2 - t1) < 1.0f || fabsf(t3 - t1) < 1.0f || fabsf(t3 - t2) < 1.0f) continue;
+
+            // Parabola through three points (divided differences)
+            float d12 = (x2 - x1) / (t2 - t1);
+            float d13 = (x3 - x1) / (t3 - t1);
+            float c = (d13 - d12) / (t3 - t2);
+            float b = d12 - c * (t1 + t2);
+            float a = x1 - b * t1 - c * t1 * t1;
+
+            int support = 0;
+            float error = 0.0f;
+            bool mask[CURVE_FIT_MAX_POINTS];
+            for (int p = 0; p < count; p++) {
+                float t = forward[p] - refForwardMm;
+                float r = fabsf(lateral[p] - (a + b * t + c * t * t));
+                mask[p] = (r <= inlierToleranceMm);
+                if (mask[p]) {
+                    support++;
+                    error += r;
+                }
+            }
+
+            if (support > bestSupport || (support == bestSupport && error < bestError)) {
+                bestSupport = support;
+                bestError = error;
+                for (int p = 0; p < count; p++) bestMask[p] = mask[p];
+                if (support == count) break;
+            }
+        }
+
+        // Without a consensus of at least three points keep every point
+        if (bestSupport >= 3) {
+            for (int p = 0; p < count; p++) inlier[p] = bestMask[p];
+        }
+    }
+
+    // Least-squares refit on the inliers
+    QuadraticFit ls;
+    const float scale = (float)(1 << CURVE_FIT_SHIFT);
+    for (int p = 0; p < count; p++) {
+        if (!inlier[p]) continue;
+        ls.add((int32_t)lroundf((forward[p] - refForwardMm) * scale),
+               (int32_t)lroundf(lateral[p] * scale));
+    }
+
+    float a, b, c;
+    if (!ls.solve(a, b, c)) return false;
+
+    float sumSq = 0.0f;
+    for (int p = 0; p < count; p++) {
+        if (!inlier[p]) continue;
+        float t = forward[p] - refForwardMm;
+        float r = lateral[p] - (a + b * t + c * t * t);
+        sumSq += r * r;
+    }
+
+    float slope = 1.0f + b * b;
+    out.valid = true;
+    out.positionMm = a;
+    out.headingRad = atanf(b);
+    out.curvature = 2.0f * c / (slope * sqrtf(slope)) * 1000.0f;  // 1/mm -> 1/m
+    out.inliers = ls.count();
+    out.rmsMm = sqrtf(sumSq / ls.count());
+    return true;
+}
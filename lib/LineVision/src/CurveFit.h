@@ -0,0 +1,91 @@
+#ifndef CURVE_FIT_H
+#define CURVE_FIT_H
+
+#include <stdint.h>
+
+/*
+ * Robust quadratic fit of the line on the floor plane.
+ *
+ * Points are (forward, lateral) in mm, the model is
+ *   lateral(t) = a + b*t + c*t^2,   t = forward - refForward
+ * so a is the lateral position, atan(b) the heading and 2c/(1+b^2)^1.5
+ * the curvature of the line at the reference distance.
+ *
+ * Outliers (glare, a neighbouring line, a bad row) are rejected with a
+ * RANSAC pass over 3-point models before the final least-squares refit.
+ */
+
+#define CURVE_FIT_MAX_POINTS 64
+
+// Fixed-point resolution of the accumulators: 1/4 mm
+#define CURVE_FIT_SHIFT 2
+
+// RANSAC sampling seed, restored at the start of every fit()
+#define CURVE_FIT_SEED 0x9E3779B9u
+
+// Fit result in robot units
+typedef struct {
+    bool valid;
+    float positionMm;     // Lateral offset at refForwardMm (+ = right)
+    float headingRad;     // Line direction vs. robot forward (+ = to the right)
+    float curvature;      // 1/m (+ = bending right), 0 for a straight line
+    float refForwardMm;   // Forward distance the values refer to
+    float rmsMm;          // RMS residual of the inliers
+    int inliers;          // Points used in the final fit
+    int points;           // Points offered to the fit
+} LineCurve;
+
+// Incremental least-squares accumulator in fixed point
+class QuadraticFit {
+private:
+    int32_t n;
+    int64_t st[5];   // Sum of t^k, k = 0..4
+    int64_t sx[3];   // Sum of x*t^k, k = 0..2
+
+public:
+    QuadraticFit();
+
+    void reset();
+
+    // Add one point, t and x in CURVE_FIT_SHIFT fixed point
+    void add(int32_t tQ, int32_t xQ);
+
+    int count() const { return n; }
+
+    // Solve for lateral = a + b*t + c*t^2 in mm. Falls back to a line or
+    // a constant when the points do not constrain the higher terms.
+    bool solve(float& a, float& b, float& c) const;
+};
+
+class CurveFit {
+private:
+    float forward[CURVE_FIT_MAX_POINTS];
+    float lateral[CURVE_FIT_MAX_POINTS];
+    int count;
+
+    float inlierToleranceMm;
+    int iterations;
+    uint32_t rngState;
+
+    uint32_t nextRandom();
+
+public:
+    CurveFit();
+
+    // Clear collected points
+    void reset();
+
+    // Add a floor point. Returns false when the buffer is full.
+    bool addPoint(float forwardMm, float lateralMm);
+
+    int getPointCount() const { return count; }
+
+    // RANSAC parameters
+    void setInlierTolerance(float mm) { inlierToleranceMm = mm; }
+    void setIterations(int n) { iterations = n; }
+
+    // Fit the collected points, evaluated at refForwardMm
+    bool fit(float refForwardMm, LineCurve& out);
+};
+
+#endif // CURVE_FIT_H
@@ -0,0 +1,54 @@
+#include "FrameContainer.h"
+#include <string.h>
+
+static void putU16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static void putU32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+static uint16_t getU16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) |
+           ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+void frameEncodeFileHeader(const FrameFileHeader& header, uint8_t* out) {
+    memcpy(out, FRAME_CONTAINER_MAGIC, 4);
+    putU16(out + 4, header.version);
+    putU16(out + 6, header.width);
+    putU16(out + 8, header.height);
+    putU16(out + 10, header.format);
+    putU32(out + 12, header.frameCount);
+}
+
+void frameEncodeFrameHeader(const FrameHeader& header, uint8_t* out) {
+    putU32(out, header.timestampUs);
+    putU32(out + 4, header.length);
+}
+
+bool frameDecodeFileHeader(const uint8_t* in, FrameFileHeader& header) {
+    if (memcmp(in, FRAME_CONTAINER_MAGIC, 4) != 0) return false;
+    header.version = getU16(in + 4);
+    header.width = getU16(in + 6);
+    header.height = getU16(in + 8);
+    header.format = getU16(in + 10);
+    header.frameCount = getU32(in + 12);
+    return header.version == FRAME_CONTAINER_VERSION &&
+           header.format == FRAME_CONTAINER_FORMAT_GRAY8 &&
+           header.width > 0 && header.height > 0;
+}
+
+void frameDecodeFrameHeader(const uint8_t* in, FrameHeader& header) {
+    header.timestampUs = getU32(in);
+    header.length = getU32(in + 4);
+}
@@ -0,0 +1,47 @@
+#ifndef FRAME_CONTAINER_H
+#define FRAME_CONTAINER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Raw grayscale frame sequence, as recorded by /capture-raw and read by
+ * tools/replay. All fields are little-endian.
+ *
+ *   file:  FileHeader (16 bytes), then frames until EOF
+ *   frame: FrameHeader (8 bytes), then width * height pixels, row-major
+ *
+ * FileHeader:  "LVRF" | u16 version | u16 width | u16 height |
+ *              u16 format (0 = GRAY8) | u32 frameCount (0 = until EOF)
+ * FrameHeader: u32 timestampUs (capture time, esp_timer clock) |
+ *              u32 pixel byte count
+ */
+
+#define FRAME_CONTAINER_MAGIC        "LVRF"
+#define FRAME_CONTAINER_VERSION      1
+#define FRAME_CONTAINER_FORMAT_GRAY8 0
+#define FRAME_CONTAINER_FILE_HEADER  16
+#define FRAME_CONTAINER_FRAME_HEADER 8
+
+typedef struct {
+    uint16_t version;
+    uint16_t width;
+    uint16_t height;
+    uint16_t format;
+    uint32_t frameCount;
+} FrameFileHeader;
+
+typedef struct {
+    uint32_t timestampUs;
+    uint32_t length;
+} FrameHeader;
+
+// Serialize into out[FRAME_CONTAINER_FILE_HEADER] / out[FRAME_CONTAINER_FRAME_HEADER]
+void frameEncodeFileHeader(const FrameFileHeader& header, uint8_t* out);
+void frameEncodeFrameHeader(const FrameHeader& header, uint8_t* out);
+
+// Parse; false on bad magic, unknown version or format
+bool frameDecodeFileHeader(const uint8_t* in, FrameFileHeader& header);
+void frameDecodeFrameHeader(const uint8_t* in, FrameHeader& header);
+
+#endif // FRAME_CONTAINER_H
@@ -0,0 +1,61 @@
+#include "GroundProjection.h"
+#include <math.h>
+
+static const float DEG_TO_RAD_F = 0.017453292519943f;
+
+GroundProjection::GroundProjection() {
+    // Identity until configured
+    for (int i = 0; i < 9; i++) h[i] = 0.0f;
+    h[0] = h[4] = h[8] = 1.0f;
+}
+
+void GroundProjection::setMounting(int imageWidth, int imageHeight,
+                                   float heightMm, float tiltDeg, float hfovDeg, float offsetMm) {
+    /*
+     * Camera ray for pixel (u, v): a = (u - cx) / f, b = (v - cy) / f
+     * Rotated by the tilt angle t into robot axes:
+     *   down    = sin(t) + b * cos(t)
+     *   forward = cos(t) - b * sin(t)
+     *   lateral = a
+     * Scaling the ray to hit the floor (down * s = height) gives a
+     * projective map, i.e. a homography in (u, v, 1).
+     */
+    float f = (imageWidth * 0.5f) / tanf(hfovDeg * 0.5f * DEG_TO_RAD_F);
+    float cx = (imageWidth - 1) * 0.5f;
+    float cy = (imageHeight - 1) * 0.5f;
+    float s = sinf(tiltDeg * DEG_TO_RAD_F);
+    float c = cosf(tiltDeg * DEG_TO_RAD_F);
+
+    // w = down
+    float w1 = c / f;
+    float w2 = s - cy * c / f;
+
+    // forward * w = offset * down + height * forwardRay
+    h[0] = 0.0f;
+    h[1] = offsetMm * w1 - heightMm * s / f;
+    h[2] = offsetMm * w2 + heightMm * (c + cy * s / f);
+
+    // lateral * w = height * a
+    h[3] = heightMm / f;
+    h[4] = 0.0f;
+    h[5] = -heightMm * cx / f;
+
+    h[6] = 0.0f;
+    h[7] = w1;
+    h[8] = w2;
+}
+
+void GroundProjection::setMatrix(const float matrix[9]) {
+    for (int i = 0; i < 9; i++) h[i] = matrix[i];
+}
+
+bool GroundProjection::project(float u, float v, float& forwardMm, float& lateralMm) const {
+    float w = h[6] * u + h[7] * v + h[8];
+    if (w <= 1e-6f) {
+        return false;  // Horizon or above
+    }
+
+    forwardMm = (h[0] * u + h[1] * v + h[2]) / w;
+    lateralMm = (h[3] * u + h[4] * v + h[5]) / w;
+    return true;
+}
@@ -0,0 +1,39 @@
+#ifndef GROUND_PROJECTION_H
+#define GROUND_PROJECTION_H
+
+/*
+ * Camera-to-ground homography.
+ *
+ * Maps image pixels (u to the right, v down) to the floor plane in robot
+ * coordinates: forward = mm ahead of the drive wheel axle, lateral = mm to
+ * the right of the robot centerline (same sign as the sensor array error).
+ *
+ * The matrix can be built from the camera mounting described in
+ * ROBOT_GEOMETRY.md (height, downward tilt, horizontal field of view and
+ * distance ahead of the axle) or loaded directly from a calibration.
+ */
+class GroundProjection {
+private:
+    float h[9];  // Row-major 3x3, pixel -> (forward*w, lateral*w, w)
+
+public:
+    GroundProjection();
+
+    // Build from a pinhole model of the mounted camera
+    // imageWidth/imageHeight - frame size in pixels
+    // heightMm  - lens height above the floor
+    // tiltDeg   - downward pitch of the optical axis from horizontal
+    // hfovDeg   - horizontal field of view of the lens
+    // offsetMm  - lens position ahead of the wheel axle
+    void setMounting(int imageWidth, int imageHeight,
+                     float heightMm, float tiltDeg, float hfovDeg, float offsetMm);
+
+    // Load a calibrated matrix (row-major, 9 values)
+    void setMatrix(const float matrix[9]);
+
+    // Project a pixel onto the floor. Returns false if the pixel is at or
+    // above the horizon and has no ground intersection.
+    bool project(float u, float v, float& forwardMm, float& lateralMm) const;
+};
+
+#endif // GROUND_PROJECTION_H
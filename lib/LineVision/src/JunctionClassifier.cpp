@@ -0,0 +1,157 @@
+#include "JunctionClassifier.h"
+
+// Rows of line width samples used for the median
+#define WIDTH_SAMPLES 64
+
+JunctionClassifier::JunctionClassifier()
+    : barFactor(2.5f), armFactor(1.5f),
+      markerMinFactor(0.5f), markerMaxFactor(6.0f), markerMaxElongation(3.0f) {
+}
+
+static int medianWidth(int16_t* widths, int count) {
+    // Insertion sort, count <= WIDTH_SAMPLES
+    for (int i = 1; i < count; i++) {
+        int16_t value = widths[i];
+        int j = i;
+        while (j > 0 && widths[j - 1] > value) {
+            widths[j] = widths[j - 1];
+            j--;
+        }
+        widths[j] = value;
+    }
+    return widths[count / 2];
+}
+
+void JunctionClassifier::classify(const BlobLabeler& labeler, SceneInfo& out) const {
+    out.junction = JUNCTION_NONE;
+    out.exits = 0;
+    out.junctionRow = -1;
+    out.mainBlob = -1;
+    out.lineWidthPx = 0;
+    out.markerLeft = false;
+    out.markerRight = false;
+
+    int blobCount;
+    const Blob* blobs = labeler.getBlobs(blobCount);
+    if (blobCount == 0) return;
+
+    // Main line: largest blob reaching the bottom edge (blobs are sorted by area)
+    int main = 0;
+    for (int i = 0; i < blobCount; i++) {
+        if (blobs[i].edges & BLOB_EDGE_BOTTOM) {
+            main = i;
+            break;
+        }
+    }
+    out.mainBlob = (int16_t)main;
+    const Blob& line = blobs[main];
+
+    // Line width: median of single-run rows, lower half of the blob first
+    int16_t widths[WIDTH_SAMPLES];
+    int widthCount = 0;
+    int midRow = (line.minY + line.maxY) / 2;
+    for (int pass = 0; pass < 2 && widthCount == 0; pass++) {
+        int top = pass == 0 ? midRow : line.minY;
+        for (int row = line.maxY; row >= top && widthCount < WIDTH_SAMPLES; row--) {
+            int count;
+            const BlobRun* runs = labeler.getRowRuns(row, count);
+            int found = 0;
+            int width = 0;
+            for (int r = 0; r < count; r++) {
+                if (runs[r].blob != main) continue;
+                found++;
+                width = runs[r].x1 - runs[r].x0 + 1;
+            }
+            if (found == 1) widths[widthCount++] = (int16_t)width;
+        }
+    }
+    int lineWidth = widthCount > 0 ? medianWidth(widths, widthCount) : (line.maxX - line.minX + 1);
+    if (lineWidth < 1) lineWidth = 1;
+    out.lineWidthPx = (int16_t)lineWidth;
+
+    // Walk up from the bottom
+    float center = -1.0f;
+    bool armLeft = false;
+    bool armRight = false;
+    int barLow = -1;
+    int barHigh = -1;
+    int splitLow = -1;
+    int splitRows = 0;
+    int rowsAboveBar = 0;
+
+    for (int row = line.maxY; row >= line.minY; row--) {
+        int count;
+        const BlobRun* runs = labeler.getRowRuns(row, count);
+        int found = 0;
+        int minX = 0, maxX = 0;
+        for (int r = 0; r < count; r++) {
+            if (runs[r].blob != main) continue;
+            if (found == 0 || runs[r].x0 < minX) minX = runs[r].x0;
+            if (found == 0 || runs[r].x1 > maxX) maxX = runs[r].x1;
+            found++;
+        }
+        if (found == 0) continue;
+
+        int span = maxX - minX + 1;
+        if (found == 1 && span > barFactor * lineWidth) {
+            if (barLow < 0) barLow = row;
+            barHigh = row;
+            rowsAboveBar = 0;
+            if (center >= 0.0f) {
+                if (center - minX > armFactor * lineWidth) armLeft = true;
+                if (maxX - center > armFactor * lineWidth) armRight = true;
+            }
+        } else if (found >= 2) {
+            if (splitLow < 0) splitLow = row;
+            splitRows++;
+            if (barHigh >= 0) rowsAboveBar++;
+        } else {
+            // Ordinary line row: track its center below the junction
+            if (barLow < 0) center = (minX + maxX) * 0.5f;
+            if (barHigh >= 0) rowsAboveBar++;
+        }
+    }
+
+    bool ahead = rowsAboveBar >= lineWidth;
+    if (barLow >= 0 && (armLeft || armRight)) {
+        out.junctionRow = (int16_t)barLow;
+        if (armLeft && armRight) out.junction = ahead ? JUNCTION_CROSS : JUNCTION_T;
+        else if (armLeft) out.junction = ahead ? JUNCTION_BRANCH_LEFT : JUNCTION_TURN_LEFT;
+        else out.junction = ahead ? JUNCTION_BRANCH_RIGHT : JUNCTION_TURN_RIGHT;
+
+        if (armLeft) out.exits |= JUNCTION_EXIT_LEFT;
+        if (armRight) out.exits |= JUNCTION_EXIT_RIGHT;
+        if (ahead) out.exits |= JUNCTION_EXIT_AHEAD;
+    } else if (splitRows >= lineWidth) {
+        out.junction = JUNCTION_FORK;
+        out.junctionRow = (int16_t)splitLow;
+        out.exits = JUNCTION_EXIT_LEFT | JUNCTION_EXIT_RIGHT;
+    } else if (line.minY < line.maxY) {
+        out.exits = JUNCTION_EXIT_AHEAD;
+    }
+
+    // Side markers: small compact blobs left or right of the main line
+    float lineArea = (float)lineWidth * lineWidth;
+    float lineCenter = center >= 0.0f ? center : line.cx;
+    for (int i = 0; i < blobCount; i++) {
+        if (i == main) continue;
+        const Blob& blob = blobs[i];
+        if (blob.area < markerMinFactor * lineArea || blob.area > markerMaxFactor * lineArea) continue;
+        if (blob.elongation > markerMaxElongation) continue;
+        if (blob.cx < lineCenter) out.markerLeft = true;
+        else out.markerRight = true;
+    }
+}
+
+const char* junctionName(JunctionType type) {
+    switch (type) {
+        case JUNCTION_CROSS:        return "cross";
+        case JUNCTION_T:            return "t";
+        case JUNCTION_BRANCH_LEFT:  return "branch_left";
+        case JUNCTION_BRANCH_RIGHT: return "branch_right";
+        case JUNCTION_TURN_LEFT:    return "turn_left";
+        case JUNCTION_TURN_RIGHT:   return "turn_right";
+        case JUNCTION_FORK:         return "fork";
+        default:                    return "none";
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef JUNCTION_CLASSIFIER_H
+#define JUNCTION_CLASSIFIER_H
+
+#include <stdint.h>
+#include "BlobLabeler.h"
+
+/*
+ * Tags crossings, T-junctions, side branches, forks and side markers from
+ * the labeled blobs, for LineFollower-style branch decisions.
+ *
+ * The main line is the largest blob touching the bottom edge. Its runs are
+ * walked from the bottom up:
+ * - a row much wider than the line (a bar) with arms reaching out to the
+ *   left and/or right marks a crossing line;
+ * - two or more separate runs in the same row mark a fork;
+ * - rows above the bar tell whether the line also continues ahead.
+ * Small compact blobs beside the main line are side markers.
+ */
+
+typedef enum {
+    JUNCTION_NONE = 0,     // Plain line (or no line)
+    JUNCTION_CROSS,        // Left, right and ahead
+    JUNCTION_T,            // Left and right, no way ahead
+    JUNCTION_BRANCH_LEFT,  // Ahead plus a branch to the left
+    JUNCTION_BRANCH_RIGHT,
+    JUNCTION_TURN_LEFT,    // 90-degree corner, left only
+    JUNCTION_TURN_RIGHT,
+    JUNCTION_FORK          // Y-split into two arms
+} JunctionType;
+
+// SceneInfo::exits bits
+#define JUNCTION_EXIT_LEFT  0x01
+#define JUNCTION_EXIT_RIGHT 0x02
+#define JUNCTION_EXIT_AHEAD 0x04
+
+typedef struct {
+    JunctionType junction;
+    uint8_t exits;            // JUNCTION_EXIT_*
+    int16_t junctionRow;      // Image row of the bar / split, -1 when none
+    int16_t mainBlob;         // Index into BlobLabeler::getBlobs(), -1 when none
+    int16_t lineWidthPx;      // Median width of the main line
+    bool markerLeft;
+    bool markerRight;
+} SceneInfo;
+
+class JunctionClassifier {
+private:
+    float barFactor;          // Bar row: wider than barFactor * line width
+    float armFactor;          // Arm: reaches armFactor * line width past the line center
+    float markerMinFactor;    // Marker area range in line width^2
+    float markerMaxFactor;
+    float markerMaxElongation;
+
+public:
+    JunctionClassifier();
+
+    void setBarFactor(float factor) { barFactor = factor; }
+    void setArmFactor(float factor) { armFactor = factor; }
+    void setMarkerArea(float minFactor, float maxFactor) {
+        markerMinFactor = minFactor;
+        markerMaxFactor = maxFactor;
+    }
+
+    void classify(const BlobLabeler& labeler, SceneInfo& out) const;
+};
+
+// Short lowercase name ("cross", "t", "branch_left", ...)
+const char* junctionName(JunctionType type);
+
+#endif // JUNCTION_CLASSIFIER_H
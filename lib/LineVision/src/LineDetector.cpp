@@ -0,0 +1,83 @@
+#include "LineDetector.h"
+
+LineDetector::LineDetector()
+    : centroidCount(0),
+      heightMm(120.0f), tiltDeg(35.0f), hfovDeg(60.0f), offsetMm(40.0f),
+      projectionWidth(0), projectionHeight(0),
+      threshold(128), minWidth(10), rowStep(3) {
+    contrast.valid = false;
+}
+
+void LineDetector::setMounting(float height, float tilt, float hfov, float offset) {
+    heightMm = height;
+    tiltDeg = tilt;
+    hfovDeg = hfov;
+    offsetMm = offset;
+    projectionWidth = 0;  // Rebuild on the next frame
+    projectionHeight = 0;
+}
+
+bool LineDetector::detect(const uint8_t* pixels, int width, int height, LineEstimate& out) {
+    out.detected = false;
+    out.positionPercent = -1;
+    out.widthPx = 0;
+    out.confidence = 0;
+    out.positionMm = 0.0f;
+    out.headingRad = 0.0f;
+    out.curvature = 0.0f;
+    out.refForwardMm = 0.0f;
+    centroidCount = 0;
+    contrast.valid = false;
+
+    if (!pixels || width <= 0 || height <= 0) return false;
+
+    if (width != projectionWidth || height != projectionHeight) {
+        projection.setMounting(width, height, heightMm, tiltDeg, hfovDeg, offsetMm);
+        projectionWidth = width;
+        projectionHeight = height;
+    }
+
+    int startRow = height / 6;
+    int endRow = (5 * height) / 6;
+    int rowsScanned = (endRow - startRow + rowStep - 1) / rowStep;
+
+    measureContrast(pixels, width, height, startRow, endRow, rowStep, contrast);
+
+    int count = scanRowCentroids(pixels, width, height, startRow, endRow, rowStep,
+                                 threshold, minWidth, centroids, CURVE_FIT_MAX_POINTS);
+    centroidCount = count;
+    if (count == 0) return false;
+
+    // Legacy outputs: nearest (lowest) row and average run width
+    int widthSum = 0;
+    for (int i = 0; i < count; i++) widthSum += centroids[i].width;
+    const RowCentroid& nearest = centroids[count - 1];
+    out.positionPercent = (int)((((int64_t)nearest.centerQ8 * 100) >> ROW_CENTER_SHIFT) / width);
+    out.widthPx = widthSum / count;
+    out.detected = true;
+
+    curveFit.reset();
+    float nearestForward = 1e9f;
+    for (int i = 0; i < count; i++) {
+        float u = centroids[i].centerQ8 / (float)(1 << ROW_CENTER_SHIFT);
+        float forward, lateral;
+        if (projection.project(u, centroids[i].row, forward, lateral)) {
+            curveFit.addPoint(forward, lateral);
+            if (forward < nearestForward) nearestForward = forward;
+        }
+    }
+
+    LineCurve curve;
+    if (curveFit.getPointCount() >= 2 && curveFit.fit(nearestForward, curve)) {
+        out.positionMm = curve.positionMm;
+        out.headingRad = curve.headingRad;
+        out.curvature = curve.curvature;
+        out.refForwardMm = curve.refForwardMm;
+        out.confidence = rowsScanned > 0 ? (curve.inliers * 100) / rowsScanned : 0;
+        if (out.confidence > 100) out.confidence = 100;
+    } else {
+        out.confidence = rowsScanned > 0 ? (count * 50) / rowsScanned : 0;
+    }
+
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef LINE_DETECTOR_H
+#define LINE_DETECTOR_H
+
+#include <stdint.h>
+#include "RowScan.h"
+#include "GroundProjection.h"
+#include "CurveFit.h"
+#include "ContrastStats.h"
+
+/*
+ * Full camera line estimate for one grayscale frame: per-row centroids,
+ * floor projection and robust curve fit, plus the legacy percentage
+ * position used by the web interface.
+ */
+
+typedef struct {
+    bool detected;
+    int positionPercent;   // Nearest centroid, 0-100% of frame width
+    int widthPx;           // Average width of the dark runs
+    int confidence;        // 0-100, share of scanned rows that agree with the fit
+    float positionMm;      // Lateral offset at refForwardMm (+ = right)
+    float headingRad;      // + = line goes to the right
+    float curvature;       // 1/m, + = turning right
+    float refForwardMm;    // Distance ahead of the wheel axle
+} LineEstimate;
+
+class LineDetector {
+private:
+    GroundProjection projection;
+    CurveFit curveFit;
+
+    // Centroids of the last analyzed frame (for overlays and debugging)
+    RowCentroid centroids[CURVE_FIT_MAX_POINTS];
+    int centroidCount;
+
+    // Line / field histogram of the scan band (for exposure control)
+    ContrastStats contrast;
+
+    // Mounting, applied lazily when the frame size is known
+    float heightMm, tiltDeg, hfovDeg, offsetMm;
+    int projectionWidth, projectionHeight;
+
+    uint8_t threshold;
+    int minWidth;
+    int rowStep;
+
+public:
+    LineDetector();
+
+    // Camera mounting, see ROBOT_GEOMETRY.md
+    void setMounting(float heightMm, float tiltDeg, float hfovDeg, float offsetMm);
+
+    // Binarization and scan parameters
+    void setThreshold(uint8_t value) { threshold = value; }
+    uint8_t getThreshold() const { return threshold; }
+    void setMinWidth(int pixels) { minWidth = pixels; }
+    void setRowStep(int rows) { rowStep = rows; }
+    void setInlierTolerance(float mm) { curveFit.setInlierTolerance(mm); }
+
+    // Analyze rows height/6 .. 5*height/6 of a grayscale frame
+    bool detect(const uint8_t* pixels, int width, int height, LineEstimate& out);
+
+    // Row centroids found by the last detect() call
+    const RowCentroid* getCentroids(int& count) const {
+        count = centroidCount;
+        return centroids;
+    }
+
+    // Histogram separation measured by the last detect() call
+    const ContrastStats& getContrast() const { return contrast; }
+};
+
+#endif // LINE_DETECTOR_H
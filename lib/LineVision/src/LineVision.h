@@ -0,0 +1,34 @@
+#ifndef LINE_VISION_H
+#define LINE_VISION_H
+
+/*
+ * LineVision - camera-side line detection helpers shared by the
+ * ESP32-CAM sketches.
+ *
+ * - RowScan:          per-row line centroids from a grayscale frame
+ * - GroundProjection: pixel -> floor (mm) homography from the camera mount
+ * - CurveFit:         robust position / heading / curvature fit
+ * - LineDetector:     the three steps above as one per-frame estimate
+ * - ContrastStats:    line / field histogram peaks of the scan band
+ * - ContrastExposure: exposure / gain control for maximum line contrast
+ * - RegionScan:       legacy three-region scan of the example sketches
+ * - FrameContainer:   raw frame sequence format (/capture-raw, tools/replay)
+ * - BlobLabeler:      run-length connected components with shape moments
+ * - JunctionClassifier: crossings, branches, forks and side markers
+ *
+ * Nothing here depends on Arduino or esp_camera, so the whole pipeline
+ * also builds on a host (see tools/replay).
+ */
+
+#include "RowScan.h"
+#include "GroundProjection.h"
+#include "CurveFit.h"
+#include "LineDetector.h"
+#include "ContrastStats.h"
+#include "ContrastExposure.h"
+#include "RegionScan.h"
+#include "FrameContainer.h"
+#include "BlobLabeler.h"
+#include "JunctionClassifier.h"
+
+#endif // LINE_VISION_H
@@ -0,0 +1,72 @@
+#include "RegionScan.h"
+#include <math.h>
+
+int scanRegionCenter(const uint8_t* pixels, int width, int height,
+                     int startRow, int endRow, int rowStep,
+                     uint8_t threshold, int minWidth) {
+    if (!pixels || width <= 0 || rowStep <= 0) return -1;
+    if (startRow < 0) startRow = 0;
+    if (endRow > height) endRow = height;
+
+    int totalDarkStart = 0;
+    int totalDarkEnd = 0;
+    int detectionCount = 0;
+
+    for (int row = startRow; row < endRow; row += rowStep) {
+        const uint8_t* line = pixels + row * width;
+        int x = 0;
+
+        while (x < width && line[x] >= threshold) x++;
+        if (x >= width) continue;
+
+        int darkStart = x;
+        while (x < width && line[x] < threshold) x++;
+        int darkEnd = x - 1;
+
+        if (darkEnd - darkStart >= minWidth) {
+            totalDarkStart += darkStart;
+            totalDarkEnd += darkEnd;
+            detectionCount++;
+        }
+    }
+
+    if (detectionCount == 0) return -1;
+
+    int avgDarkStart = totalDarkStart / detectionCount;
+    int avgDarkEnd = totalDarkEnd / detectionCount;
+    return (avgDarkStart + avgDarkEnd) / 2;
+}
+
+void scanThreeRegions(const uint8_t* pixels, int width, int height,
+                      int rowStep, uint8_t threshold, int minWidth,
+                      RegionCenters& out) {
+    out.top = scanRegionCenter(pixels, width, height, height / 6, height / 3,
+                               rowStep, threshold, minWidth);
+    out.middle = scanRegionCenter(pixels, width, height, height / 3, (2 * height) / 3,
+                                  rowStep, threshold, minWidth);
+    out.bottom = scanRegionCenter(pixels, width, height, (2 * height) / 3, (5 * height) / 6,
+                                  rowStep, threshold, minWidth);
+}
+
+int regionMainCenter(const RegionCenters& centers) {
+    if (centers.bottom >= 0) return centers.bottom;
+    if (centers.middle >= 0) return centers.middle;
+    return centers.top;
+}
+
+bool regionCurveAngle(const RegionCenters& centers, int width, float& angleDeg) {
+    angleDeg = 0.0f;
+
+    // Vertical distances between region centers as a share of the width
+    if (centers.bottom >= 0 && centers.top >= 0) {
+        float displacement = (float)(centers.bottom - centers.top);
+        angleDeg = atanf(displacement / (width * 0.4f)) * 180.0f / (float)M_PI;
+        return true;
+    }
+    if (centers.bottom >= 0 && centers.middle >= 0) {
+        float displacement = (float)(centers.bottom - centers.middle);
+        angleDeg = atanf(displacement / (width * 0.3f)) * 180.0f / (float)M_PI;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,39 @@
+#ifndef REGION_SCAN_H
+#define REGION_SCAN_H
+
+#include <stdint.h>
+
+/*
+ * Legacy three-region line scan used by the example sketches
+ * (detectLineInRegion / detectLineMultiRegion), kept free of camera
+ * types so it can be replayed and timed on a host.
+ *
+ * Each scanned row contributes the first dark run; a row counts when that
+ * run is at least minWidth wide. The region center is the midpoint of the
+ * averaged run edges.
+ */
+
+typedef struct {
+    int top;       // Line center in pixels, -1 when not found
+    int middle;
+    int bottom;
+} RegionCenters;
+
+// Center of the line in rows [startRow, endRow), or -1
+int scanRegionCenter(const uint8_t* pixels, int width, int height,
+                     int startRow, int endRow, int rowStep,
+                     uint8_t threshold, int minWidth);
+
+// Rows h/6..h/3, h/3..2h/3 and 2h/3..5h/6
+void scanThreeRegions(const uint8_t* pixels, int width, int height,
+                      int rowStep, uint8_t threshold, int minWidth,
+                      RegionCenters& out);
+
+// Nearest found center (bottom, then middle, then top), -1 when none
+int regionMainCenter(const RegionCenters& centers);
+
+// Curve angle in degrees from the bottom-top (or bottom-middle) displacement.
+// Returns false when fewer than two usable regions were found.
+bool regionCurveAngle(const RegionCenters& centers, int width, float& angleDeg);
+
+#endif // REGION_SCAN_H
@@ -0,0 +1,45 @@
+#include "RowScan.h"
+
+int scanRowCentroids(const uint8_t* pixels, int width, int height,
+                     int startRow, int endRow, int rowStep,
+                     uint8_t threshold, int minWidth,
+                     RowCentroid* out, int maxOut) {
+    if (!pixels || !out || width <= 0 || rowStep <= 0) return 0;
+    if (startRow < 0) startRow = 0;
+    if (endRow > height) endRow = height;
+
+    int count = 0;
+
+    for (int row = startRow; row < endRow && count < maxOut; row += rowStep) {
+        const uint8_t* line = pixels + row * width;
+        int x = 0;
+
+        while (x < width) {
+            // Skip bright field
+            while (x < width && line[x] >= threshold) x++;
+            if (x >= width) break;
+
+            // Accumulate the dark run
+            int runStart = x;
+            uint32_t weightSum = 0;
+            uint32_t momentSum = 0;
+            while (x < width && line[x] < threshold) {
+                uint32_t w = threshold - line[x];
+                weightSum += w;
+                momentSum += w * (uint32_t)x;
+                x++;
+            }
+
+            // Same width rule as detectLineInRegion: end - start >= minWidth
+            if ((x - 1) - runStart >= minWidth && weightSum > 0) {
+                out[count].row = (int16_t)row;
+                out[count].width = (int16_t)(x - runStart);
+                out[count].centerQ8 = (int32_t)(((uint64_t)momentSum << ROW_CENTER_SHIFT) / weightSum);
+                count++;
+                break;
+            }
+        }
+    }
+
+    return count;
+}
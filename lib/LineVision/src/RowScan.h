@@ -0,0 +1,31 @@
+#ifndef ROW_SCAN_H
+#define ROW_SCAN_H
+
+#include <stdint.h>
+
+/*
+ * Per-row line centroid extraction from a grayscale frame.
+ *
+ * Each scanned row contributes at most one centroid: the first dark run
+ * that is at least minWidth pixels wide. The centroid is weighted by
+ * darkness (threshold - pixel), which gives sub-pixel accuracy at the
+ * edges of the line.
+ */
+
+// Fractional bits of RowCentroid::centerQ8
+#define ROW_CENTER_SHIFT 8
+
+typedef struct {
+    int16_t row;        // Image row (0 = top of the frame)
+    int16_t width;      // Width of the dark run in pixels
+    int32_t centerQ8;   // Weighted center in pixels, Q24.8
+} RowCentroid;
+
+// Scan rows [startRow, endRow) with rowStep and store up to maxOut centroids.
+// Returns the number of centroids written.
+int scanRowCentroids(const uint8_t* pixels, int width, int height,
+                     int startRow, int endRow, int rowStep,
+                     uint8_t threshold, int minWidth,
+                     RowCentroid* out, int maxOut);
+
+#endif // ROW_SCAN_H
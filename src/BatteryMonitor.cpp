@@ -0,0 +1,66 @@
+#include "BatteryMonitor.h"
+
+// Измерений АЦП на один отсчет (усреднение шума)
+#define BATTERY_OVERSAMPLE 8
+
+BatteryMonitor::BatteryMonitor(uint8_t p)
+    : pin(p), voltage(0.0), scale(1.0), state(BATTERY_ABSENT),
+      initialized(false), belowCriticalSince(0) {
+}
+
+void BatteryMonitor::begin() {
+    // 11 дБ - диапазон до ~3.1 В, делитель дает 2.7 В на полной батарее
+    analogSetPinAttenuation(pin, ADC_11db);
+    voltage = readVoltage();
+    initialized = true;
+    sample();
+}
+
+float BatteryMonitor::readVoltage() {
+    // analogReadMilliVolts учитывает калибровку АЦП из eFuse
+    uint32_t sum = 0;
+    for (int i = 0; i < BATTERY_OVERSAMPLE; i++) {
+        sum += analogReadMilliVolts(pin);
+    }
+    return (sum / (float)BATTERY_OVERSAMPLE) * BATTERY_DIVIDER / 1000.0;
+}
+
+void BatteryMonitor::sample() {
+    float raw = readVoltage();
+    float filtered = initialized ? voltage + BATTERY_FILTER_ALPHA * (raw - voltage) : raw;
+    voltage = filtered;
+    
+    // Нет батареи - не компенсируем и не останавливаем
+    if (filtered < BATTERY_ABSENT_V) {
+        scale = 1.0;
+        if (state != BATTERY_CRITICAL) state = BATTERY_ABSENT;
+        belowCriticalSince = 0;
+        return;
+    }
+    
+    scale = constrain(BATTERY_NOMINAL_V / filtered, 0.5, BATTERY_MAX_SCALE);
+    
+    // Критический разряд фиксируется, только если длится дольше просадок под нагрузкой
+    if (state == BATTERY_CRITICAL) return;
+    if (filtered < BATTERY_CRITICAL_V) {
+        if (belowCriticalSince == 0) belowCriticalSince = millis();
+        if (millis() - belowCriticalSince >= BATTERY_CRITICAL_MS) {
+            state = BATTERY_CRITICAL;
+            return;
+        }
+    } else {
+        belowCriticalSince = 0;
+    }
+    
+    state = filtered < BATTERY_LOW_V ? BATTERY_LOW : BATTERY_OK;
+}
+
+const char* batteryStateName(BatteryState state) {
+    switch (state) {
+        case BATTERY_ABSENT:   return "нет (USB)";
+        case BATTERY_OK:       return "норма";
+        case BATTERY_LOW:      return "разряжена";
+        case BATTERY_CRITICAL: return "КРИТИЧЕСКИЙ РАЗРЯД";
+        default:               return "?";
+    }
+}
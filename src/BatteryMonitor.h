@@ -0,0 +1,56 @@
+#ifndef BATTERY_MONITOR_H
+#define BATTERY_MONITOR_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// Состояние батареи
+enum BatteryState {
+    BATTERY_ABSENT,    // Напряжения нет (питание от USB)
+    BATTERY_OK,
+    BATTERY_LOW,       // Пора заканчивать заезд
+    BATTERY_CRITICAL   // Остановка, держится до перезагрузки
+};
+
+// Класс для контроля напряжения батареи
+// sample() вызывается из отдельной задачи (не из цикла управления),
+// остальные методы только читают готовые значения.
+class BatteryMonitor {
+private:
+    uint8_t pin;
+    
+    volatile float voltage;      // Отфильтрованное напряжение, В
+    volatile float scale;        // Коэффициент компенсации ШИМ
+    volatile BatteryState state;
+    
+    bool initialized;
+    unsigned long belowCriticalSince;
+    
+    float readVoltage();
+    
+public:
+    BatteryMonitor(uint8_t pin = BATTERY_PIN);
+    
+    // Инициализация АЦП
+    void begin();
+    
+    // Одно измерение и пересчет состояния (период BATTERY_SAMPLE_MS)
+    void sample();
+    
+    // Отфильтрованное напряжение, В
+    float getVoltage() const { return voltage; }
+    
+    // Напряжение на банку, В
+    float getCellVoltage() const { return voltage / BATTERY_CELLS; }
+    
+    // Во сколько раз увеличить ШИМ, чтобы получить напряжение BATTERY_NOMINAL_V
+    float getScale() const { return scale; }
+    
+    BatteryState getState() const { return state; }
+    bool isCritical() const { return state == BATTERY_CRITICAL; }
+};
+
+// Название состояния для вывода
+const char* batteryStateName(BatteryState state);
+
+#endif // BATTERY_MONITOR_H
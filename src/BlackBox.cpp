@@ -0,0 +1,190 @@
+#include "BlackBox.h"
+#include <LittleFS.h>
+
+#define BLACKBOX_DIR "/blackbox"
+
+portMUX_TYPE BlackBox::mux = portMUX_INITIALIZER_UNLOCKED;
+
+const char* blackBoxReasonName(uint8_t reason) {
+    switch (reason) {
+        case BLACKBOX_LINE_LOST:      return "потеря линии";
+        case BLACKBOX_SEARCH_TIMEOUT: return "таймаут поиска";
+        case BLACKBOX_BUTTON_STOP:    return "стоп кнопкой";
+        default:                      return "?";
+    }
+}
+
+BlackBox::BlackBox()
+    : head(0), count(0), lastRecordTime(0), frozen(false), savePending(false),
+      triggerReason(0), triggerTime(0), mounted(false), nextIndex(0) {
+}
+
+void BlackBox::fileName(uint32_t index, char* buffer, size_t size) {
+    snprintf(buffer, size, BLACKBOX_DIR "/%04lu.bin", (unsigned long)index);
+}
+
+bool BlackBox::begin() {
+    if (!LittleFS.begin(true)) {
+        Serial.println("✗ BlackBox: LittleFS не смонтирована, записи не сохраняются");
+        return false;
+    }
+    mounted = true;
+
+    if (!LittleFS.exists(BLACKBOX_DIR)) {
+        LittleFS.mkdir(BLACKBOX_DIR);
+    }
+
+    // Продолжаем нумерацию после последнего файла
+    File dir = LittleFS.open(BLACKBOX_DIR);
+    File file = dir.openNextFile();
+    while (file) {
+        uint32_t index = strtoul(file.name(), nullptr, 10);
+        if (index + 1 > nextIndex) nextIndex = index + 1;
+        file = dir.openNextFile();
+    }
+    return true;
+}
+
+void BlackBox::record(const BlackBoxRecord& r) {
+    if (frozen) return;
+    if (count > 0 && r.timeUs - lastRecordTime < BLACKBOX_PERIOD_MS * 1000UL) return;
+
+    lastRecordTime = r.timeUs;
+    records[head] = r;
+    head = (head + 1) % BLACKBOX_RECORDS;
+    if (count < BLACKBOX_RECORDS) count++;
+}
+
+void BlackBox::trigger(BlackBoxReason reason) {
+    if (!mounted || count == 0) return;
+
+    portENTER_CRITICAL(&mux);
+    bool accepted = !frozen;
+    if (accepted) {
+        frozen = true;
+        triggerReason = reason;
+        triggerTime = millis();
+        savePending = true;
+    }
+    portEXIT_CRITICAL(&mux);
+
+    if (accepted) {
+        Serial.printf("[BLACKBOX] %s: сохраняю %.1f с\n", blackBoxReasonName(reason),
+                      count * BLACKBOX_PERIOD_MS / 1000.0);
+    }
+}
+
+void BlackBox::service() {
+    if (!savePending) return;
+
+    if (!save()) {
+        Serial.println("✗ BlackBox: ошибка записи файла");
+    }
+
+    // Запись заново с пустого буфера
+    portENTER_CRITICAL(&mux);
+    head = 0;
+    count = 0;
+    savePending = false;
+    frozen = false;
+    portEXIT_CRITICAL(&mux);
+}
+
+bool BlackBox::save() {
+    char name[32];
+    fileName(nextIndex, name, sizeof(name));
+
+    File file = LittleFS.open(name, FILE_WRITE);
+    if (!file) return false;
+
+    BlackBoxHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = BLACKBOX_MAGIC;
+    header.version = BLACKBOX_VERSION;
+    header.recordSize = sizeof(BlackBoxRecord);
+    header.recordCount = count;
+    header.triggerTimeMs = triggerTime;
+    header.periodUs = BLACKBOX_PERIOD_MS * 1000UL;
+    header.reason = triggerReason;
+
+    // Записи от старых к новым: хвост кольца, затем начало
+    uint16_t start = (head + BLACKBOX_RECORDS - count) % BLACKBOX_RECORDS;
+    uint16_t firstPart = count;
+    if (start + firstPart > BLACKBOX_RECORDS) firstPart = BLACKBOX_RECORDS - start;
+
+    size_t written = file.write((const uint8_t*)&header, sizeof(header));
+    written += file.write((const uint8_t*)&records[start], firstPart * sizeof(BlackBoxRecord));
+    written += file.write((const uint8_t*)&records[0], (count - firstPart) * sizeof(BlackBoxRecord));
+    file.close();
+
+    if (written != sizeof(header) + count * sizeof(BlackBoxRecord)) {
+        LittleFS.remove(name);
+        return false;
+    }
+
+    Serial.printf("[BLACKBOX] Сохранено: %s (%u записей)\n", name, count);
+
+    // Старые записи по кругу
+    if (nextIndex >= BLACKBOX_MAX_FILES) {
+        fileName(nextIndex - BLACKBOX_MAX_FILES, name, sizeof(name));
+        if (LittleFS.exists(name)) LittleFS.remove(name);
+    }
+    nextIndex++;
+    return true;
+}
+
+void BlackBox::list() {
+    if (!mounted) {
+        Serial.println("✗ BlackBox: LittleFS не смонтирована");
+        return;
+    }
+
+    Serial.println("[BLACKBOX] Записи:");
+    int found = 0;
+    uint32_t first = nextIndex > BLACKBOX_MAX_FILES ? nextIndex - BLACKBOX_MAX_FILES : 0;
+    for (uint32_t index = first; index < nextIndex; index++) {
+        char name[32];
+        fileName(index, name, sizeof(name));
+        File file = LittleFS.open(name, FILE_READ);
+        if (!file) continue;
+
+        BlackBoxHeader header;
+        if (file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+            header.magic == BLACKBOX_MAGIC) {
+            Serial.printf("  %lu: %s, %lu записей (%.1f с), t=%lu мс, %u байт\n",
+                          (unsigned long)index, blackBoxReasonName(header.reason),
+                          (unsigned long)header.recordCount,
+                          header.recordCount * header.periodUs / 1000000.0,
+                          (unsigned long)header.triggerTimeMs, (unsigned)file.size());
+            found++;
+        }
+        file.close();
+    }
+    if (found == 0) Serial.println("  (нет)");
+}
+
+void BlackBox::dump(int index) {
+    if (!mounted || nextIndex == 0) {
+        Serial.println("✗ BlackBox: записей нет");
+        return;
+    }
+    if (index < 0) index = nextIndex - 1;
+
+    char name[32];
+    fileName(index, name, sizeof(name));
+    File file = LittleFS.open(name, FILE_READ);
+    if (!file) {
+        Serial.printf("✗ BlackBox: нет записи %d\n", index);
+        return;
+    }
+
+    // Ровно size байт между строками - tools/blackbox находит их в логе порта
+    Serial.printf("[BLACKBOX] BEGIN %d %u\n", index, (unsigned)file.size());
+    uint8_t buffer[256];
+    size_t n;
+    while ((n = file.read(buffer, sizeof(buffer))) > 0) {
+        Serial.write(buffer, n);
+    }
+    file.close();
+    Serial.println("\n[BLACKBOX] END");
+}
@@ -0,0 +1,68 @@
+#ifndef BLACK_BOX_H
+#define BLACK_BOX_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "BlackBoxFormat.h"
+
+// Черный ящик: кольцевой буфер последних секунд управления в RAM.
+// По событию (потеря линии, таймаут поиска, стоп кнопкой) буфер
+// замораживается и сохраняется в LittleFS отдельной задачей.
+//
+// record() и trigger() - из задачи робота, service() - из задачи записи
+// на ядре 0. Пока буфер заморожен, новые записи пропускаются.
+// Политика TelemetrySink для LineFollower (см. TelemetrySink.h).
+class BlackBox {
+private:
+    BlackBoxRecord records[BLACKBOX_RECORDS];
+    uint16_t head;               // Куда писать следующую запись
+    uint16_t count;
+    unsigned long lastRecordTime;
+
+    // Заморозка до окончания сохранения
+    volatile bool frozen;
+    volatile bool savePending;
+    uint8_t triggerReason;
+    uint32_t triggerTime;
+
+    bool mounted;
+    uint32_t nextIndex;          // Номер следующего файла
+
+    static portMUX_TYPE mux;
+
+    static void fileName(uint32_t index, char* buffer, size_t size);
+    bool save();
+
+public:
+    static const bool enabled = true;
+
+    BlackBox();
+
+    // Монтирование LittleFS (форматирует при первом запуске)
+    bool begin();
+
+    // Запись состояния цикла (не чаще BLACKBOX_PERIOD_MS)
+    void record(const BlackBoxRecord& r);
+
+    // Заморозить буфер и поставить в очередь на сохранение.
+    // Повторные события до окончания сохранения игнорируются.
+    void trigger(BlackBoxReason reason);
+    void event(BlackBoxReason reason) { trigger(reason); }
+
+    // Вызывать из задачи записи: сохраняет замороженный буфер
+    void service();
+
+    bool isSaving() const { return savePending; }
+
+    // Список сохраненных записей в Serial
+    void list();
+
+    // Файл записи целиком в Serial (двоичный, между строками BEGIN/END).
+    // index < 0 - последняя запись
+    void dump(int index);
+};
+
+// Имя причины для вывода
+const char* blackBoxReasonName(uint8_t reason);
+
+#endif // BLACK_BOX_H
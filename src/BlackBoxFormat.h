@@ -0,0 +1,64 @@
+#ifndef BLACK_BOX_FORMAT_H
+#define BLACK_BOX_FORMAT_H
+
+#include <stdint.h>
+
+/*
+ * Формат записи черного ящика (файл в LittleFS и дамп в Serial).
+ * Общий для прошивки, tools/blackbox и tools/telemetry - только stdint, little-endian.
+ *
+ *   BlackBoxHeader, затем recordCount × BlackBoxRecord (от старых к новым)
+ */
+
+#define BLACKBOX_MAGIC    0x31584242UL  // "BBX1"
+#define BLACKBOX_VERSION  1
+
+// Позиция, когда линии нет
+#define BLACKBOX_NO_LINE  (-32768)
+
+// Причина сохранения записи
+enum BlackBoxReason {
+    BLACKBOX_LINE_LOST = 0,    // Линия потеряна при следовании
+    BLACKBOX_SEARCH_TIMEOUT,   // Поиск не нашел линию (LOST)
+    BLACKBOX_BUTTON_STOP,      // Остановка кнопкой во время заезда
+    BLACKBOX_REASON_COUNT
+};
+
+#pragma pack(push, 1)
+
+struct BlackBoxHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;      // sizeof(BlackBoxRecord)
+    uint32_t recordCount;
+    uint32_t triggerTimeMs;   // millis() в момент события
+    uint32_t periodUs;        // Шаг записи (BLACKBOX_PERIOD_MS)
+    uint8_t reason;           // BlackBoxReason
+    uint8_t reserved[3];
+};
+
+struct BlackBoxRecord {
+    uint32_t timeUs;          // micros()
+    int16_t position;         // Позиция линии × 1000 (-2000..2000), BLACKBOX_NO_LINE
+    int16_t correction;       // Коррекция ПИД / руления × 10
+    int16_t leftCommand;      // Команда моторам до профиля движения (-255..255)
+    int16_t rightCommand;
+    int16_t leftSpeed;        // Скорость колес по энкодерам, мм/с (0 без энкодеров)
+    int16_t rightSpeed;
+    uint8_t sensorMask;       // Бит i - датчик i на линии
+    uint8_t state;            // RobotState
+    uint8_t flags;            // BLACKBOX_FLAG_*
+    uint8_t reserved;
+};
+
+#pragma pack(pop)
+
+// Флаги записи
+#define BLACKBOX_FLAG_MEMORY   0x01  // Позиция из памяти (линия между датчиками)
+#define BLACKBOX_FLAG_BRAKING  0x02  // Идет торможение slowDown()
+#define BLACKBOX_FLAG_LAUNCH   0x04  // Разгон с места
+
+static_assert(sizeof(BlackBoxHeader) == 24, "BlackBoxHeader: формат файла");
+static_assert(sizeof(BlackBoxRecord) == 20, "BlackBoxRecord: формат файла");
+
+#endif // BLACK_BOX_FORMAT_H
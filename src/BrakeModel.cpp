@@ -0,0 +1,130 @@
+#include "BrakeModel.h"
+
+BrakeModel::BrakeModel() {
+    decel[BRAKE_MODE_COAST] = BRAKE_DECEL_COAST;
+    decel[BRAKE_MODE_BRAKE] = BRAKE_DECEL_BRAKE;
+    decel[BRAKE_MODE_REVERSE] = BRAKE_DECEL_REVERSE;
+    
+    for (int i = 0; i < BRAKE_MODE_COUNT; i++) {
+        deadTime[i] = BRAKE_DEAD_TIME;
+    }
+    clearSamples();
+}
+
+float BrakeModel::distance(BrakeMode mode, float v0, float v) const {
+    if (v0 <= v) return 0.0;
+    if (v < 0.0) v = 0.0;
+    return v0 * deadTime[mode] + (v0 * v0 - v * v) / (2.0 * decel[mode]);
+}
+
+float BrakeModel::time(BrakeMode mode, float v0, float v) const {
+    if (v0 <= v) return 0.0;
+    if (v < 0.0) v = 0.0;
+    return (deadTime[mode] + (v0 - v) / decel[mode]) * 1000.0;
+}
+
+BrakePlan BrakeModel::plan(float v0, float v, float distanceMm) const {
+    BrakePlan result;
+    result.mode = BRAKE_MODE_COAST;
+    result.durationMs = 0;
+    result.pulseMs = 0;
+    result.distanceMm = 0.0;
+    result.feasible = true;
+    
+    if (v0 <= v) return result;
+    
+    // От мягкого к жесткому: первый подходящий режим
+    for (int m = 0; m < BRAKE_MODE_COUNT; m++) {
+        BrakeMode mode = (BrakeMode)m;
+        result.mode = mode;
+        result.distanceMm = distance(mode, v0, v);
+        result.durationMs = (uint16_t)time(mode, v0, v);
+        if (mode == BRAKE_MODE_REVERSE) {
+            planReverse(v0, v, result);
+        }
+        if (result.distanceMm <= distanceMm) break;
+    }
+    
+    result.feasible = result.distanceMm <= distanceMm;
+    return result;
+}
+
+void BrakeModel::planReverse(float v0, float v, BrakePlan& result) const {
+    result.pulseMs = result.durationMs;
+    if (result.pulseMs <= BRAKE_REVERSE_MAX_MS) return;
+    
+    // Импульс короче нужного: реверс до v1, дальше моторы держит
+    // торможение замыканием (Motors::update) - задержки второй раз нет
+    result.pulseMs = BRAKE_REVERSE_MAX_MS;
+    float pulse = BRAKE_REVERSE_MAX_MS / 1000.0 - deadTime[BRAKE_MODE_REVERSE];
+    if (pulse < 0.0) pulse = 0.0;
+    if (v < 0.0) v = 0.0;
+    // Импульс обрезан, значит v1 > v
+    float v1 = v0 - decel[BRAKE_MODE_REVERSE] * pulse;
+    
+    result.distanceMm = distance(BRAKE_MODE_REVERSE, v0, v1) +
+                        (v1 * v1 - v * v) / (2.0 * decel[BRAKE_MODE_BRAKE]);
+    result.durationMs = (uint16_t)(BRAKE_REVERSE_MAX_MS + (v1 - v) / decel[BRAKE_MODE_BRAKE] * 1000.0);
+}
+
+void BrakeModel::addSample(BrakeMode mode, float v0, float distanceMm) {
+    if (v0 <= 0.0 || distanceMm <= 0.0) return;
+    
+    float v2 = v0 * v0;
+    sumV2[mode] += v2;
+    sumV3[mode] += v2 * v0;
+    sumV4[mode] += v2 * v2;
+    sumVD[mode] += v0 * distanceMm;
+    sumV2D[mode] += v2 * distanceMm;
+    samples[mode]++;
+}
+
+void BrakeModel::fit() {
+    for (int m = 0; m < BRAKE_MODE_COUNT; m++) {
+        if (samples[m] == 0) continue;
+        
+        float t0 = deadTime[m];
+        float k = 0.0;
+        bool solved = false;
+        
+        // Нормальные уравнения для (t0, k)
+        float det = sumV2[m] * sumV4[m] - sumV3[m] * sumV3[m];
+        if (samples[m] >= 2 && det > 1e-6 * sumV2[m] * sumV4[m]) {
+            t0 = (sumVD[m] * sumV4[m] - sumV2D[m] * sumV3[m]) / det;
+            k = (sumV2[m] * sumV2D[m] - sumV3[m] * sumVD[m]) / det;
+            solved = t0 >= 0.0 && t0 <= 0.2 && k > 0.0;
+        }
+        
+        // Одна скорость или задержка вне разумных пределов -
+        // оставляем прежнюю задержку и подбираем только k
+        if (!solved) {
+            t0 = deadTime[m];
+            k = (sumV2D[m] - t0 * sumV3[m]) / sumV4[m];
+        }
+        
+        if (k > 0.0) {
+            deadTime[m] = t0;
+            decel[m] = constrain(1.0 / (2.0 * k), 100.0, 20000.0);
+        }
+    }
+}
+
+void BrakeModel::clearSamples() {
+    for (int i = 0; i < BRAKE_MODE_COUNT; i++) {
+        sumV2[i] = 0.0;
+        sumV3[i] = 0.0;
+        sumV4[i] = 0.0;
+        sumVD[i] = 0.0;
+        sumV2D[i] = 0.0;
+        samples[i] = 0;
+    }
+}
+
+const char* brakeModeName(BrakeMode mode) {
+    switch (mode) {
+        case BRAKE_MODE_COAST:   return "выбег";
+        case BRAKE_MODE_BRAKE:   return "торможение";
+        case BRAKE_MODE_REVERSE: return "реверс";
+        default:                 return "?";
+    }
+}
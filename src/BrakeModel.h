@@ -0,0 +1,74 @@
+#ifndef BRAKE_MODEL_H
+#define BRAKE_MODEL_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// Режимы торможения, от мягкого к жесткому
+enum BrakeMode {
+    BRAKE_MODE_COAST = 0,   // Выбег
+    BRAKE_MODE_BRAKE,       // Замыкание обмоток
+    BRAKE_MODE_REVERSE,     // Импульс реверса, затем замыкание
+    BRAKE_MODE_COUNT
+};
+
+// Что делать, чтобы замедлиться до нужной скорости на заданной дистанции
+struct BrakePlan {
+    BrakeMode mode;
+    uint16_t durationMs;   // Сколько держать режим (0 - замедление не нужно)
+    uint16_t pulseMs;      // Длина импульса реверса (BRAKE_MODE_REVERSE), не больше BRAKE_REVERSE_MAX_MS
+    float distanceMm;      // Ожидаемый путь торможения
+    bool feasible;         // false - даже самый жесткий режим не успевает
+};
+
+// Модель тормозного пути для каждого режима:
+//   d = v0 * t0 + (v0² - v²) / (2a)
+// t0 - задержка до начала замедления, a - замедление.
+// Параметры подбираются по остановкам с энкодерами (МНК по нескольким v0).
+class BrakeModel {
+private:
+    float decel[BRAKE_MODE_COUNT];     // мм/с²
+    float deadTime[BRAKE_MODE_COUNT];  // с
+    
+    // Суммы для МНК: d = t0 * v0 + k * v0², k = 1/(2a)
+    float sumV2[BRAKE_MODE_COUNT];
+    float sumV3[BRAKE_MODE_COUNT];
+    float sumV4[BRAKE_MODE_COUNT];
+    float sumVD[BRAKE_MODE_COUNT];
+    float sumV2D[BRAKE_MODE_COUNT];
+    int samples[BRAKE_MODE_COUNT];
+    
+    // Реверс с импульсом, обрезанным до BRAKE_REVERSE_MAX_MS:
+    // путь и время - импульс, затем торможение замыканием
+    void planReverse(float v0, float v, BrakePlan& result) const;
+    
+public:
+    BrakeModel();
+    
+    // Путь (мм) от скорости v0 до v (мм/с) в режиме mode
+    float distance(BrakeMode mode, float v0, float v) const;
+    
+    // Время (мс) от скорости v0 до v в режиме mode
+    float time(BrakeMode mode, float v0, float v) const;
+    
+    // Самый мягкий режим, который замедляет от v0 до v за distanceMm
+    BrakePlan plan(float v0, float v, float distanceMm) const;
+    
+    // Калибровка: остановка с v0 (мм/с) заняла distanceMm
+    void addSample(BrakeMode mode, float v0, float distanceMm);
+    
+    // Пересчитать параметры по накопленным остановкам
+    void fit();
+    
+    // Сбросить накопленные остановки (параметры остаются)
+    void clearSamples();
+    
+    float getDecel(BrakeMode mode) const { return decel[mode]; }
+    float getDeadTime(BrakeMode mode) const { return deadTime[mode]; }
+    int getSampleCount(BrakeMode mode) const { return samples[mode]; }
+};
+
+// Название режима для вывода
+const char* brakeModeName(BrakeMode mode);
+
+#endif // BRAKE_MODEL_H
@@ -0,0 +1,107 @@
+#include "CameraLineSource.h"
+
+CameraLineSource::CameraLineSource(HardwareSerial& port)
+    : serial(port), latestRxTime(0), haveFrame(false),
+      lastKnownPosition(-999), lastPositionTime(0) {
+    memset(&latest, 0, sizeof(latest));
+}
+
+void CameraLineSource::begin() {
+    // Буфер на ~20 кадров, чтобы не терять данные между вызовами poll()
+    serial.setRxBufferSize(512);
+    serial.begin(CAMERA_LINK_BAUD, SERIAL_8N1, CAMERA_LINK_RX, CAMERA_LINK_TX);
+    Serial.printf("[OK] Связь с камерой: UART RX=GPIO%d @ %d бод\n", CAMERA_LINK_RX, CAMERA_LINK_BAUD);
+}
+
+void CameraLineSource::poll() {
+    uint8_t chunk[64];
+    int available = serial.available();
+    
+    while (available > 0) {
+        int count = serial.read(chunk, available < (int)sizeof(chunk) ? available : sizeof(chunk));
+        if (count <= 0) break;
+        
+        for (int i = 0; i < count; i++) {
+            if (parser.feed(chunk[i])) {
+                latest = parser.getState();
+                latestRxTime = micros();
+                haveFrame = true;
+            }
+        }
+        available -= count;
+    }
+}
+
+bool CameraLineSource::hasFreshFrame() const {
+    return haveFrame && (micros() - latestRxTime) < (unsigned long)CAMERA_LINK_TIMEOUT * 1000UL;
+}
+
+bool CameraLineSource::lineValid() const {
+    return hasFreshFrame() &&
+           (latest.flags & LINE_LINK_FLAG_DETECTED) &&
+           latest.confidence >= CAMERA_MIN_CONFIDENCE;
+}
+
+float CameraLineSource::lateralAtSensors() const {
+    /*
+     * Камера сообщает положение на ближайшей видимой дистанции refForwardMm.
+     * Переносим его на линию датчиков (SENSOR_OFFSET), чтобы коэффициенты ПИД
+     * остались совместимы с массивом TCRT5000: x(t) = x0 + t*tg(курс) + k*t²/2
+     */
+    float t = SENSOR_OFFSET - latest.refForwardMm;
+    float slope = tanf(latest.headingRad);
+    float curvatureMm = latest.curvature / 1000.0f;
+    return latest.positionMm + t * slope + 0.5f * curvatureMm * t * t;
+}
+
+void CameraLineSource::read(int sensors[5]) {
+    poll();
+    
+    // По умолчанию все датчики видят белое поле
+    for (int i = 0; i < 5; i++) {
+        sensors[i] = 1;
+    }
+    
+    if (!lineValid()) {
+        return;
+    }
+    
+    float lateral = lateralAtSensors();
+    for (int i = 0; i < 5; i++) {
+        float sensorX = (i - 2) * SENSOR_SPACING;
+        if (fabsf(sensorX - lateral) <= LINE_WIDTH_MM / 2) {
+            sensors[i] = 0;  // Линия под датчиком
+        }
+    }
+}
+
+float CameraLineSource::calculatePosition(int sensors[5]) {
+    // Виртуальные датчики нужны только для отладки - позиция берется
+    // напрямую из непрерывной оценки камеры
+    (void)sensors;
+    
+    if (!lineValid()) {
+        return -999;
+    }
+    
+    float position = constrain(lateralAtSensors() / SENSOR_SPACING, -2.0f, 2.0f);
+    
+    lastKnownPosition = position;
+    lastPositionTime = millis();
+    
+    return position;
+}
+
+void CameraLineSource::calibrate() {
+    Serial.println("Камера калибруется на стороне ESP32-CAM (пресеты /control)");
+    Serial.printf("Связь: кадров=%lu, ошибок CRC=%lu, потеряно=%lu, перезапусков=%lu\n",
+                  (unsigned long)parser.getFramesOk(),
+                  (unsigned long)parser.getCrcErrors(),
+                  (unsigned long)parser.getFramesLost(),
+                  (unsigned long)parser.getResyncs());
+}
+
+void CameraLineSource::resetPositionMemory() {
+    lastKnownPosition = -999;
+    lastPositionTime = 0;
+}
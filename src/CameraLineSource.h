@@ -0,0 +1,67 @@
+#ifndef CAMERA_LINE_SOURCE_H
+#define CAMERA_LINE_SOURCE_H
+
+#include <Arduino.h>
+#include <LineLink.h>
+#include "Config.h"
+#include "LineSource.h"
+
+// Источник позиции линии от ESP32-CAM (протокол LineLink по UART)
+// Совместим с LineSensors: позиция в тех же единицах (-2.0 ... +2.0, шаг датчика)
+class CameraLineSource final : public LineSource {
+private:
+    HardwareSerial& serial;
+    LineLinkParser parser;
+    
+    LineLinkState latest;         // Последний принятый кадр
+    unsigned long latestRxTime;   // micros() приема последнего кадра
+    bool haveFrame;
+    
+    float lastKnownPosition;
+    unsigned long lastPositionTime;
+    
+    // Боковое смещение линии (мм) на линии датчиков TCRT5000
+    float lateralAtSensors() const;
+    
+public:
+    // Все буферы - в объекте
+    static const uint32_t staticBytes = 0;
+    
+    CameraLineSource(HardwareSerial& port = Serial2);
+    
+    // Инициализация UART
+    void begin() override;
+    
+    // Прием байтов из UART (вызывается автоматически в read())
+    void poll();
+    
+    // Виртуальные датчики: линия шириной 20 мм под 5 точками с шагом 15 мм
+    void read(int sensors[5]) override;
+    
+    // Позиция линии (-2.0 до +2.0, или -999 если не найдена)
+    float calculatePosition(int sensors[5]) override;
+    
+    // Камера калибруется на своей стороне - выводим статистику связи
+    void calibrate() override;
+    
+    float getLastKnownPosition() const override { return lastKnownPosition; }
+    unsigned long getLastPositionTime() const override { return lastPositionTime; }
+    void resetPositionMemory() override;
+    
+    // Полное состояние линии от камеры (курс, кривизна, метки времени)
+    const LineLinkState& getLineState() const { return latest; }
+    
+    // Время приема последнего кадра (micros)
+    unsigned long getRxTime() const { return latestRxTime; }
+    
+    // Есть ли свежий кадр
+    bool hasFreshFrame() const;
+    
+    // Кадр свежий, линия видна и камера уверена
+    bool lineValid() const;
+    
+    // Статистика связи
+    const LineLinkParser& getParser() const { return parser; }
+};
+
+#endif // CAMERA_LINE_SOURCE_H
@@ -11,6 +11,42 @@
 // Режим отладки - выводит подробную информацию в Serial
 #define DEBUG_MODE
 
+// То же как константа 0/1 - для if (DEBUG_OUTPUT) вместо #ifdef
+#ifdef DEBUG_MODE
+#define DEBUG_OUTPUT 1
+#else
+#define DEBUG_OUTPUT 0
+#endif
+
+// Фронты датчиков TCRT5000 по прерываниям с метками времени (микросекунды):
+// короткие касания линии не теряются, позиция интерполируется между датчиками
+#define USE_SENSOR_EDGES
+
+// Раскомментируйте для получения позиции линии от ESP32-CAM по UART
+// вместо массива TCRT5000
+// #define USE_CAMERA_LINK
+
+// Раскомментируйте, если установлены и камера, и TCRT5000: камера видит
+// поворот заранее (курс, кривизна), датчики дают точное смещение у колес.
+// Кадр камеры переносится в настоящее по одометрии энкодеров. Раздел СЛИЯНИЕ
+// #define USE_LINE_FUSION
+
+// Раскомментируйте, если установлен делитель напряжения батареи на BATTERY_PIN
+// (компенсация ШИМ по напряжению и остановка при разряде)
+// #define USE_BATTERY_MONITOR
+
+// Раскомментируйте для замера времени этапов цикла управления по тактам CCOUNT
+// (команда 'p'). Выключенный профайлер не добавляет в прошивку ни одной инструкции
+// #define USE_PROFILER
+
+// Черный ящик: последние секунды управления в RAM, сохраняются в LittleFS
+// при потере линии, таймауте поиска и остановке кнопкой (команды 'l', 'd')
+#define USE_BLACKBOX
+
+// Раскомментируйте для телеметрии по WiFi (UDP на ядре 0, приемник в
+// tools/telemetry). Сеть и адрес - в разделе ТЕЛЕМЕТРИЯ
+// #define USE_TELEMETRY
+
 // ═══════════════════════════════════════════════════════════════════════════
 // ПИНЫ ПОДКЛЮЧЕНИЯ
 // ═══════════════════════════════════════════════════════════════════════════
@@ -35,6 +71,13 @@
 // Кнопка старт/стоп
 #define BUTTON_PIN     4   // Пин кнопки запуска/остановки (подключен к GND)
 
+// Напряжение батареи (опционально): делитель 100 кОм / 47 кОм, вход АЦП1
+#define BATTERY_PIN    34
+
+// UART связь с ESP32-CAM (опционально, протокол LineLink)
+#define CAMERA_LINK_RX  18  // RX ← TX камеры (GPIO14 ESP32-CAM)
+#define CAMERA_LINK_TX  19  // TX → RX камеры (не используется)
+
 // ═══════════════════════════════════════════════════════════════════════════
 // ПАРАМЕТРЫ РОБОТА
 // ═══════════════════════════════════════════════════════════════════════════
@@ -43,11 +86,18 @@
 #define WHEEL_DIAMETER      65.0    // Диаметр колеса в мм
 #define WHEEL_BASE          125.0   // Расстояние между колесами в мм
 #define ENCODER_SLOTS       20      // Количество прорезей в диске FC-03
+#define SENSOR_SPACING      15.0    // Расстояние между датчиками в мм
+#define SENSOR_OFFSET       35.0    // Датчики впереди оси колес в мм
+#define LINE_WIDTH_MM       20.0    // Ширина линии в мм
 
 // Вычисляемые константы
 #define WHEEL_CIRCUMFERENCE (PI * WHEEL_DIAMETER)
 #define MM_PER_TICK         (WHEEL_CIRCUMFERENCE / ENCODER_SLOTS)
 
+// Скорость колеса по периоду фронтов энкодера
+#define ENCODER_SPEED_EDGES 2       // Усреднять столько периодов (неровность прорезей ~5%)
+#define ENCODER_STOP_MS     250     // Нет фронтов дольше - колесо стоит (< ~40 мм/с)
+
 // ═══════════════════════════════════════════════════════════════════════════
 // ПАРАМЕТРЫ СКОРОСТИ
 // ═══════════════════════════════════════════════════════════════════════════
@@ -57,6 +107,93 @@
 #define MIN_SPEED      60   // Минимальная скорость
 #define TURN_SPEED     100  // Скорость при поиске линии
 
+// ═══════════════════════════════════════════════════════════════════════════
+// ШИМ МОТОРОВ (LEDC)
+// ═══════════════════════════════════════════════════════════════════════════
+
+// 20 кГц - выше слышимого диапазона. Разрешение ограничено тактовой APB 80 МГц:
+// 80 МГц / 20 кГц = 4000 отсчетов, т.е. не больше 11 бит
+#define MOTOR_PWM_FREQ     20000
+#define MOTOR_PWM_BITS     11
+#define MOTOR_PWM_CHANNEL  0     // Каналы LEDC 0-3 (IN1..IN4)
+
+// Калибровка мотора: ШИМ в % от максимума, нужный для 0%, 12.5%, ... 100%
+// скорости (9 точек). Первая точка - мертвая зона (колесо начинает вращаться),
+// остальные выравнивают нелинейность. Снимается по энкодерам.
+#define MOTOR_CURVE_POINTS 9
+#define MOTOR_LEFT_CURVE   {22, 31, 40, 49, 58, 67, 77, 88, 100}
+#define MOTOR_RIGHT_CURVE  {24, 33, 41, 50, 59, 68, 78, 88, 100}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// ПРОФИЛЬ ДВИЖЕНИЯ (единицы команды 0-255)
+// ═══════════════════════════════════════════════════════════════════════════
+
+#define MOTION_ACCEL          1500.0  // Рост команды колеса, ед/с (0 → BASE_SPEED за ~90 мс)
+#define MOTION_DECEL          3000.0  // Спад команды колеса, ед/с
+#define MOTION_JERK           60000.0 // Изменение ускорения, ед/с²
+
+// Разгон с места: средняя команда растет с темпом, подобранным по проскальзыванию
+#define LAUNCH_RATE_START     800.0   // Начальный темп, ед/с
+#define LAUNCH_RATE_MIN       300.0
+#define LAUNCH_RATE_MAX       1500.0  // Не быстрее MOTION_ACCEL
+#define LAUNCH_RATE_GROWTH    1.1     // Старт без проскальзывания - темп x1.1
+// Скорость колеса - по периоду фронтов (ENCODER_SPEED_EDGES): при неровности
+// прорезей ~5% шум ~30 мм/с и ~2000 мм/с² между соседними фронтами на BASE_SPEED
+#define LAUNCH_SLIP_ACCEL     8000.0  // Ускорение колеса выше сцепления (~0.6 g) и шума, мм/с²
+#define LAUNCH_SLIP_DIFF      100.0   // Разница скоростей колес при старте, мм/с
+#define LAUNCH_SLIP_BACKOFF   0.8     // При проскальзывании команда и темп x0.8
+#define LAUNCH_MAX_MS         800     // Разгон дольше - завершить принудительно
+
+// ═══════════════════════════════════════════════════════════════════════════
+// БАТАРЕЯ (Li-Po 2S)
+// ═══════════════════════════════════════════════════════════════════════════
+
+#define BATTERY_DIVIDER       3.128   // (R1 + R2) / R2 = (100 + 47) / 47
+#define BATTERY_CELLS         2
+#define BATTERY_NOMINAL_V     7.6     // Напряжение, при котором настроены ПИД и MOTOR_*_CURVE
+#define BATTERY_LOW_V         6.8     // 3.4 В/банка - предупреждение
+#define BATTERY_CRITICAL_V    6.4     // 3.2 В/банка - остановка
+#define BATTERY_CRITICAL_MS   2000    // Столько мс ниже критического - остановка (просадки под нагрузкой короче)
+#define BATTERY_ABSENT_V      3.0     // Ниже - питание от USB, компенсация отключена
+#define BATTERY_SAMPLE_MS     20      // Период опроса АЦП (отдельная задача на ядре 0)
+#define BATTERY_FILTER_ALPHA  0.05    // ФНЧ первого порядка, постоянная ~0.4 с
+#define BATTERY_MAX_SCALE     1.25    // Предел компенсации ШИМ
+
+// ═══════════════════════════════════════════════════════════════════════════
+// ТОРМОЖЕНИЕ
+// ═══════════════════════════════════════════════════════════════════════════
+
+// Модель до калибровки (команда 'b'): замедление в мм/с² и задержка в с
+#define BRAKE_DECEL_COAST     600.0   // Выбег (все INx в 0)
+#define BRAKE_DECEL_BRAKE     2500.0  // Торможение замыканием (оба INx в 1)
+#define BRAKE_DECEL_REVERSE   4500.0  // Импульс реверса, затем торможение
+#define BRAKE_DEAD_TIME       0.02    // Задержка до начала замедления
+#define BRAKE_REVERSE_MAX_MS  150     // Максимальная длина импульса реверса
+
+#define BRAKE_ON_LINE_LOSS_MM 40.0    // Остановиться за столько мм при потере линии (с энкодерами)
+
+// Калибровка: разгон по линии, затем каждый режим с каждой скоростью
+#define BRAKE_TEST_RUN_MS     1500    // Время разгона перед торможением
+#define BRAKE_TEST_SPEEDS     {BASE_SPEED, MAX_SPEED}
+#define BRAKE_TEST_STILL_MS   300     // Нет тиков столько мс - робот остановился
+#define BRAKE_TEST_TIMEOUT_MS 3000
+
+// ═══════════════════════════════════════════════════════════════════════════
+// ИДЕНТИФИКАЦИЯ МОТОРОВ (команда 'i', колеса подняты)
+// ═══════════════════════════════════════════════════════════════════════════
+
+#define SYSID_STEP_LEVELS      {0.15, 0.3, 0.45, 0.6, 0.8, 1.0}  // Ступеньки команды (0..1)
+#define SYSID_MAX_STEPS        8
+#define SYSID_STEP_MS          1500    // Длительность ступеньки
+#define SYSID_SETTLE_MS        400     // Нет фронтов столько мс - колесо стоит
+#define SYSID_SETTLE_TIMEOUT_MS 3000
+#define SYSID_CHIRP_CENTER     0.6     // Чирп: команда = центр ± амплитуда
+#define SYSID_CHIRP_AMPLITUDE  0.25
+#define SYSID_CHIRP_F0         0.5     // Частота в начале, Гц
+#define SYSID_CHIRP_F1         8.0     // Частота в конце, Гц
+#define SYSID_CHIRP_MS         6000
+#define SYSID_LOG_SIZE         1024    // Фронтов на колесо за фазу (чирп 6 с при ~1 м/с - ~600)
+
 // ═══════════════════════════════════════════════════════════════════════════
 // ПАРАМЕТРЫ ПИД
 // ═══════════════════════════════════════════════════════════════════════════
@@ -65,17 +202,87 @@
 #define DEFAULT_KI     0.0   // Интегральный коэффициент
 #define DEFAULT_KD     15.0  // Дифференциальный коэффициент
 
-// Параметры ПИД для скорости (с энкодерами)
+// Параметры ПИД для скорости (с энкодерами); расчет по модели мотора - команда 'i'
 #define SPEED_KP       2.0
 #define SPEED_KI       0.5
 #define SPEED_KD       0.1
 
+// ═══════════════════════════════════════════════════════════════════════════
+// РУЛЕВОЕ УПРАВЛЕНИЕ
+// ═══════════════════════════════════════════════════════════════════════════
+
+// STEERING_PID, STEERING_PURE_PURSUIT или STEERING_STANLEY (переключение - команда 'm')
+#define STEERING_DEFAULT_MODE    STEERING_PID
+
+#define STEER_PP_GAIN            0.5     // Множитель кривизны pure pursuit (<1 - как более дальняя точка)
+#define STEER_STANLEY_K          4.0     // Stanley: усиление по смещению, 1/с
+#define STEER_STANLEY_SOFT       100.0   // Stanley: добавка к скорости, мм/с (мягкость на малой скорости)
+#define STEER_HEADING_ALPHA      0.3     // Фильтр оценки курса (0..1)
+#define STEER_MAX_LATERAL_ACCEL  3000.0  // Боковое ускорение, выше - сбросить скорость, мм/с²
+#define STEER_SPEED_PER_COMMAND  6.0     // Без энкодеров: мм/с на единицу команды (оценка)
+
+// ═══════════════════════════════════════════════════════════════════════════
+// СЛИЯНИЕ КАМЕРЫ И ДАТЧИКОВ (USE_LINE_FUSION)
+// ═══════════════════════════════════════════════════════════════════════════
+
+#define FUSION_LINK_DELAY_US    800     // Передача кадра по UART и ожидание poll() (мкс)
+#define FUSION_ODOMETRY_US      4000    // Шаг истории одометрии (мкс); 64 шага - 256 мс
+#define FUSION_BIAS_ALPHA       0.05    // Фильтр расхождения камеры и датчиков (0..1)
+#define FUSION_MAX_BIAS         15.0    // Скачок расхождения больше (мм) - кадр камеры не берется
+#define FUSION_BIAS_RESEED      10      // Столько кадров подряд со скачком - расхождение заново
+#define FUSION_PREVIEW_DECEL    1500.0  // Замедление перед поворотом, мм/с² (мягче BRAKE_DECEL_BRAKE)
+#define FUSION_PREVIEW_MARGIN   30.0    // Скорость поворота набрать за столько мм до него
+
+// ═══════════════════════════════════════════════════════════════════════════
+// ЧЕРНЫЙ ЯЩИК
+// ═══════════════════════════════════════════════════════════════════════════
+
+#define BLACKBOX_RECORDS    1500  // Записей в кольце (20 байт каждая, ~30 КБ RAM)
+#define BLACKBOX_PERIOD_MS  2     // Шаг записи (мс): 1500 × 2 мс = 3 с до события
+#define BLACKBOX_MAX_FILES  10    // Сколько последних записей хранить во flash
+
+// ═══════════════════════════════════════════════════════════════════════════
+// ТЕЛЕМЕТРИЯ
+// ═══════════════════════════════════════════════════════════════════════════
+
+#define TELEMETRY_WIFI_SSID      "robot-net"
+#define TELEMETRY_WIFI_PASSWORD  "robot-net-pass"
+#define TELEMETRY_HOST           "255.255.255.255"  // Адрес приемника (broadcast - любой в сети)
+#define TELEMETRY_PORT           4210
+#define TELEMETRY_RATE_HZ        100   // Записей в секунду (прореживание цикла управления)
+#define TELEMETRY_SEND_MS        50    // Отправить неполную пачку не позже чем через (мс)
+#define TELEMETRY_BATCH          32    // Записей в датаграмме (не больше TELEMETRY_MAX_BATCH)
+#define TELEMETRY_QUEUE          128   // Очередь задача робота → задача телеметрии (степень двойки)
+
+// ═══════════════════════════════════════════════════════════════════════════
+// ПАМЯТЬ И ЗАДАЧИ
+// ═══════════════════════════════════════════════════════════════════════════
+
+// Стеки задач (байты), выделяются статически. Подбирать по отчету 'r':
+// запас после всех режимов (калибровки, идентификация, сохранение ящика)
+#define ROBOT_TASK_STACK      10000
+#define BATTERY_TASK_STACK    2048
+#define BLACKBOX_TASK_STACK   4096   // LittleFS
+#define TELEMETRY_TASK_STACK  4096   // WiFi / UDP
+#define STACK_WARN_FREE       512    // Запас стека меньше этого - отметка в отчете
+
+// Предел статических объектов прошивки (буферы + стеки), проверяется при сборке
+#define STATIC_RAM_BUDGET     (96 * 1024)
+
 // ═══════════════════════════════════════════════════════════════════════════
 // ПРОЧИЕ ПАРАМЕТРЫ
 // ═══════════════════════════════════════════════════════════════════════════
 
 #define SEARCH_TIMEOUT     2000  // Таймаут поиска линии (мс)
 #define LINE_MEMORY_TIMEOUT  150  // Время памяти последней позиции линии (мс)
+#define SENSOR_EDGE_EXTRAPOLATE_MS 1000  // Фронты реже этого (мс) - скорость линии не оценивается
+#define SENSOR_EDGE_MAX_RATE 2000.0     // Предел скорости смещения линии поперек робота (мм/с)
+#define SENSOR_EDGE_MIN_US   50         // Фронты одного датчика чаще - дребезг компаратора (мкс)
 #define BUTTON_DEBOUNCE_MS 150    // Время антидребезга кнопки (мс)
 
+// Связь с камерой
+#define CAMERA_LINK_BAUD     921600  // Скорость UART (LINE_LINK_DEFAULT_BAUD)
+#define CAMERA_LINK_TIMEOUT  100     // Кадр старше этого считается потерянным (мс)
+#define CAMERA_MIN_CONFIDENCE 30     // Минимальная уверенность камеры (0-100)
+
 #endif // CONFIG_H
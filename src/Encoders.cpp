@@ -4,54 +4,87 @@
 volatile long Encoders::leftTicks = 0;
 volatile long Encoders::rightTicks = 0;
 portMUX_TYPE Encoders::timerMux = portMUX_INITIALIZER_UNLOCKED;
+volatile uint32_t Encoders::edgeTimes[2][ENCODER_EDGE_BUFFER];
+volatile uint32_t Encoders::edgeHead[2] = {0, 0};
 
-Encoders::Encoders() : lastUpdateTime(0), leftSpeed(0.0), rightSpeed(0.0) {
+#define EDGE_MASK (ENCODER_EDGE_BUFFER - 1)
+static_assert((ENCODER_EDGE_BUFFER & EDGE_MASK) == 0, "ENCODER_EDGE_BUFFER - степень двойки");
+
+// Индексы колес как у Motors (MOTOR_SIDE_LEFT / MOTOR_SIDE_RIGHT)
+#define EDGE_LEFT   0
+#define EDGE_RIGHT  1
+
+Encoders::Encoders()
+    : totalLeftTicks(0), totalRightTicks(0) {
+    edgeTail[EDGE_LEFT] = 0;
+    edgeTail[EDGE_RIGHT] = 0;
 }
 
 void Encoders::begin() {
-#ifdef USE_ENCODERS
     pinMode(ENCODER_LEFT, INPUT);
     pinMode(ENCODER_RIGHT, INPUT);
     
     // ESP32 поддерживает прерывания на всех GPIO
     attachInterrupt(ENCODER_LEFT, leftISR, RISING);
     attachInterrupt(ENCODER_RIGHT, rightISR, RISING);
-#endif
 }
 
 void Encoders::update() {
-    unsigned long currentTime = millis();
+    // Безопасное чтение volatile переменных
+    long leftTicksLocal, rightTicksLocal;
+    portENTER_CRITICAL(&timerMux);
+    leftTicksLocal = leftTicks;
+    rightTicksLocal = rightTicks;
+    leftTicks = 0;
+    rightTicks = 0;
+    portEXIT_CRITICAL(&timerMux);
     
-    if (currentTime - lastUpdateTime >= 100) {  // Обновление каждые 100мс
-        unsigned long deltaTime = currentTime - lastUpdateTime;
-        
-        // Безопасное чтение volatile переменных
-        long leftTicksLocal, rightTicksLocal;
-        portENTER_CRITICAL(&timerMux);
-        leftTicksLocal = leftTicks;
-        rightTicksLocal = rightTicks;
-        leftTicks = 0;
-        rightTicks = 0;
-        portEXIT_CRITICAL(&timerMux);
-        
-        // Вычисляем пройденное расстояние
-        float leftDistance = leftTicksLocal * MM_PER_TICK;
-        float rightDistance = rightTicksLocal * MM_PER_TICK;
-        
-        // Вычисляем скорости (мм/сек)
-        leftSpeed = (leftDistance / deltaTime) * 1000.0;
-        rightSpeed = (rightDistance / deltaTime) * 1000.0;
-        
-        lastUpdateTime = currentTime;
-    }
+    totalLeftTicks += leftTicksLocal;
+    totalRightTicks += rightTicksLocal;
+}
+
+float Encoders::edgeSpeed(int side) const {
+    portENTER_CRITICAL(&timerMux);
+    uint32_t head = edgeHead[side];
+    uint32_t last = edgeTimes[side][(head - 1) & EDGE_MASK];
+    uint32_t first = edgeTimes[side][(head - 1 - ENCODER_SPEED_EDGES) & EDGE_MASK];
+    portEXIT_CRITICAL(&timerMux);
+    
+    if (head <= ENCODER_SPEED_EDGES) return 0.0;
+    
+    uint32_t since = micros() - last;
+    uint32_t span = last - first;
+    if (since > ENCODER_STOP_MS * 1000UL || span == 0) return 0.0;
+    
+    /*
+     * Тик - MM_PER_TICK (~10 мм), окно в 100 мс давало ступени ~100 мм/с.
+     * Период фронтов меряется в микросекундах: ошибку дает только
+     * неровность прорезей, ее сглаживают ENCODER_SPEED_EDGES периодов
+     */
+    float speed = ENCODER_SPEED_EDGES * MM_PER_TICK * 1000000.0 / span;
+    
+    // Фронта нет дольше периода - колесо замедляется, быстрее оно не едет
+    float bound = since > 0 ? MM_PER_TICK * 1000000.0 / since : speed;
+    return speed < bound ? speed : bound;
 }
 
 float Encoders::getLeftSpeed() const {
-    return leftSpeed;
+    return edgeSpeed(EDGE_LEFT);
 }
 
 float Encoders::getRightSpeed() const {
-    return rightSpeed;
+    return edgeSpeed(EDGE_RIGHT);
+}
+
+uint32_t Encoders::getEdgeTime(int side) const {
+    if (side != EDGE_LEFT && side != EDGE_RIGHT) return 0;
+    
+    portENTER_CRITICAL(&timerMux);
+    uint32_t head = edgeHead[side];
+    uint32_t time = edgeTimes[side][(head - 1) & EDGE_MASK];
+    portEXIT_CRITICAL(&timerMux);
+    
+    return head > 0 ? time : 0;
 }
 
 long Encoders::getLeftTicks() {
@@ -75,10 +108,65 @@ void Encoders::resetTicks() {
     portEXIT_CRITICAL(&timerMux);
 }
 
+float Encoders::getDistance() {
+    // Накопленные тики плюс еще не обработанные в update()
+    portENTER_CRITICAL(&timerMux);
+    long pending = leftTicks + rightTicks;
+    portEXIT_CRITICAL(&timerMux);
+    
+    return (totalLeftTicks + totalRightTicks + pending) * MM_PER_TICK / 2.0;
+}
+
+float Encoders::getLeftDistance() {
+    portENTER_CRITICAL(&timerMux);
+    long pending = leftTicks;
+    portEXIT_CRITICAL(&timerMux);
+    
+    return (totalLeftTicks + pending) * MM_PER_TICK;
+}
+
+float Encoders::getRightDistance() {
+    portENTER_CRITICAL(&timerMux);
+    long pending = rightTicks;
+    portEXIT_CRITICAL(&timerMux);
+    
+    return (totalRightTicks + pending) * MM_PER_TICK;
+}
+
+int Encoders::readEdges(int side, uint32_t* times, int maxCount) {
+    if (side != EDGE_LEFT && side != EDGE_RIGHT) return 0;
+    
+    uint32_t head = edgeHead[side];
+    uint32_t tail = edgeTail[side];
+    
+    // Писатель обогнал на целый буфер - берем только последние метки
+    if (head - tail > ENCODER_EDGE_BUFFER) {
+        tail = head - ENCODER_EDGE_BUFFER;
+    }
+    
+    int count = 0;
+    while (tail != head && count < maxCount) {
+        times[count++] = edgeTimes[side][tail & EDGE_MASK];
+        tail++;
+    }
+    edgeTail[side] = tail;
+    return count;
+}
+
+void Encoders::clearEdges() {
+    edgeTail[EDGE_LEFT] = edgeHead[EDGE_LEFT];
+    edgeTail[EDGE_RIGHT] = edgeHead[EDGE_RIGHT];
+}
+
 void IRAM_ATTR Encoders::leftISR() {
     leftTicks++;
+    // Один писатель на буфер: метка, затем сдвиг головы
+    edgeTimes[EDGE_LEFT][edgeHead[EDGE_LEFT] & EDGE_MASK] = micros();
+    edgeHead[EDGE_LEFT] = edgeHead[EDGE_LEFT] + 1;
 }
 
 void IRAM_ATTR Encoders::rightISR() {
     rightTicks++;
+    edgeTimes[EDGE_RIGHT][edgeHead[EDGE_RIGHT] & EDGE_MASK] = micros();
+    edgeHead[EDGE_RIGHT] = edgeHead[EDGE_RIGHT] + 1;
 }
@@ -4,40 +4,96 @@
 #include <Arduino.h>
 #include "Config.h"
 
+// Кольцевой буфер меток времени фронтов (степень двойки)
+#define ENCODER_EDGE_BUFFER  256
+
 // Класс для работы с энкодерами
+// (политика VelocityEstimator для LineFollower)
 class Encoders {
 private:
     static volatile long leftTicks;
     static volatile long rightTicks;
     static portMUX_TYPE timerMux;
     
-    unsigned long lastUpdateTime;
-    float leftSpeed;   // мм/сек
-    float rightSpeed;  // мм/сек
+    // Метки времени фронтов (micros) для идентификации моторов
+    static volatile uint32_t edgeTimes[2][ENCODER_EDGE_BUFFER];
+    static volatile uint32_t edgeHead[2];
+    uint32_t edgeTail[2];
+    
+    // Тики с момента старта (накапливаются в update)
+    long totalLeftTicks;
+    long totalRightTicks;
     
     // ISR функции должны быть static
     static void IRAM_ATTR leftISR();
     static void IRAM_ATTR rightISR();
     
+    // Скорость колеса по периоду последних ENCODER_SPEED_EDGES фронтов
+    float edgeSpeed(int side) const;
+    
 public:
+    // Скорость и путь измеряются
+    static const bool available = true;
+    
+    // Статические буферы прерываний (не входят в sizeof объекта)
+    static const uint32_t staticBytes = sizeof(edgeTimes) + sizeof(edgeHead);
+    
     Encoders();
     
     // Инициализация энкодеров
     void begin();
     
-    // Обновление скоростей
+    // Перенос тиков из прерываний в счетчики пути
     void update();
     
-    // Получить скорости
+    // Скорости колес, мм/с: по времени между последними фронтами, новое
+    // значение с каждым фронтом. Без фронтов скорость спадает как
+    // MM_PER_TICK / (время с последнего фронта), после ENCODER_STOP_MS - ноль
     float getLeftSpeed() const;
     float getRightSpeed() const;
     
+    // Момент последнего фронта колеса side (micros), для поиска новых отсчетов
+    uint32_t getEdgeTime(int side) const;
+    
     // Получить количество тиков
     long getLeftTicks();
     long getRightTicks();
     
     // Сбросить счетчики
     void resetTicks();
+    
+    // Средний путь двух колес с момента старта, мм (без учета направления)
+    float getDistance();
+    
+    // Путь каждого колеса с момента старта, мм (одометрия курса)
+    float getLeftDistance();
+    float getRightDistance();
+    
+    // Забрать метки времени новых фронтов колеса side (MOTOR_SIDE_*), до maxCount.
+    // Возвращает количество; при переполнении буфера старые метки теряются.
+    int readEdges(int side, uint32_t* times, int maxCount);
+    
+    // Забыть накопленные метки (перед началом записи)
+    void clearEdges();
+};
+
+// Робот без энкодеров: те же методы, все нули. LineFollower проверяет
+// available на этапе компиляции - ветки с энкодерами не попадают в прошивку
+class NoEncoders {
+public:
+    static const bool available = false;
+    static const uint32_t staticBytes = 0;
+    
+    void begin() {}
+    void update() {}
+    float getLeftSpeed() const { return 0.0; }
+    float getRightSpeed() const { return 0.0; }
+    uint32_t getEdgeTime(int) const { return 0; }
+    float getDistance() { return 0.0; }
+    float getLeftDistance() { return 0.0; }
+    float getRightDistance() { return 0.0; }
+    int readEdges(int, uint32_t*, int) { return 0; }
+    void clearEdges() {}
 };
 
 #endif // ENCODERS_H
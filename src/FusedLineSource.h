@@ -0,0 +1,87 @@
+#ifndef FUSED_LINE_SOURCE_H
+#define FUSED_LINE_SOURCE_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "LineSource.h"
+#include "Sensors.h"
+#include "CameraLineSource.h"
+#include "LineFusion.h"
+
+// Камера и массив TCRT5000 одновременно (USE_LINE_FUSION): позиция у колес
+// от датчиков, линия впереди (getPreview) - от камеры, перенесенной в
+// настоящее по одометрии. VelocityEstimator - как у LineFollower;
+// с NoEncoders кадры камеры не переносятся.
+template <class VelocityEstimator>
+class FusedLineSource final : public LineSource {
+private:
+    LineSensors nearSensors;
+    CameraLineSource camera;
+    VelocityEstimator& encoders;
+    LineFusion fusion;
+    unsigned long lastFrameTime;   // getRxTime() последнего переданного кадра
+
+    float lastKnownPosition;
+    unsigned long lastPositionTime;
+
+public:
+    // Буферы фронтов массива TCRT5000
+    static const uint32_t staticBytes = LineSensors::staticBytes;
+
+    FusedLineSource(VelocityEstimator& e, HardwareSerial& port = Serial2)
+        : camera(port), encoders(e), lastFrameTime(0),
+          lastKnownPosition(-999), lastPositionTime(0) {}
+
+    void begin() override {
+        nearSensors.begin();
+        camera.begin();
+        Serial.println("[OK] Слияние камеры и датчиков линии");
+    }
+
+    // Датчики - в sensors[], кадр камеры и путь колес - в слияние
+    void read(int sensors[5]) override {
+        camera.poll();
+        if (camera.getRxTime() != lastFrameTime && camera.lineValid()) {
+            lastFrameTime = camera.getRxTime();
+            fusion.addFrame(camera.getLineState(), lastFrameTime);
+        }
+        if (VelocityEstimator::available) {
+            fusion.addOdometry(micros(), encoders.getLeftDistance(), encoders.getRightDistance());
+        }
+        nearSensors.read(sensors);
+    }
+
+    float calculatePosition(int sensors[5]) override {
+        float near = nearSensors.calculatePosition(sensors);
+        float offset;
+        if (!fusion.update(near != -999, near * SENSOR_SPACING, camera.lineValid(), offset)) {
+            return -999;
+        }
+
+        float position = constrain(offset / SENSOR_SPACING, -2.0f, 2.0f);
+        lastKnownPosition = position;
+        lastPositionTime = millis();
+        return position;
+    }
+
+    void calibrate() override {
+        nearSensors.calibrate();
+        camera.calibrate();
+        Serial.printf("Слияние: расхождение камеры %.1f мм, задержка кадра %lu мкс\n",
+                      fusion.getBias(), (unsigned long)fusion.getFrameAge(micros()));
+    }
+
+    float getLastKnownPosition() const override { return lastKnownPosition; }
+    unsigned long getLastPositionTime() const override { return lastPositionTime; }
+
+    void resetPositionMemory() override {
+        nearSensors.resetPositionMemory();
+        fusion.reset();
+        lastKnownPosition = -999;
+        lastPositionTime = 0;
+    }
+
+    bool getPreview(LinePreview& preview) const override { return fusion.getPreview(preview); }
+};
+
+#endif // FUSED_LINE_SOURCE_H
@@ -3,12 +3,14 @@
 
 #include <Arduino.h>
 #include "Config.h"
-#include "Sensors.h"
+#include "LineSource.h"
 #include "Motors.h"
 #include "PIDController.h"
-
-// Forward declaration
-class Encoders;
+#include "BrakeModel.h"
+#include "MotionProfile.h"
+#include "MotorSysId.h"
+#include "SteeringController.h"
+#include "BlackBoxFormat.h"
 
 // Состояния робота
 enum RobotState {
@@ -18,24 +20,86 @@ enum RobotState {
     SEARCHING_LEFT,    // Поиск линии влево
     SEARCHING_RIGHT,   // Поиск линии вправо
     LOST,              // Линия потеряна
-    STOPPED            // Остановлен
+    STOPPED,           // Остановлен
+    BRAKE_TEST,        // Калибровка торможения
+    SYSID              // Идентификация моторов (колеса подняты)
+};
+
+// Моторы и энкодеры политик LineFollower для MotorSysId
+template <class MotorDriver, class VelocityEstimator>
+class SysIdAdapter : public SysIdHardware {
+private:
+    MotorDriver& motors;
+    VelocityEstimator& encoders;
+    
+public:
+    SysIdAdapter(MotorDriver& m, VelocityEstimator& e) : motors(m), encoders(e) {}
+    
+    bool hasEncoders() const override { return VelocityEstimator::available; }
+    void coast() override { motors.coast(); }
+    void setSpeedNormalized(float left, float right) override { motors.setSpeedNormalized(left, right); }
+    int readEdges(int side, uint32_t* times, int maxCount) override {
+        return encoders.readEdges(side, times, maxCount);
+    }
+    void clearEdges() override { encoders.clearEdges(); }
 };
 
-// Класс для управления роботом, следующим по линии
-class LineFollower {
+/*
+ * Робот, следующий по линии. Железо - параметры шаблона (политики),
+ * а не указатели и #ifdef: неиспользуемое не компилируется, в цикле
+ * нет проверок "есть ли энкодеры", а смена источника линии - смена типа.
+ *
+ *   SensorSource       - LineSource: LineSensors, CameraLineSource, FusedLineSource
+ *   MotorDriver        - как Motors: setSpeedNormalized, coast, brake, reversePulse...
+ *   VelocityEstimator  - Encoders или NoEncoders (available = false)
+ *   TelemetrySink      - BlackBox, Telemetry, TelemetryPair, NullTelemetry
+ *
+ * Тип прошивки по Config.h - LineFollower в RobotConfig.h. Методы - в
+ * LineFollowerImpl.h: прошивка инстанцирует их в LineFollower.cpp,
+ * тесты на хосте включают его со своими политиками-заглушками.
+ */
+template <class SensorSource, class MotorDriver, class VelocityEstimator, class TelemetrySink>
+class BasicLineFollower {
 private:
-    LineSensors& sensors;
-    Motors& motors;
+    SensorSource& sensors;
+    MotorDriver& motors;
     PIDController& pid;
-    Encoders* encoders;  // Всегда указатель, может быть nullptr
+    VelocityEstimator& encoders;
+    TelemetrySink& telemetry;
     
     RobotState currentState;
     int baseSpeed;
     unsigned long searchStartTime;
     
+    // Ограничение ускорения и рывка, разгон с места
+    MotionProfile profile;
+    
+    // Геометрическое рулевое управление (альтернатива ПИД)
+    SteeringController steering;
+    float steerDistance;         // Путь без энкодеров - оценка по команде
+    unsigned long lastSteerTime;
+    
+    // Торможение по запросу slowDown(): до этого момента моторами не управляем
+    BrakeModel brakeModel;
+    unsigned long brakeUntil;
+    
+    // Калибровка торможения
+    int brakeTestRun;
+    bool brakeTestBraking;
+    int savedBaseSpeed;
+    unsigned long brakeTestPhaseStart;
+    unsigned long brakeTestLastMove;
+    float brakeTestV0;
+    float brakeTestStartDistance;
+    float brakeTestLastDistance;
+    
+    // Идентификация моторов
+    SysIdAdapter<MotorDriver, VelocityEstimator> sysIdHardware;
+    MotorSysId sysId;
+    
 public:
-    // Конструктор с опциональным параметром энкодеров
-    LineFollower(LineSensors& s, Motors& m, PIDController& p, Encoders* e = nullptr);
+    BasicLineFollower(SensorSource& s, MotorDriver& m, PIDController& p,
+                      VelocityEstimator& e, TelemetrySink& t);
     
     // Инициализация
     void begin();
@@ -57,10 +121,39 @@ public:
     void decreaseSpeed();
     int getBaseSpeed() const { return baseSpeed; }
     
+    // Закон рулевого управления
+    void setSteeringMode(SteeringMode mode);
+    SteeringMode getSteeringMode() const { return steering.getMode(); }
+    
+    // Замедлиться до targetSpeed (мм/с) на дистанции distanceMm.
+    // Выбирает самый мягкий достаточный режим торможения по модели.
+    // Нужны энкодеры. false - модель не успевает (тормозит по максимуму).
+    bool slowDown(float targetSpeed, float distanceMm);
+    
+    // Калибровка модели торможения по энкодерам (робот едет по линии)
+    void calibrateBraking();
+    BrakeModel& getBrakeModel() { return brakeModel; }
+    MotionProfile& getMotionProfile() { return profile; }
+    
+    // Идентификация моторов ступеньками и чирпом (нужны энкодеры, колеса подняты)
+    void identifyMotors();
+    const MotorSysId& getSysId() const { return sysId; }
+    
 private:
     // Внутренние методы
     void followLine();
+    void drive(int leftSpeed, int rightSpeed);
+    void steer(float position, const LinePreview* preview, int& leftSpeed, int& rightSpeed);
+    float currentSpeed() const;
+    float limitBase(float speed, float limit) const;
     void searchLine();
+    void recordState(float position, const int sensorValues[5], float correction,
+                     int leftSpeed, int rightSpeed, uint8_t flags);
+    bool braking();
+    void applyBrake(BrakeMode mode, uint16_t pulseMs);
+    float getSpeed() const;
+    void startBrakeTestRun();
+    void runBrakeTest();
 };
 
 #endif // LINE_FOLLOWER_H
@@ -0,0 +1,578 @@
+#ifndef LINE_FOLLOWER_IMPL_H
+#define LINE_FOLLOWER_IMPL_H
+
+// Методы BasicLineFollower. Включать только там, где нужен код шаблона:
+// LineFollower.cpp (прошивка) или тест на хосте со своими политиками.
+
+#include "LineFollower.h"
+#include "Profiler.h"
+
+#define LINE_FOLLOWER_TEMPLATE \
+    template <class SensorSource, class MotorDriver, class VelocityEstimator, class TelemetrySink>
+#define LINE_FOLLOWER_CLASS \
+    BasicLineFollower<SensorSource, MotorDriver, VelocityEstimator, TelemetrySink>
+
+// Конструктор
+LINE_FOLLOWER_TEMPLATE
+LINE_FOLLOWER_CLASS::BasicLineFollower(SensorSource& s, MotorDriver& m, PIDController& p,
+                                       VelocityEstimator& e, TelemetrySink& t)
+    : sensors(s), motors(m), pid(p), encoders(e), telemetry(t),
+      currentState(IDLE), baseSpeed(BASE_SPEED), searchStartTime(0),
+      steerDistance(0.0), lastSteerTime(0),
+      brakeUntil(0), brakeTestRun(0), brakeTestBraking(false), savedBaseSpeed(BASE_SPEED),
+      brakeTestPhaseStart(0), brakeTestLastMove(0), brakeTestV0(0.0),
+      brakeTestStartDistance(0.0), brakeTestLastDistance(0.0),
+      sysIdHardware(m, e), sysId(sysIdHardware) {
+}
+
+// Скорости калибровки торможения
+static const int brakeTestSpeeds[] = BRAKE_TEST_SPEEDS;
+static const int BRAKE_TEST_SPEED_COUNT = sizeof(brakeTestSpeeds) / sizeof(brakeTestSpeeds[0]);
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::begin() {
+    sensors.begin();
+    motors.begin();
+    
+    encoders.begin();
+    telemetry.begin();
+    
+    if (VelocityEstimator::available && sysId.load()) {
+        Serial.println("[OK] Модель моторов загружена:");
+        sysId.print();
+    }
+    
+    currentState = IDLE;
+    Serial.println("[OK] LineFollower инициализирован");
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::update() {
+    PROFILE_SCOPE(PROF_UPDATE);
+    
+    // Обновление энкодеров
+    if (VelocityEstimator::available) {
+        PROFILE_SCOPE(PROF_ENCODERS);
+        encoders.update();
+    }
+    
+    // Завершение импульса реверса
+    motors.update();
+    
+    // Проскальзывание при разгоне (отсчет на каждый новый фронт колеса)
+    if (VelocityEstimator::available && profile.isLaunching()) {
+        profile.onWheelSpeed(MOTOR_SIDE_LEFT, encoders.getLeftSpeed(),
+                             encoders.getEdgeTime(MOTOR_SIDE_LEFT));
+        profile.onWheelSpeed(MOTOR_SIDE_RIGHT, encoders.getRightSpeed(),
+                             encoders.getEdgeTime(MOTOR_SIDE_RIGHT));
+    }
+    
+    // Обработка текущего состояния
+    switch (currentState) {
+        case IDLE:
+        case STOPPED:
+            // Гарантируем, что моторы остановлены
+            motors.stop();
+            profile.reset();
+            break;
+            
+        case CALIBRATING:
+            sensors.calibrate();
+            currentState = IDLE;
+            break;
+            
+        case FOLLOWING:
+            followLine();
+            break;
+            
+        case SEARCHING_LEFT:
+        case SEARCHING_RIGHT:
+            searchLine();
+            break;
+            
+        case BRAKE_TEST:
+            runBrakeTest();
+            break;
+            
+        case SYSID:
+            if (!sysId.update()) {
+                currentState = IDLE;
+            }
+            break;
+            
+        case LOST:
+            motors.stop();
+            profile.reset();
+            Serial.println("⚠ ЛИНИЯ ПОТЕРЯНА! Отправьте 's' для повторного поиска");
+            currentState = IDLE;
+            break;
+    }
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::start() {
+    Serial.println("▶ СТАРТ - Начинаю следование по линии");
+    currentState = FOLLOWING;
+    brakeUntil = 0;
+    pid.reset();
+    steering.reset();
+    sensors.resetPositionMemory();
+    
+    // С места - плавный разгон до сцепления, а не скачок до baseSpeed
+    if (getSpeed() < 1.0) {
+        profile.startLaunch();
+    }
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::pause() {
+    Serial.println("⏸ ПАУЗА - Остановка");
+    if (currentState == BRAKE_TEST) baseSpeed = savedBaseSpeed;
+    if (currentState == SYSID) sysId.abort();
+    currentState = STOPPED;
+    motors.stop();
+    profile.reset();
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::stop() {
+    if (currentState == BRAKE_TEST) baseSpeed = savedBaseSpeed;
+    if (currentState == SYSID) sysId.abort();
+    currentState = STOPPED;
+    motors.stop();
+    profile.reset();
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::calibrate() {
+    Serial.println("⚙ Запуск калибровки датчиков");
+    currentState = CALIBRATING;
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::identifyMotors() {
+    if (!VelocityEstimator::available) {
+        Serial.println("✗ Идентификация моторов требует энкодеров");
+        return;
+    }
+    
+    profile.reset();
+    if (sysId.start()) {
+        currentState = SYSID;
+    }
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::increaseSpeed() {
+    baseSpeed = constrain(baseSpeed + 10, MIN_SPEED, MAX_SPEED);
+    Serial.printf("Скорость увеличена: %d\n", baseSpeed);
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::decreaseSpeed() {
+    baseSpeed = constrain(baseSpeed - 10, MIN_SPEED, MAX_SPEED);
+    Serial.printf("Скорость уменьшена: %d\n", baseSpeed);
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::followLine() {
+    int sensorValues[5];
+    {
+        PROFILE_SCOPE(PROF_SENSORS_READ);
+        sensors.read(sensorValues);
+    }
+    
+    float position;
+    {
+        PROFILE_SCOPE(PROF_POSITION);
+        position = sensors.calculatePosition(sensorValues);
+    }
+    
+    // Идет торможение по slowDown() - датчики читаем (память позиции), моторы не трогаем
+    if (braking()) {
+        recordState(position, sensorValues, 0.0, 0, 0, BLACKBOX_FLAG_BRAKING);
+        return;
+    }
+    
+    uint8_t blackBoxFlags = 0;
+    
+    // Проверка: линия найдена?
+    if (position == -999) {
+        // Линия не видна датчиками - проверяем память позиции
+        unsigned long timeSinceLine = millis() - sensors.getLastPositionTime();
+        float lastPosition = sensors.getLastKnownPosition();
+        
+        // Проверяем что есть валидная сохранённая позиция и она не устарела
+        if (lastPosition != -999 && timeSinceLine < LINE_MEMORY_TIMEOUT) {
+            // Используем последнюю известную позицию (линия между датчиками)
+            position = lastPosition;
+            blackBoxFlags |= BLACKBOX_FLAG_MEMORY;
+            
+            if (DEBUG_OUTPUT) {
+                static unsigned long lastMemoryDebugTime = 0;
+                if (millis() - lastMemoryDebugTime > 100) {
+                    Serial.printf("📍 Использую память позиции: %.2f (прошло %lu мс)\n", 
+                                  position, timeSinceLine);
+                    lastMemoryDebugTime = millis();
+                }
+            }
+        } else {
+            // Линия действительно потеряна - тормозим и начинаем поиск
+            Serial.println("⚠ Линия потеряна! Начинаю поиск...");
+            recordState(-999, sensorValues, 0.0, 0, 0, 0);
+            telemetry.event(BLACKBOX_LINE_LOST);
+            slowDown(0.0, BRAKE_ON_LINE_LOSS_MM);
+            currentState = SEARCHING_LEFT;
+            searchStartTime = millis();
+            return;
+        }
+    }
+    
+    // Линия впереди (камера): курс для руления и поворот, перед которым тормозить
+    LinePreview preview;
+    bool hasPreview = sensors.getPreview(preview);
+    
+    // Вычисляем ошибку (отклонение от центра)
+    float error = position;
+    int leftSpeed, rightSpeed;
+    float correction;
+    
+    if (steering.getMode() == STEERING_PID) {
+        // ПИД-регулятор
+        {
+            PROFILE_SCOPE(PROF_PID);
+            correction = pid.calculate(error);
+        }
+        
+        // Перед поворотом впереди базовая скорость снижается заранее
+        float base = baseSpeed;
+        if (hasPreview) {
+            base = limitBase(currentSpeed(), steering.approachSpeed(preview.curvature, preview.distanceMm));
+        }
+        
+        // Применяем корректировку к скоростям моторов
+        leftSpeed = base + correction;
+        rightSpeed = base - correction;
+        
+        // Ограничиваем скорости
+        leftSpeed = constrain(leftSpeed, MIN_SPEED, MAX_SPEED);
+        rightSpeed = constrain(rightSpeed, MIN_SPEED, MAX_SPEED);
+    } else {
+        // Геометрический закон: отношение скоростей колес по кривизне
+        {
+            PROFILE_SCOPE(PROF_STEER);
+            steer(position, hasPreview ? &preview : NULL, leftSpeed, rightSpeed);
+        }
+        correction = (leftSpeed - rightSpeed) / 2.0;
+    }
+    
+    // Устанавливаем скорости моторов (через профиль движения)
+    drive(leftSpeed, rightSpeed);
+    
+    if (profile.isLaunching()) blackBoxFlags |= BLACKBOX_FLAG_LAUNCH;
+    recordState(position, sensorValues, correction, leftSpeed, rightSpeed, blackBoxFlags);
+    
+    // Отладочный вывод
+    if (DEBUG_OUTPUT) {
+        static unsigned long lastDebugTime = 0;
+        if (millis() - lastDebugTime > 200) {  // Каждые 200 мс
+            Serial.print("Датчики: ");
+            for (int i = 0; i < 5; i++) {
+                Serial.print(sensorValues[i]);
+                Serial.print(" ");
+            }
+            Serial.printf("| Позиция: %.2f | Ошибка: %.2f | Коррекция: %.1f | Моторы: L=%d R=%d\n",
+                          position, error, correction, leftSpeed, rightSpeed);
+            lastDebugTime = millis();
+        }
+    }
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::searchLine() {
+    int sensorValues[5];
+    sensors.read(sensorValues);
+    
+    float position = sensors.calculatePosition(sensorValues);
+    
+    // Проверяем, нашли ли линию
+    if (position != -999) {
+        Serial.println("✓ Линия найдена! Продолжаю движение");
+        currentState = FOLLOWING;
+        pid.reset();
+        steering.reset();
+        return;
+    }
+    
+    recordState(position, sensorValues, 0.0, 0, 0, brakeUntil ? BLACKBOX_FLAG_BRAKING : 0);
+    
+    // Сначала дотормаживаем после потери линии
+    if (braking()) {
+        searchStartTime = millis();
+        return;
+    }
+    
+    // Проверяем таймаут
+    if (millis() - searchStartTime > SEARCH_TIMEOUT) {
+        Serial.println("✗ Таймаут поиска. Линия не найдена.");
+        telemetry.event(BLACKBOX_SEARCH_TIMEOUT);
+        currentState = LOST;
+        return;
+    }
+    
+    // Выполняем поиск (поворот на месте)
+    if (currentState == SEARCHING_LEFT) {
+        drive(-TURN_SPEED, TURN_SPEED);
+        
+        // Переключаемся на поиск вправо через половину времени
+        if (millis() - searchStartTime > SEARCH_TIMEOUT / 2) {
+            Serial.println("→ Переключаюсь на поиск вправо");
+            currentState = SEARCHING_RIGHT;
+        }
+    } else {
+        drive(TURN_SPEED, -TURN_SPEED);
+    }
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::recordState(float position, const int sensorValues[5], float correction,
+                                      int leftSpeed, int rightSpeed, uint8_t flags) {
+    // Без черного ящика и телеметрии запись даже не собирается
+    if (!TelemetrySink::enabled) return;
+    
+    BlackBoxRecord r;
+    r.timeUs = micros();
+    r.position = position == -999 ? BLACKBOX_NO_LINE : (int16_t)(position * 1000.0);
+    r.correction = (int16_t)constrain(correction * 10.0, -32767.0, 32767.0);
+    r.leftCommand = leftSpeed;
+    r.rightCommand = rightSpeed;
+    r.leftSpeed = (int16_t)encoders.getLeftSpeed();
+    r.rightSpeed = (int16_t)encoders.getRightSpeed();
+    r.sensorMask = 0;
+    for (int i = 0; i < 5; i++) {
+        if (sensorValues[i] == 0) r.sensorMask |= 1 << i;
+    }
+    r.state = currentState;
+    r.flags = flags;
+    r.reserved = 0;
+    telemetry.record(r);
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::steer(float position, const LinePreview* preview, int& leftSpeed, int& rightSpeed) {
+    unsigned long now = millis();
+    float dt = lastSteerTime == 0 ? 0.0 : (now - lastSteerTime) / 1000.0;
+    lastSteerTime = now;
+    
+    // Скорость и путь: по энкодерам или оценка по команде. Скорость по
+    // периоду фронтов - свежая на каждом фронте, Stanley и предел бокового
+    // ускорения следуют за разгоном и торможением без задержки окна
+    float speed = currentSpeed();
+    float distance;
+    if (VelocityEstimator::available) {
+        distance = encoders.getDistance();
+    } else {
+        steerDistance += speed * dt;
+        distance = steerDistance;
+    }
+    
+    float offset = position * SENSOR_SPACING;
+    float curvature;
+    if (preview) {
+        // Курс линии измерен камерой
+        curvature = steering.update(offset, preview->headingRad, speed, distance);
+    } else {
+        curvature = steering.update(offset, speed, distance);
+    }
+    
+    // Скорость - и под текущую дугу, и под видимую камерой впереди
+    float limit = steering.speedLimit(curvature);
+    if (preview) {
+        float approach = steering.approachSpeed(preview->curvature, preview->distanceMm);
+        if (approach < limit) limit = approach;
+    }
+    
+    // Боковое ускорение v²·κ не больше предела - на крутой дуге сбрасываем скорость
+    SteeringController::wheelCommands(limitBase(speed, limit), curvature, leftSpeed, rightSpeed);
+}
+
+LINE_FOLLOWER_TEMPLATE
+float LINE_FOLLOWER_CLASS::currentSpeed() const {
+    if (VelocityEstimator::available) return getSpeed();
+    return baseSpeed * STEER_SPEED_PER_COMMAND;
+}
+
+LINE_FOLLOWER_TEMPLATE
+float LINE_FOLLOWER_CLASS::limitBase(float speed, float limit) const {
+    float base = baseSpeed;
+    if (speed > limit) {
+        base = constrain(base * limit / speed, (float)MIN_SPEED, base);
+    }
+    return base;
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::setSteeringMode(SteeringMode mode) {
+    steering.setMode(mode);
+    pid.reset();
+    lastSteerTime = 0;
+    Serial.printf("Рулевое управление: %s\n", steeringModeName(steering.getMode()));
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::drive(int leftSpeed, int rightSpeed) {
+    PROFILE_SCOPE(PROF_MOTORS);
+    float left, right;
+    profile.update(leftSpeed, rightSpeed, left, right);
+    motors.setSpeedNormalized(left, right);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// ТОРМОЖЕНИЕ
+// ═══════════════════════════════════════════════════════════════════════════
+
+LINE_FOLLOWER_TEMPLATE
+float LINE_FOLLOWER_CLASS::getSpeed() const {
+    // Среднее колес, каждое - по последним фронтам (Encoders::edgeSpeed)
+    if (!VelocityEstimator::available) return 0.0;
+    return (encoders.getLeftSpeed() + encoders.getRightSpeed()) / 2.0;
+}
+
+LINE_FOLLOWER_TEMPLATE
+bool LINE_FOLLOWER_CLASS::braking() {
+    if (brakeUntil == 0) return false;
+    if ((long)(millis() - brakeUntil) < 0) return true;
+    
+    brakeUntil = 0;
+    pid.reset();
+    profile.reset();  // Моторы были в торможении - профиль снова с нуля
+    return false;
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::applyBrake(BrakeMode mode, uint16_t pulseMs) {
+    switch (mode) {
+        case BRAKE_MODE_COAST:
+            motors.coast();
+            break;
+        case BRAKE_MODE_BRAKE:
+            motors.brake();
+            break;
+        default:
+            motors.reversePulse(255, pulseMs);
+            break;
+    }
+}
+
+LINE_FOLLOWER_TEMPLATE
+bool LINE_FOLLOWER_CLASS::slowDown(float targetSpeed, float distanceMm) {
+    if (!VelocityEstimator::available) return false;
+    
+    BrakePlan plan = brakeModel.plan(getSpeed(), targetSpeed, distanceMm);
+    if (plan.durationMs == 0) return true;
+    
+    applyBrake(plan.mode, plan.pulseMs);
+    profile.reset();
+    brakeUntil = millis() + plan.durationMs;
+    if (brakeUntil == 0) brakeUntil = 1;
+    
+    if (DEBUG_OUTPUT) {
+        Serial.printf("🛑 Торможение: %s %u мс, путь %.0f мм из %.0f%s\n",
+                      brakeModeName(plan.mode), plan.durationMs, plan.distanceMm, distanceMm,
+                      plan.feasible ? "" : " (не успевает)");
+    }
+    return plan.feasible;
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::calibrateBraking() {
+    if (!VelocityEstimator::available) {
+        Serial.println("✗ Калибровка торможения требует энкодеров");
+        return;
+    }
+    
+    Serial.printf("⚙ Калибровка торможения: %d заездов по %d мс, нужен длинный прямой участок\n",
+                  BRAKE_MODE_COUNT * BRAKE_TEST_SPEED_COUNT, BRAKE_TEST_RUN_MS);
+    brakeModel.clearSamples();
+    brakeTestRun = 0;
+    savedBaseSpeed = baseSpeed;
+    currentState = BRAKE_TEST;
+    startBrakeTestRun();
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::startBrakeTestRun() {
+    baseSpeed = brakeTestSpeeds[brakeTestRun % BRAKE_TEST_SPEED_COUNT];
+    brakeUntil = 0;
+    brakeTestBraking = false;
+    brakeTestPhaseStart = millis();
+    pid.reset();
+    sensors.resetPositionMemory();
+    profile.startLaunch();
+}
+
+LINE_FOLLOWER_TEMPLATE
+void LINE_FOLLOWER_CLASS::runBrakeTest() {
+    BrakeMode mode = (BrakeMode)(brakeTestRun / BRAKE_TEST_SPEED_COUNT);
+    unsigned long now = millis();
+    
+    if (!brakeTestBraking) {
+        // Разгон по линии
+        followLine();
+        if (currentState != BRAKE_TEST) {
+            Serial.println("✗ Калибровка торможения прервана: линия потеряна");
+            baseSpeed = savedBaseSpeed;
+            return;
+        }
+        if (now - brakeTestPhaseStart < BRAKE_TEST_RUN_MS) return;
+        
+        brakeTestV0 = getSpeed();
+        brakeTestStartDistance = encoders.getDistance();
+        brakeTestLastDistance = brakeTestStartDistance;
+        brakeTestLastMove = now;
+        brakeTestBraking = true;
+        
+        float pulseMs = brakeModel.time(BRAKE_MODE_REVERSE, brakeTestV0, 0.0);
+        pulseMs = constrain(pulseMs, 0.0, (float)BRAKE_REVERSE_MAX_MS);
+        applyBrake(mode, (uint16_t)pulseMs);
+        return;
+    }
+    
+    // Ждем остановки: нет новых тиков BRAKE_TEST_STILL_MS
+    float distance = encoders.getDistance();
+    if (distance != brakeTestLastDistance) {
+        brakeTestLastDistance = distance;
+        brakeTestLastMove = now;
+    }
+    bool still = now - brakeTestLastMove >= BRAKE_TEST_STILL_MS;
+    bool timeout = now - brakeTestPhaseStart >= BRAKE_TEST_RUN_MS + BRAKE_TEST_TIMEOUT_MS;
+    if (!still && !timeout) return;
+    
+    float stopDistance = brakeTestLastDistance - brakeTestStartDistance;
+    brakeModel.addSample(mode, brakeTestV0, stopDistance);
+    motors.coast();
+    profile.reset();
+    Serial.printf("  %-10s v0=%.0f мм/с → путь %.0f мм%s\n",
+                  brakeModeName(mode), brakeTestV0, stopDistance, timeout ? " (таймаут)" : "");
+    
+    brakeTestRun++;
+    if (brakeTestRun < BRAKE_MODE_COUNT * BRAKE_TEST_SPEED_COUNT) {
+        startBrakeTestRun();
+        return;
+    }
+    
+    brakeModel.fit();
+    Serial.println("✓ Модель торможения:");
+    for (int m = 0; m < BRAKE_MODE_COUNT; m++) {
+        Serial.printf("  %-10s замедление %.0f мм/с², задержка %.0f мс\n",
+                      brakeModeName((BrakeMode)m), brakeModel.getDecel((BrakeMode)m),
+                      brakeModel.getDeadTime((BrakeMode)m) * 1000.0);
+    }
+    baseSpeed = savedBaseSpeed;
+    currentState = IDLE;
+}
+
+#undef LINE_FOLLOWER_TEMPLATE
+#undef LINE_FOLLOWER_CLASS
+
+#endif // LINE_FOLLOWER_IMPL_H
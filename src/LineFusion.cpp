@@ -0,0 +1,175 @@
+#include "LineFusion.h"
+
+#define HISTORY_MASK (FUSION_HISTORY - 1)
+static_assert((FUSION_HISTORY & HISTORY_MASK) == 0, "FUSION_HISTORY - степень двойки");
+
+LineFusion::LineFusion() {
+    reset();
+}
+
+void LineFusion::reset() {
+    memset(&pose, 0, sizeof(pose));
+    historyHead = 0;
+    historyCount = 0;
+    lastLeft = 0.0;
+    lastRight = 0.0;
+    haveWheels = false;
+    memset(&frame, 0, sizeof(frame));
+    captureTime = 0;
+    haveFrame = false;
+    frameRejected = false;
+    bias = 0.0;
+    haveBias = false;
+    biasRejects = 0;
+    memset(&preview, 0, sizeof(preview));
+    previewValid = false;
+}
+
+void LineFusion::addOdometry(uint32_t timeUs, float leftMm, float rightMm) {
+    if (haveWheels) {
+        // Дуга за цикл: курс меняется на разность путей колес / колея
+        float dl = leftMm - lastLeft;
+        float dr = rightMm - lastRight;
+        float ds = (dl + dr) / 2.0f;
+        float turn = (dl - dr) / WHEEL_BASE;
+        float mid = pose.heading + turn / 2.0f;
+        pose.x += ds * cosf(mid);
+        pose.y += ds * sinf(mid);
+        pose.heading += turn;
+    }
+    lastLeft = leftMm;
+    lastRight = rightMm;
+    haveWheels = true;
+    pose.timeUs = timeUs;
+
+    const OdometryPose& newest = history[(historyHead - 1) & HISTORY_MASK];
+    if (historyCount == 0 || timeUs - newest.timeUs >= FUSION_ODOMETRY_US) {
+        history[historyHead] = pose;
+        historyHead = (historyHead + 1) & HISTORY_MASK;
+        if (historyCount < FUSION_HISTORY) historyCount++;
+    }
+}
+
+void LineFusion::addFrame(const LineLinkState& state, uint32_t rxTimeUs) {
+    frame = state;
+    // Камера сообщает задержку от съемки до отправки, остальное - передача
+    captureTime = rxTimeUs - state.latencyUs - FUSION_LINK_DELAY_US;
+    haveFrame = true;
+    frameRejected = false;
+}
+
+bool LineFusion::poseAt(uint32_t time, OdometryPose& result) const {
+    if ((int32_t)(time - pose.timeUs) >= 0) {
+        result = pose;
+        return true;
+    }
+
+    // От новых точек к старым: ищем пару вокруг time
+    const OdometryPose* after = &pose;
+    for (uint8_t i = 0; i < historyCount; i++) {
+        const OdometryPose& before = history[(historyHead - 1 - i) & HISTORY_MASK];
+        if ((int32_t)(time - before.timeUs) >= 0) {
+            uint32_t span = after->timeUs - before.timeUs;
+            float k = span > 0 ? (float)(time - before.timeUs) / span : 0.0f;
+            result.timeUs = time;
+            result.x = before.x + k * (after->x - before.x);
+            result.y = before.y + k * (after->y - before.y);
+            result.heading = before.heading + k * (after->heading - before.heading);
+            return true;
+        }
+        after = &before;
+    }
+
+    // Кадр старше истории
+    return false;
+}
+
+bool LineFusion::compensate(LinePreview& result) const {
+    // Без энкодеров истории нет - кадр как есть
+    OdometryPose then = pose;
+    if (historyCount > 0 && !poseAt(captureTime, then)) {
+        return false;
+    }
+
+    /*
+     * Сдвиг и поворот робота с момента съемки в системе того момента,
+     * затем точка линии (refForwardMm, positionMm) и ее курс - в текущую
+     * систему. Кривизна от переноса не меняется.
+     */
+    float c = cosf(then.heading);
+    float s = sinf(then.heading);
+    float wx = pose.x - then.x;
+    float wy = pose.y - then.y;
+    float dx = wx * c + wy * s;
+    float dy = -wx * s + wy * c;
+    float turn = pose.heading - then.heading;
+
+    float u = frame.refForwardMm - dx;
+    float v = frame.positionMm - dy;
+    float forward = u * cosf(turn) + v * sinf(turn);
+    float lateral = -u * sinf(turn) + v * cosf(turn);
+    float heading = frame.headingRad - turn;
+    float curvatureMm = frame.curvature / 1000.0f;
+
+    // На линию датчиков, как CameraLineSource: x(t) = x0 + t*tg(курс) + k*t²/2
+    float t = SENSOR_OFFSET - forward;
+    float slope = tanf(heading);
+    result.offsetMm = lateral + t * slope + 0.5f * curvatureMm * t * t;
+    result.headingRad = atanf(slope + curvatureMm * t);
+    result.curvature = curvatureMm;
+    result.distanceMm = forward;
+    return true;
+}
+
+bool LineFusion::update(bool nearValid, float nearOffsetMm, bool cameraValid, float& offsetMm) {
+    previewValid = false;
+
+    LinePreview camera;
+    bool haveCamera = cameraValid && haveFrame && compensate(camera);
+
+    if (haveCamera && nearValid) {
+        // Камера и датчики видят одну линию - уточняем расхождение.
+        // Первый общий кадр задает его как есть. Скачок расхождения -
+        // развилка или ошибка камеры: кадр не берем; держится
+        // FUSION_BIAS_RESEED кадров подряд - камеру сдвинули, берем заново
+        float difference = camera.offsetMm - nearOffsetMm;
+        bool jump = haveBias && fabsf(difference - bias) > FUSION_MAX_BIAS;
+        if (jump && !frameRejected) {
+            // Цикл чаще кадров - считаем каждый кадр один раз
+            frameRejected = true;
+            biasRejects++;
+        }
+        if (jump && biasRejects < FUSION_BIAS_RESEED) {
+            haveCamera = false;
+        } else if (jump || !haveBias) {
+            bias = difference;
+            haveBias = true;
+            biasRejects = 0;
+        } else {
+            bias += FUSION_BIAS_ALPHA * (difference - bias);
+            biasRejects = 0;
+        }
+    }
+
+    if (nearValid) {
+        offsetMm = nearOffsetMm;
+    } else if (haveCamera) {
+        // Линия ушла с массива - камера с поправкой на расхождение
+        offsetMm = camera.offsetMm - bias;
+    } else {
+        return false;
+    }
+
+    if (haveCamera) {
+        preview = camera;
+        preview.offsetMm = offsetMm;
+        previewValid = true;
+    }
+    return true;
+}
+
+bool LineFusion::getPreview(LinePreview& result) const {
+    if (!previewValid) return false;
+    result = preview;
+    return true;
+}
@@ -0,0 +1,90 @@
+#ifndef LINE_FUSION_H
+#define LINE_FUSION_H
+
+#include <Arduino.h>
+#include <LineLink.h>
+#include "Config.h"
+#include "LineSource.h"
+
+// История положения робота для переноса кадров камеры (степень двойки)
+#define FUSION_HISTORY 64
+
+// Положение робота по одометрии: x вперед, y вправо (мм), курс + вправо
+struct OdometryPose {
+    uint32_t timeUs;
+    float x;
+    float y;
+    float heading;
+};
+
+/*
+ * Слияние камеры (дальний план) и массива TCRT5000 (ближний).
+ *
+ * Кадр камеры описывает линию в системе робота на момент съемки, а
+ * приходит на десятки мс позже. По одометрии энкодеров находим, куда робот
+ * сместился и повернулся с тех пор, и переносим линию в текущую систему:
+ * смещение и курс на линии датчиков, кривизна и расстояние до нее.
+ *
+ * Смещение берется с датчиков, пока они видят линию: они точнее и без
+ * задержки. Разница камеры и датчиков фильтруется и добавляется к камере,
+ * когда линия уходит с массива. Без энкодеров кадр не переносится.
+ *
+ * Только математика, без железа: вызывается из FusedLineSource.
+ */
+class LineFusion {
+private:
+    // Текущее положение и история с шагом FUSION_ODOMETRY_US
+    OdometryPose pose;
+    OdometryPose history[FUSION_HISTORY];
+    uint8_t historyHead;         // Куда писать следующую точку
+    uint8_t historyCount;
+    float lastLeft;
+    float lastRight;
+    bool haveWheels;
+
+    // Последний кадр камеры и момент съемки по часам робота
+    LineLinkState frame;
+    uint32_t captureTime;
+    bool haveFrame;
+    bool frameRejected;      // Кадр уже засчитан в biasRejects
+
+    // Камера минус датчики на линии датчиков, мм
+    float bias;
+    bool haveBias;
+    uint8_t biasRejects;     // Кадров подряд с расхождением дальше FUSION_MAX_BIAS
+
+    LinePreview preview;
+    bool previewValid;
+
+    // Положение робота в момент time (интерполяция истории)
+    bool poseAt(uint32_t time, OdometryPose& result) const;
+
+    // Кадр камеры в текущей системе робота
+    bool compensate(LinePreview& result) const;
+
+public:
+    LineFusion();
+
+    // Забыть историю, кадр и расхождение (старт)
+    void reset();
+
+    // Путь колес с момента старта (мм) - каждый цикл
+    void addOdometry(uint32_t timeUs, float leftMm, float rightMm);
+
+    // Новый кадр с линией; rxTimeUs - micros() приема
+    void addFrame(const LineLinkState& state, uint32_t rxTimeUs);
+
+    // Оценка на текущий цикл. nearValid/nearOffsetMm - датчики,
+    // cameraValid - кадр свежий и уверенный. false - линии нет
+    bool update(bool nearValid, float nearOffsetMm, bool cameraValid, float& offsetMm);
+
+    // Линия впереди по результату update()
+    bool getPreview(LinePreview& result) const;
+
+    float getBias() const { return bias; }
+
+    // Задержка последнего кадра: от съемки до сейчас, мкс
+    uint32_t getFrameAge(uint32_t nowUs) const { return haveFrame ? nowUs - captureTime : 0; }
+};
+
+#endif // LINE_FUSION_H
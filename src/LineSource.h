@@ -0,0 +1,48 @@
+#ifndef LINE_SOURCE_H
+#define LINE_SOURCE_H
+
+// Линия впереди робота - у источников, которые видят дальше датчиков (камера)
+struct LinePreview {
+    float offsetMm;      // Смещение линии на линии датчиков (SENSOR_OFFSET), + вправо
+    float headingRad;    // Курс линии там же относительно робота, + вправо
+    float curvature;     // Кривизна линии впереди, 1/мм (+ поворот вправо)
+    float distanceMm;    // На каком расстоянии впереди оси колес измерена кривизна
+};
+
+// Интерфейс источника позиции линии для LineFollower
+// Реализации: LineSensors (массив TCRT5000), CameraLineSource (ESP32-CAM по UART),
+// FusedLineSource (оба сразу).
+// LineFollower получает конкретный тип параметром шаблона, реализации
+// помечены final - вызовы без виртуальной диспетчеризации
+class LineSource {
+public:
+    virtual ~LineSource() {}
+    
+    // Инициализация
+    virtual void begin() = 0;
+    
+    // Чтение значений (5 датчиков, 0 = линия, 1 = поле)
+    virtual void read(int sensors[5]) = 0;
+    
+    // Вычисление позиции линии (-2.0 до +2.0, или -999 если не найдена)
+    virtual float calculatePosition(int sensors[5]) = 0;
+    
+    // Калибровка
+    virtual void calibrate() = 0;
+    
+    // Последняя известная позиция линии и время её обнаружения (мс)
+    virtual float getLastKnownPosition() const = 0;
+    virtual unsigned long getLastPositionTime() const = 0;
+    
+    // Сбросить память позиции
+    virtual void resetPositionMemory() = 0;
+    
+    // Линия впереди на момент последнего calculatePosition().
+    // false - источник ее не видит (массив TCRT5000 - никогда)
+    virtual bool getPreview(LinePreview& preview) const {
+        (void)preview;
+        return false;
+    }
+};
+
+#endif // LINE_SOURCE_H
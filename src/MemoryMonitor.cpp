@@ -0,0 +1,53 @@
+#include "MemoryMonitor.h"
+
+MemoryMonitor::TaskEntry MemoryMonitor::tasks[MEMORY_MAX_TASKS];
+uint8_t MemoryMonitor::taskCount = 0;
+uint32_t MemoryMonitor::startupFreeHeap = 0;
+
+void MemoryMonitor::addTask(const char* name, TaskHandle_t handle, uint32_t stackBytes) {
+    if (handle == NULL) {
+        Serial.printf("✗ Задача %s не создана\n", name);
+        return;
+    }
+    if (taskCount >= MEMORY_MAX_TASKS) return;
+
+    tasks[taskCount].name = name;
+    tasks[taskCount].handle = handle;
+    tasks[taskCount].stackBytes = stackBytes;
+    taskCount++;
+}
+
+void MemoryMonitor::markStartup() {
+    startupFreeHeap = ESP.getFreeHeap();
+}
+
+void MemoryMonitor::print(const MemoryBuffer* buffers, size_t count) {
+    uint32_t total = memoryTotal(buffers, count);
+    Serial.printf("[MEM] Статическая память: %lu из %lu байт бюджета\n",
+                  (unsigned long)total, (unsigned long)STATIC_RAM_BUDGET);
+    for (size_t i = 0; i < count; i++) {
+        Serial.printf("  %-18s %7lu\n", buffers[i].name, (unsigned long)buffers[i].bytes);
+    }
+
+    // Минимум свободного стека с момента запуска задачи (на ESP32 - в байтах)
+    Serial.println("[MEM] Стеки задач, байт:");
+    for (uint8_t i = 0; i < taskCount; i++) {
+        const TaskEntry& t = tasks[i];
+        uint32_t minFree = uxTaskGetStackHighWaterMark(t.handle);
+        uint32_t used = t.stackBytes > minFree ? t.stackBytes - minFree : 0;
+        Serial.printf("  %-14s стек %6lu  занято до %6lu (%3lu%%)  запас %6lu%s\n",
+                      t.name, (unsigned long)t.stackBytes, (unsigned long)used,
+                      (unsigned long)(t.stackBytes ? used * 100 / t.stackBytes : 0),
+                      (unsigned long)minFree, minFree < STACK_WARN_FREE ? "  ← мало!" : "");
+    }
+
+    uint32_t freeHeap = ESP.getFreeHeap();
+    Serial.printf("[MEM] Куча: свободно %lu, минимум %lu, крупнейший блок %lu\n",
+                  (unsigned long)freeHeap, (unsigned long)ESP.getMinFreeHeap(),
+                  (unsigned long)ESP.getMaxAllocHeap());
+    if (startupFreeHeap > 0) {
+        long change = (long)freeHeap - (long)startupFreeHeap;
+        Serial.printf("[MEM] После инициализации: %lu, изменение %+ld\n",
+                      (unsigned long)startupFreeHeap, change);
+    }
+}
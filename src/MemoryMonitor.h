@@ -0,0 +1,66 @@
+#ifndef MEMORY_MONITOR_H
+#define MEMORY_MONITOR_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// Сколько задач можно зарегистрировать для отчета
+#define MEMORY_MAX_TASKS 8
+
+// Статический объект прошивки для бюджета памяти
+struct MemoryBuffer {
+    const char* name;
+    uint32_t bytes;
+};
+
+// Сумма размеров на этапе компиляции (для static_assert бюджета)
+constexpr uint32_t memoryTotal(const MemoryBuffer* buffers, size_t count) {
+    return count == 0 ? 0 : buffers[0].bytes + memoryTotal(buffers + 1, count - 1);
+}
+
+// TCB и стек задачи FreeRTOS в .bss - задача создается без кучи.
+// На ESP32 StackType_t - байт, размер стека задается в байтах
+template <uint32_t StackBytes>
+struct StaticTaskMemory {
+    StaticTask_t tcb;
+    StackType_t stack[StackBytes];
+};
+
+// Отчет о памяти: бюджет статических объектов, запас стека задач
+// (минимум свободного с момента старта) и состояние кучи.
+// Регистрация задач - из setup(), печать - из любой задачи.
+class MemoryMonitor {
+private:
+    struct TaskEntry {
+        const char* name;
+        TaskHandle_t handle;
+        uint32_t stackBytes;
+    };
+
+    static TaskEntry tasks[MEMORY_MAX_TASKS];
+    static uint8_t taskCount;
+    static uint32_t startupFreeHeap;
+
+public:
+    // Создать задачу в статической памяти и добавить ее в отчет
+    template <uint32_t StackBytes>
+    static TaskHandle_t startTask(StaticTaskMemory<StackBytes>& memory, TaskFunction_t function,
+                                  const char* name, UBaseType_t priority, BaseType_t core) {
+        TaskHandle_t handle = xTaskCreateStaticPinnedToCore(function, name, StackBytes, NULL, priority,
+                                                            memory.stack, &memory.tcb, core);
+        addTask(name, handle, StackBytes);
+        return handle;
+    }
+
+    // Задача, созданная не нами (loopTask Arduino)
+    static void addTask(const char* name, TaskHandle_t handle, uint32_t stackBytes);
+
+    // Запомнить свободную кучу после инициализации: рост расхода
+    // после этого момента - выделения памяти во время работы
+    static void markStartup();
+
+    // Таблица бюджета, стеки задач, куча
+    static void print(const MemoryBuffer* buffers, size_t count);
+};
+
+#endif // MEMORY_MONITOR_H
@@ -0,0 +1,174 @@
+#include "MotionProfile.h"
+
+// Шаг больше этого (например, после паузы задачи) не интегрируем
+#define MOTION_MAX_DT 0.05f
+
+MotionProfile::MotionProfile()
+    : lastMicros(0), accelLimit(MOTION_ACCEL), decelLimit(MOTION_DECEL), jerkLimit(MOTION_JERK),
+      launching(false), launchSlipped(false), launchCap(0.0f), launchRate(LAUNCH_RATE_START),
+      launchStart(0), launchMicros(0), tractionAccel(0.0f) {
+    for (int side = 0; side < 2; side++) {
+        lastEdge[side] = 0;
+        sampleTime[side] = 0;
+        lastSpeed[side] = 0.0f;
+        wheelAccel[side] = 0.0f;
+        launchEdges[side] = 0;
+    }
+    reset();
+}
+
+void MotionProfile::reset() {
+    for (int side = 0; side < 2; side++) {
+        command[side] = 0.0f;
+        rate[side] = 0.0f;
+    }
+    launching = false;
+    lastMicros = 0;
+}
+
+void MotionProfile::setLimits(float accel, float decel, float jerk) {
+    accelLimit = accel > 1.0f ? accel : 1.0f;
+    decelLimit = decel > 1.0f ? decel : 1.0f;
+    jerkLimit = jerk > 1.0f ? jerk : 1.0f;
+}
+
+void MotionProfile::startLaunch() {
+    reset();
+    launching = true;
+    launchSlipped = false;
+    launchCap = 0.0f;
+    launchStart = millis();
+    
+    // Робот стоит: первый отсчет каждого колеса сравниваем с нулем в момент старта
+    launchMicros = micros();
+    for (int side = 0; side < 2; side++) {
+        lastEdge[side] = launchMicros;
+        sampleTime[side] = launchMicros;
+        lastSpeed[side] = 0.0f;
+        wheelAccel[side] = 0.0f;
+        launchEdges[side] = 0;
+    }
+}
+
+float MotionProfile::stepWheel(int side, float target, float dt) {
+    float error = target - command[side];
+    if (error == 0.0f && rate[side] == 0.0f) return command[side];
+    
+    // Рост модуля команды - разгон, уменьшение - замедление (лимит больше)
+    bool speedingUp = fabsf(target) > fabsf(command[side]) &&
+                      (target >= 0.0f) == (command[side] >= 0.0f);
+    float limit = speedingUp ? accelLimit : decelLimit;
+    
+    /*
+     * Трапеция по ускорению: желаемая скорость изменения не больше той,
+     * с которой при рывке jerkLimit еще можно погасить ее ровно к цели
+     * (v² = 2·j·|e|), и не больше limit
+     */
+    float desired = sqrtf(2.0f * jerkLimit * fabsf(error));
+    if (desired > limit) desired = limit;
+    if (error < 0.0f) desired = -desired;
+    
+    float maxChange = jerkLimit * dt;
+    rate[side] += constrain(desired - rate[side], -maxChange, maxChange);
+    
+    float next = command[side] + rate[side] * dt;
+    
+    // Проскочили цель - встаем точно на нее
+    if ((error > 0.0f && next >= target) || (error < 0.0f && next <= target)) {
+        next = target;
+        rate[side] = 0.0f;
+    }
+    command[side] = next;
+    return next;
+}
+
+void MotionProfile::update(float targetLeft, float targetRight, float& outLeft, float& outRight) {
+    unsigned long now = micros();
+    float dt = lastMicros == 0 ? 0.001f : (now - lastMicros) / 1000000.0f;
+    if (dt > MOTION_MAX_DT) dt = MOTION_MAX_DT;
+    lastMicros = now;
+    
+    targetLeft = constrain(targetLeft, -255.0f, 255.0f);
+    targetRight = constrain(targetRight, -255.0f, 255.0f);
+    
+    if (launching) {
+        // Масштабируем обе команды: соотношение колес (коррекция ПИД) сохраняется,
+        // знак не меняется
+        float mean = (targetLeft + targetRight) / 2.0f;
+        launchCap += launchRate * dt;
+        if (mean > launchCap) {
+            float scale = launchCap / mean;
+            targetLeft *= scale;
+            targetRight *= scale;
+        } else {
+            finishLaunch();
+        }
+        if (launching && millis() - launchStart > LAUNCH_MAX_MS) {
+            finishLaunch();
+        }
+    }
+    
+    outLeft = stepWheel(MOTOR_SIDE_LEFT, targetLeft, dt) / 255.0f;
+    outRight = stepWheel(MOTOR_SIDE_RIGHT, targetRight, dt) / 255.0f;
+}
+
+void MotionProfile::finishLaunch() {
+    launching = false;
+    
+    // Старт без проскальзывания - в следующий раз пробуем быстрее
+    if (!launchSlipped) {
+        launchRate = constrain(launchRate * LAUNCH_RATE_GROWTH, (float)LAUNCH_RATE_MIN, (float)LAUNCH_RATE_MAX);
+    }
+    
+    if (DEBUG_OUTPUT) {
+        Serial.printf("🚀 Разгон: %lu мс%s, темп %.0f ед/с, сцепление %.0f мм/с²\n",
+                      millis() - launchStart, launchSlipped ? " (проскальзывание)" : "",
+                      launchRate, tractionAccel);
+    }
+}
+
+void MotionProfile::onWheelSpeed(int side, float speed, uint32_t edgeTime) {
+    if (!launching || (int32_t)(edgeTime - lastEdge[side]) <= 0) return;
+    lastEdge[side] = edgeTime;
+    
+    // Скорость усреднена по ENCODER_SPEED_EDGES периодам: пока среди них
+    // есть период до старта, она занижена - такие отсчеты пропускаем
+    if (launchEdges[side] <= ENCODER_SPEED_EDGES) {
+        launchEdges[side]++;
+        if (launchEdges[side] <= ENCODER_SPEED_EDGES) return;
+    }
+    
+    float dt = (edgeTime - sampleTime[side]) / 1000000.0f;
+    float accel = dt > 0.0f ? (speed - lastSpeed[side]) / dt : 0.0f;
+    sampleTime[side] = edgeTime;
+    lastSpeed[side] = speed;
+    wheelAccel[side] = accel;
+    
+    /*
+     * Колесо не может разгоняться быстрее, чем позволяет сцепление с
+     * полом: резкий скачок скорости одного колеса или большая разница
+     * скоростей при одинаковой команде - пробуксовка. Другое колесо
+     * измерено на своем фронте - переносим его скорость к этому моменту
+     */
+    int other = side == MOTOR_SIDE_LEFT ? MOTOR_SIDE_RIGHT : MOTOR_SIDE_LEFT;
+    bool slip = accel > LAUNCH_SLIP_ACCEL;
+    if (launchEdges[other] > ENCODER_SPEED_EDGES) {
+        float age = (edgeTime - sampleTime[other]) / 1000000.0f;
+        float otherSpeed = lastSpeed[other] + wheelAccel[other] * age;
+        if (fabsf(speed - otherSpeed) > LAUNCH_SLIP_DIFF) slip = true;
+    }
+    
+    if (!slip) {
+        if (launchEdges[other] > ENCODER_SPEED_EDGES) {
+            float bodyAccel = (accel + wheelAccel[other]) / 2.0f;
+            if (bodyAccel > tractionAccel) tractionAccel = bodyAccel;
+        }
+        return;
+    }
+    
+    // Сбрасываем команду до сцепления и запоминаем более медленный темп
+    launchSlipped = true;
+    float mean = (command[MOTOR_SIDE_LEFT] + command[MOTOR_SIDE_RIGHT]) / 2.0f;
+    launchCap = mean * LAUNCH_SLIP_BACKOFF;
+    launchRate = constrain(launchRate * LAUNCH_SLIP_BACKOFF, (float)LAUNCH_RATE_MIN, (float)LAUNCH_RATE_MAX);
+}
@@ -0,0 +1,66 @@
+#ifndef MOTION_PROFILE_H
+#define MOTION_PROFILE_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Motors.h"
+
+// Профиль движения между LineFollower и Motors.
+// Команда каждого колеса (-255..+255) догоняет заданную с ограничением
+// ускорения (MOTION_ACCEL / MOTION_DECEL, единиц команды в секунду)
+// и рывка (MOTION_JERK). При старте с места дополнительно работает
+// режим разгона: средняя скорость растет не быстрее launchRate, который
+// подстраивается по проскальзыванию колес (энкодеры) от старта к старту.
+class MotionProfile {
+private:
+    float command[2];   // Текущая команда колес
+    float rate[2];      // Скорость изменения команды, ед/с
+    unsigned long lastMicros;
+    
+    float accelLimit;
+    float decelLimit;
+    float jerkLimit;
+    
+    // Разгон с места
+    bool launching;
+    bool launchSlipped;        // В этом старте было проскальзывание
+    float launchCap;           // Предел средней команды, растет с launchRate
+    float launchRate;          // Темп разгона, ед/с (запоминается между стартами)
+    unsigned long launchStart;
+    
+    // Проскальзывание: предыдущий отсчет каждого колеса (по фронтам энкодера)
+    uint32_t launchMicros;     // Начало разгона: фронты раньше - от прошлого движения
+    uint32_t lastEdge[2];      // Последний учтенный фронт, micros
+    uint32_t sampleTime[2];    // Фронт последнего отсчета скорости, micros
+    float lastSpeed[2];        // мм/с
+    float wheelAccel[2];       // мм/с²
+    uint8_t launchEdges[2];    // Фронтов с начала разгона (до ENCODER_SPEED_EDGES + 1)
+    float tractionAccel;       // Наибольшее ускорение без проскальзывания, мм/с²
+    
+    float stepWheel(int side, float target, float dt);
+    void finishLaunch();
+    
+public:
+    MotionProfile();
+    
+    // Сброс в ноль (моторы остановлены или переданы торможению)
+    void reset();
+    
+    void setLimits(float accel, float decel, float jerk);
+    
+    // Начать разгон с места (вызывать при старте)
+    void startLaunch();
+    bool isLaunching() const { return launching; }
+    
+    // Следующий шаг к заданным командам; результат в -1..+1 для Motors::setSpeedNormalized
+    void update(float targetLeft, float targetRight, float& outLeft, float& outRight);
+    
+    // Скорость колеса side (мм/с) и момент фронта, по которому она посчитана
+    // (micros) - для поиска проскальзывания при разгоне. Вызывать на каждый новый фронт.
+    void onWheelSpeed(int side, float speed, uint32_t edgeTime);
+    
+    float getLaunchRate() const { return launchRate; }
+    float getTractionAccel() const { return tractionAccel; }
+};
+
+#endif // MOTION_PROFILE_H
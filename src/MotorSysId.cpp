@@ -0,0 +1,348 @@
+#include "MotorSysId.h"
+#include <Preferences.h>
+
+static const float stepLevels[] = SYSID_STEP_LEVELS;
+static const int STEP_COUNT = sizeof(stepLevels) / sizeof(stepLevels[0]);
+static_assert(sizeof(stepLevels) / sizeof(stepLevels[0]) <= SYSID_MAX_STEPS,
+              "SYSID_STEP_LEVELS длиннее SYSID_MAX_STEPS");
+
+// Шаг моделирования при уточнении по чирпу, с
+#define SYSID_SIM_DT 0.001f
+
+// Сетка уточнения: tau в долях оценки по ступенькам, delay до SYSID_MAX_DELAY
+#define SYSID_TAU_STEPS    16
+#define SYSID_DELAY_STEPS  11
+#define SYSID_MAX_DELAY    0.05f
+
+MotorSysId::MotorSysId(SysIdHardware& h)
+    : hardware(h), phase(SYSID_IDLE), stepIndex(0), chirpDone(false),
+      phaseStart(0), lastEdgeTime(0) {
+    for (int side = 0; side < 2; side++) {
+        edgeCount[side] = 0;
+        model[side].gain = 0.0;
+        model[side].tau = 0.0;
+        model[side].deadband = 0.0;
+        model[side].delay = 0.0;
+        model[side].valid = false;
+    }
+}
+
+bool MotorSysId::start() {
+    if (!hardware.hasEncoders()) return false;
+    
+    Serial.printf("⚙ Идентификация моторов: %d ступенек по %d мс и чирп %.1f-%.1f Гц\n",
+                  STEP_COUNT, SYSID_STEP_MS, SYSID_CHIRP_F0, SYSID_CHIRP_F1);
+    Serial.println("  Колеса должны быть подняты над полом!");
+    stepIndex = 0;
+    chirpDone = false;
+    startPhase(SYSID_SETTLE);
+    return true;
+}
+
+void MotorSysId::abort() {
+    if (phase == SYSID_IDLE) return;
+    hardware.coast();
+    phase = SYSID_IDLE;
+    Serial.println("✗ Идентификация моторов прервана");
+}
+
+void MotorSysId::startPhase(Phase next) {
+    phase = next;
+    phaseStart = micros();
+    lastEdgeTime = millis();
+    edgeCount[MOTOR_SIDE_LEFT] = 0;
+    edgeCount[MOTOR_SIDE_RIGHT] = 0;
+    hardware.clearEdges();
+    
+    if (next == SYSID_SETTLE) {
+        hardware.coast();
+    } else if (next == SYSID_STEP) {
+        float level = stepLevels[stepIndex];
+        hardware.setSpeedNormalized(level, level);
+    }
+}
+
+void MotorSysId::collectEdges() {
+    for (int side = 0; side < 2; side++) {
+        int room = SYSID_LOG_SIZE - edgeCount[side];
+        if (room <= 0) {
+            // Лог полон - дальнейшие фронты не нужны, но буфер энкодера освобождаем
+            uint32_t dummy[16];
+            bool moved = false;
+            while (hardware.readEdges(side, dummy, 16) > 0) moved = true;
+            if (moved) lastEdgeTime = millis();
+            continue;
+        }
+        int count = hardware.readEdges(side, edges[side] + edgeCount[side], room);
+        if (count > 0) {
+            edgeCount[side] += count;
+            lastEdgeTime = millis();
+        }
+    }
+}
+
+bool MotorSysId::update() {
+    if (phase == SYSID_IDLE) return false;
+    
+    collectEdges();
+    float elapsed = (micros() - phaseStart) / 1000000.0f;
+    
+    switch (phase) {
+        case SYSID_SETTLE: {
+            bool still = millis() - lastEdgeTime >= SYSID_SETTLE_MS;
+            if (!still && elapsed * 1000.0f < SYSID_SETTLE_TIMEOUT_MS) break;
+            
+            if (stepIndex < STEP_COUNT) {
+                startPhase(SYSID_STEP);
+            } else if (!chirpDone) {
+                startPhase(SYSID_CHIRP);
+            } else {
+                finish();
+                return false;
+            }
+            break;
+        }
+        
+        case SYSID_STEP:
+            if (elapsed * 1000.0f < SYSID_STEP_MS) break;
+            
+            analyzeStep(MOTOR_SIDE_LEFT, stepLevels[stepIndex]);
+            analyzeStep(MOTOR_SIDE_RIGHT, stepLevels[stepIndex]);
+            Serial.printf("  ступенька %.2f: L %.0f мм/с, R %.0f мм/с\n", stepLevels[stepIndex],
+                          stepSpeed[MOTOR_SIDE_LEFT][stepIndex], stepSpeed[MOTOR_SIDE_RIGHT][stepIndex]);
+            stepIndex++;
+            startPhase(SYSID_SETTLE);
+            break;
+            
+        case SYSID_CHIRP: {
+            if (elapsed * 1000.0f < SYSID_CHIRP_MS) {
+                float u = chirpCommand(elapsed);
+                hardware.setSpeedNormalized(u, u);
+                break;
+            }
+            
+            // Сначала модель по ступенькам, затем уточнение по записи чирпа
+            hardware.coast();
+            for (int side = 0; side < 2; side++) {
+                fitSteps(side);
+                refineWithChirp(side);
+            }
+            chirpDone = true;
+            
+            // Лог чирпа больше не нужен - дожидаемся остановки и завершаем
+            startPhase(SYSID_SETTLE);
+            break;
+        }
+        
+        default:
+            break;
+    }
+    return true;
+}
+
+float MotorSysId::chirpCommand(float t) const {
+    // Линейная развертка частоты: фаза = 2π (f0·t + (f1 - f0)·t² / 2T)
+    if (t < 0.0f) return 0.0f;
+    float duration = SYSID_CHIRP_MS / 1000.0f;
+    float phaseRad = 2.0f * PI * (SYSID_CHIRP_F0 * t + (SYSID_CHIRP_F1 - SYSID_CHIRP_F0) * t * t / (2.0f * duration));
+    return SYSID_CHIRP_CENTER + SYSID_CHIRP_AMPLITUDE * sinf(phaseRad);
+}
+
+void MotorSysId::analyzeStep(int side, float level) {
+    (void)level;
+    const uint32_t* e = edges[side];
+    int n = edgeCount[side];
+    
+    stepSpeed[side][stepIndex] = 0.0;
+    stepTau[side][stepIndex] = -1.0;
+    stepDelay[side][stepIndex] = -1.0;
+    if (n < 4) return;  // Колесо не сдвинулось - ниже мертвой зоны
+    
+    // Установившаяся скорость: фронты последних 30% ступеньки
+    uint32_t windowStart = phaseStart + (uint32_t)(SYSID_STEP_MS * 700UL);
+    int first = -1;
+    for (int i = 0; i < n; i++) {
+        if ((int32_t)(e[i] - windowStart) >= 0) {
+            first = i;
+            break;
+        }
+    }
+    if (first < 0 || n - 1 - first < 2) return;
+    float steady = (n - 1 - first) * MM_PER_TICK * 1000000.0f / (float)(e[n - 1] - e[first]);
+    stepSpeed[side][stepIndex] = steady;
+    
+    // Метод Смита: моменты достижения 28.3% и 63.2% установившейся скорости
+    float t28 = -1.0;
+    float t63 = -1.0;
+    for (int i = 1; i < n; i++) {
+        float v = MM_PER_TICK * 1000000.0f / (float)(e[i] - e[i - 1]);
+        float t = ((e[i] - phaseStart) + (e[i - 1] - phaseStart)) / 2000000.0f;
+        if (t28 < 0.0 && v >= 0.283f * steady) t28 = t;
+        if (v >= 0.632f * steady) {
+            t63 = t;
+            break;
+        }
+    }
+    if (t28 < 0.0 || t63 < t28) return;
+    
+    float tau = 1.5f * (t63 - t28);
+    float delay = t63 - tau;
+    stepTau[side][stepIndex] = tau;
+    stepDelay[side][stepIndex] = delay > 0.0f ? delay : 0.0f;
+}
+
+void MotorSysId::fitSteps(int side) {
+    // v = gain · (u - deadband) по ступенькам, где колесо крутилось
+    float sumU = 0.0, sumV = 0.0, sumUU = 0.0, sumUV = 0.0;
+    float sumTau = 0.0, sumDelay = 0.0;
+    int points = 0;
+    int dynamics = 0;
+    
+    for (int i = 0; i < STEP_COUNT; i++) {
+        float v = stepSpeed[side][i];
+        if (v <= 0.0) continue;
+        float u = stepLevels[i];
+        sumU += u;
+        sumV += v;
+        sumUU += u * u;
+        sumUV += u * v;
+        points++;
+        
+        if (stepTau[side][i] > 0.0) {
+            sumTau += stepTau[side][i];
+            sumDelay += stepDelay[side][i];
+            dynamics++;
+        }
+    }
+    
+    MotorModel& m = model[side];
+    m.valid = false;
+    if (points == 0 || dynamics == 0) return;
+    
+    float det = points * sumUU - sumU * sumU;
+    if (points >= 2 && det > 1e-6) {
+        float slope = (points * sumUV - sumU * sumV) / det;
+        float intercept = (sumV - slope * sumU) / points;
+        if (slope <= 0.0) return;
+        m.gain = slope;
+        m.deadband = constrain(-intercept / slope, 0.0f, 0.9f);
+    } else {
+        m.gain = sumV / sumU;
+        m.deadband = 0.0;
+    }
+    m.tau = sumTau / dynamics;
+    m.delay = sumDelay / dynamics;
+    m.valid = true;
+}
+
+float MotorSysId::chirpError(int side, float tau, float delay) const {
+    /*
+     * Моделируем ответ на тот же чирп (Эйлер, шаг 1 мс) и сравниваем со
+     * скоростями между соседними фронтами. Фронты идут по времени, поэтому
+     * модель просто догоняет очередной замер - без хранения траектории.
+     */
+    const MotorModel& m = model[side];
+    const uint32_t* e = edges[side];
+    int n = edgeCount[side];
+    
+    float v = 0.0;
+    float t = 0.0;
+    float error = 0.0;
+    
+    for (int i = 1; i < n; i++) {
+        float sampleTime = ((e[i] - phaseStart) + (e[i - 1] - phaseStart)) / 2000000.0f;
+        while (t < sampleTime) {
+            float u = chirpCommand(t - delay);
+            float drive = u > m.deadband ? m.gain * (u - m.deadband) : 0.0f;
+            v += (drive - v) * SYSID_SIM_DT / tau;
+            t += SYSID_SIM_DT;
+        }
+        float measured = MM_PER_TICK * 1000000.0f / (float)(e[i] - e[i - 1]);
+        error += (v - measured) * (v - measured);
+    }
+    return error;
+}
+
+void MotorSysId::refineWithChirp(int side) {
+    MotorModel& m = model[side];
+    if (!m.valid || edgeCount[side] < 20) return;
+    
+    float bestTau = m.tau;
+    float bestDelay = m.delay;
+    float bestError = chirpError(side, m.tau, m.delay);
+    
+    for (int i = 0; i < SYSID_TAU_STEPS; i++) {
+        float tau = m.tau * (0.5f + 1.5f * i / (SYSID_TAU_STEPS - 1));
+        if (tau < 0.005f) continue;
+        for (int j = 0; j < SYSID_DELAY_STEPS; j++) {
+            float delay = SYSID_MAX_DELAY * j / (SYSID_DELAY_STEPS - 1);
+            float error = chirpError(side, tau, delay);
+            if (error < bestError) {
+                bestError = error;
+                bestTau = tau;
+                bestDelay = delay;
+            }
+        }
+    }
+    m.tau = bestTau;
+    m.delay = bestDelay;
+}
+
+void MotorSysId::finish() {
+    phase = SYSID_IDLE;
+    hardware.coast();
+    
+    if (!model[MOTOR_SIDE_LEFT].valid || !model[MOTOR_SIDE_RIGHT].valid) {
+        Serial.println("✗ Идентификация не удалась: колесо не вращалось (проверьте питание и энкодеры)");
+        return;
+    }
+    
+    Serial.println("✓ Идентификация моторов завершена");
+    print();
+    save();
+}
+
+bool MotorSysId::load() {
+    Preferences prefs;
+    if (!prefs.begin("motor_model", true)) return false;
+    
+    bool ok = prefs.getBytesLength("model") == sizeof(model) &&
+              prefs.getBytes("model", model, sizeof(model)) == sizeof(model);
+    prefs.end();
+    return ok && model[MOTOR_SIDE_LEFT].valid && model[MOTOR_SIDE_RIGHT].valid;
+}
+
+void MotorSysId::save() const {
+    Preferences prefs;
+    if (!prefs.begin("motor_model", false)) return;
+    prefs.putBytes("model", model, sizeof(model));
+    prefs.end();
+}
+
+void MotorSysId::print() const {
+    static const char* names[2] = {"Левый", "Правый"};
+    
+    for (int side = 0; side < 2; side++) {
+        const MotorModel& m = model[side];
+        if (!m.valid) {
+            Serial.printf("  %s: модели нет\n", names[side]);
+            continue;
+        }
+        
+        /*
+         * ПИ по IMC для объекта первого порядка с запаздыванием:
+         *   Kp = tau / (K (λ + L)),  Ki = Kp / tau
+         * λ - желаемая постоянная времени контура: вдвое быстрее мотора,
+         * но не быстрее 2L. Коэффициенты - в единицах команды 0-255 на мм/с.
+         */
+        float lambda = m.tau / 2.0f;
+        if (lambda < 2.0f * m.delay) lambda = 2.0f * m.delay;
+        float kp = 255.0f * m.tau / (m.gain * (lambda + m.delay));
+        float ki = kp / m.tau;
+        
+        Serial.printf("  %s: K=%.0f мм/с, tau=%.0f мс, мертвая зона %.0f%%, задержка %.0f мс\n",
+                      names[side], m.gain, m.tau * 1000.0f, m.deadband * 100.0f, m.delay * 1000.0f);
+        Serial.printf("    SPEED_KP %.3f, SPEED_KI %.3f; упреждение: команда = %.1f + %.4f·v\n",
+                      kp, ki, 255.0f * m.deadband, 255.0f / m.gain);
+    }
+}
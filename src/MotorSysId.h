@@ -0,0 +1,100 @@
+#ifndef MOTOR_SYSID_H
+#define MOTOR_SYSID_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Motors.h"
+
+// Моторы и энкодеры для идентификации. LineFollower подставляет сюда свои
+// политики (SysIdAdapter); вызовы виртуальные, но идентификация - стендовый
+// режим, не цикл следования
+class SysIdHardware {
+public:
+    virtual ~SysIdHardware() {}
+    
+    // Есть ли метки фронтов энкодеров (без них идентификация невозможна)
+    virtual bool hasEncoders() const = 0;
+    virtual void coast() = 0;
+    virtual void setSpeedNormalized(float left, float right) = 0;
+    virtual int readEdges(int side, uint32_t* times, int maxCount) = 0;
+    virtual void clearEdges() = 0;
+};
+
+// Модель мотора первого порядка с запаздыванием и мертвой зоной:
+//   tau · dv/dt = gain · max(u - deadband, 0) - v,  u задержано на delay
+// u - команда Motors::setSpeedNormalized (0..1), v - скорость колеса, мм/с
+struct MotorModel {
+    float gain;       // мм/с на единицу команды
+    float tau;        // Постоянная времени, с
+    float deadband;   // Команда, ниже которой колесо стоит
+    float delay;      // Чистое запаздывание, с
+    bool valid;
+};
+
+// Идентификация моторов (колеса подняты над полом).
+// Ступеньки SYSID_STEP_LEVELS, затем чирп, оба мотора одновременно.
+// Скорость считается по меткам времени каждого фронта энкодера.
+// gain и deadband - МНК по установившимся скоростям ступенек,
+// tau и delay - метод Смита (28% / 63%), затем уточнение перебором
+// по ошибке модели на чирпе.
+class MotorSysId {
+private:
+    enum Phase {
+        SYSID_IDLE,
+        SYSID_SETTLE,    // Выбег до остановки колес
+        SYSID_STEP,
+        SYSID_CHIRP
+    };
+    
+    SysIdHardware& hardware;
+    
+    Phase phase;
+    int stepIndex;
+    bool chirpDone;
+    uint32_t phaseStart;        // micros
+    unsigned long lastEdgeTime; // millis
+    
+    // Метки фронтов текущей фазы
+    uint32_t edges[2][SYSID_LOG_SIZE];
+    int edgeCount[2];
+    
+    // Результаты ступенек
+    float stepSpeed[2][SYSID_MAX_STEPS];
+    float stepTau[2][SYSID_MAX_STEPS];
+    float stepDelay[2][SYSID_MAX_STEPS];
+    
+    MotorModel model[2];
+    
+    void startPhase(Phase next);
+    void collectEdges();
+    void analyzeStep(int side, float level);
+    void fitSteps(int side);
+    void refineWithChirp(int side);
+    float chirpError(int side, float tau, float delay) const;
+    float chirpCommand(float t) const;
+    void finish();
+    
+public:
+    MotorSysId(SysIdHardware& h);
+    
+    // Начать идентификацию. false - нет энкодеров
+    bool start();
+    
+    // Вызывать в каждом цикле. false - идентификация закончена
+    bool update();
+    
+    // Прервать (моторы в выбег, модель не меняется)
+    void abort();
+    
+    bool isRunning() const { return phase != SYSID_IDLE; }
+    const MotorModel& getModel(int side) const { return model[side]; }
+    
+    // Модель в NVS
+    bool load();
+    void save() const;
+    
+    // Модель и рассчитанные по ней коэффициенты регулятора скорости
+    void print() const;
+};
+
+#endif // MOTOR_SYSID_H
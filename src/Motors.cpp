@@ -1,54 +1,187 @@
 #include "Motors.h"
 
+#define MOTOR_PWM_MAX  ((1 << MOTOR_PWM_BITS) - 1)
+
+static_assert((80000000UL / MOTOR_PWM_FREQ) >= (1UL << MOTOR_PWM_BITS),
+              "MOTOR_PWM_BITS слишком велико для MOTOR_PWM_FREQ (APB 80 МГц)");
+
+// Каналы LEDC по пинам
+#define CH_LEFT_FWD   (MOTOR_PWM_CHANNEL + 0)
+#define CH_LEFT_BWD   (MOTOR_PWM_CHANNEL + 1)
+#define CH_RIGHT_FWD  (MOTOR_PWM_CHANNEL + 2)
+#define CH_RIGHT_BWD  (MOTOR_PWM_CHANNEL + 3)
+
+static const uint8_t leftCurve[MOTOR_CURVE_POINTS] = MOTOR_LEFT_CURVE;
+static const uint8_t rightCurve[MOTOR_CURVE_POINTS] = MOTOR_RIGHT_CURVE;
+
 Motors::Motors() {
+    buildTable(MOTOR_SIDE_LEFT, leftCurve);
+    buildTable(MOTOR_SIDE_RIGHT, rightCurve);
+    for (int i = 0; i < 4; i++) {
+        lastDuty[i] = 0xFFFF;  // Первая запись всегда проходит
+    }
+    lastForward[MOTOR_SIDE_LEFT] = true;
+    lastForward[MOTOR_SIDE_RIGHT] = true;
+    pulseActive = false;
+    pulseEndTime = 0;
+    pulseHoldStrength = 255;
+    supplyScale = 1.0f;
 }
 
 void Motors::begin() {
-    pinMode(MOTOR_LEFT_FWD, OUTPUT);
-    pinMode(MOTOR_LEFT_BWD, OUTPUT);
-    pinMode(MOTOR_RIGHT_FWD, OUTPUT);
-    pinMode(MOTOR_RIGHT_BWD, OUTPUT);
+    ledcSetup(CH_LEFT_FWD, MOTOR_PWM_FREQ, MOTOR_PWM_BITS);
+    ledcSetup(CH_LEFT_BWD, MOTOR_PWM_FREQ, MOTOR_PWM_BITS);
+    ledcSetup(CH_RIGHT_FWD, MOTOR_PWM_FREQ, MOTOR_PWM_BITS);
+    ledcSetup(CH_RIGHT_BWD, MOTOR_PWM_FREQ, MOTOR_PWM_BITS);
+    
+    ledcAttachPin(MOTOR_LEFT_FWD, CH_LEFT_FWD);
+    ledcAttachPin(MOTOR_LEFT_BWD, CH_LEFT_BWD);
+    ledcAttachPin(MOTOR_RIGHT_FWD, CH_RIGHT_FWD);
+    ledcAttachPin(MOTOR_RIGHT_BWD, CH_RIGHT_BWD);
     
     stop();
 }
 
-void Motors::setSpeed(int leftSpeed, int rightSpeed) {
+void Motors::buildTable(int side, const uint8_t* curvePercent) {
     /*
-     * Устанавливает скорость моторов через ШИМ на пинах INx
-     * Так как ENA/ENB припаяны к HIGH, используем ШИМ на IN1/IN3 для скорости
+     * Команда 1..255 линейно отображается на отрезки калибровочной кривой
+     * (8 отрезков по 12.5% скорости), результат - в отсчеты ШИМ.
+     * Команда 0 - всегда 0 (стоп), без мертвой зоны.
      */
+    lut[side][0] = 0;
+    for (int command = 1; command < 256; command++) {
+        float x = command * (MOTOR_CURVE_POINTS - 1) / 255.0f;
+        int segment = (int)x;
+        if (segment >= MOTOR_CURVE_POINTS - 1) segment = MOTOR_CURVE_POINTS - 2;
+        float t = x - segment;
+        float percent = curvePercent[segment] + t * (curvePercent[segment + 1] - curvePercent[segment]);
         
-    // Левый мотор
-    if (leftSpeed >= 0) {
-        analogWrite(MOTOR_LEFT_FWD, leftSpeed);
-        digitalWrite(MOTOR_LEFT_BWD, LOW);
+        int duty = (int)(percent * MOTOR_PWM_MAX / 100.0f + 0.5f);
+        lut[side][command] = (uint16_t)constrain(duty, 0, MOTOR_PWM_MAX);
+    }
+}
+
+void Motors::setCalibration(int side, const uint8_t* curvePercent) {
+    if (side != MOTOR_SIDE_LEFT && side != MOTOR_SIDE_RIGHT) return;
+    buildTable(side, curvePercent);
+}
+
+void Motors::setSupplyScale(float scale) {
+    supplyScale = constrain(scale, 0.5f, 2.0f);
+}
+
+uint16_t Motors::scaleDuty(uint16_t duty) const {
+    // На севшей батарее та же команда дает то же среднее напряжение на моторе,
+    // пока хватает запаса до 100%
+    if (supplyScale == 1.0f || duty == 0) return duty;
+    int scaled = (int)(duty * supplyScale + 0.5f);
+    return (uint16_t)constrain(scaled, 0, MOTOR_PWM_MAX);
+}
+
+void Motors::writeChannel(int channel, uint16_t duty) {
+    // Регистры LEDC пишем только при изменении
+    int index = channel - MOTOR_PWM_CHANNEL;
+    if (lastDuty[index] == duty) return;
+    lastDuty[index] = duty;
+    ledcWrite(channel, duty);
+}
+
+void Motors::writeMotor(int fwdChannel, int bwdChannel, uint16_t duty, bool forward) {
+    /*
+     * ENA/ENB припаяны к HIGH, скорость задается ШИМ на одном из INx,
+     * второй пин держим в 0 (тоже через LEDC, без digitalWrite)
+     */
+    if (forward) {
+        writeChannel(bwdChannel, 0);
+        writeChannel(fwdChannel, duty);
     } else {
-        digitalWrite(MOTOR_LEFT_FWD, LOW);
-        analogWrite(MOTOR_LEFT_BWD, -leftSpeed);
+        writeChannel(fwdChannel, 0);
+        writeChannel(bwdChannel, duty);
     }
+}
+
+void Motors::setSpeed(int leftSpeed, int rightSpeed) {
+    leftSpeed = constrain(leftSpeed, -255, 255);
+    rightSpeed = constrain(rightSpeed, -255, 255);
+    pulseActive = false;
+    if (leftSpeed != 0) lastForward[MOTOR_SIDE_LEFT] = leftSpeed > 0;
+    if (rightSpeed != 0) lastForward[MOTOR_SIDE_RIGHT] = rightSpeed > 0;
     
-    // Правый мотор
-    if (rightSpeed >= 0) {
-        analogWrite(MOTOR_RIGHT_FWD, rightSpeed);
-        digitalWrite(MOTOR_RIGHT_BWD, LOW);
-    } else {
-        digitalWrite(MOTOR_RIGHT_FWD, LOW);
-        analogWrite(MOTOR_RIGHT_BWD, -rightSpeed);
+    writeMotor(CH_LEFT_FWD, CH_LEFT_BWD, scaleDuty(lut[MOTOR_SIDE_LEFT][abs(leftSpeed)]), leftSpeed >= 0);
+    writeMotor(CH_RIGHT_FWD, CH_RIGHT_BWD, scaleDuty(lut[MOTOR_SIDE_RIGHT][abs(rightSpeed)]), rightSpeed >= 0);
+}
+
+void Motors::setSpeedNormalized(float left, float right) {
+    // Интерполяция между соседними точками таблицы
+    float speeds[2] = {constrain(left, -1.0f, 1.0f), constrain(right, -1.0f, 1.0f)};
+    uint16_t duty[2];
+    pulseActive = false;
+    
+    for (int side = 0; side < 2; side++) {
+        if (speeds[side] != 0.0f) lastForward[side] = speeds[side] > 0.0f;
+        float x = fabsf(speeds[side]) * 255.0f;
+        int index = (int)x;
+        if (x <= 0.0f) {
+            duty[side] = 0;
+        } else if (index >= 255) {
+            duty[side] = lut[side][255];
+        } else if (index == 0) {
+            duty[side] = lut[side][1];  // Ниже первого шага - порог мертвой зоны
+        } else {
+            float t = x - index;
+            duty[side] = (uint16_t)(lut[side][index] + t * (lut[side][index + 1] - lut[side][index]) + 0.5f);
+        }
     }
+    
+    writeMotor(CH_LEFT_FWD, CH_LEFT_BWD, scaleDuty(duty[MOTOR_SIDE_LEFT]), speeds[MOTOR_SIDE_LEFT] >= 0.0f);
+    writeMotor(CH_RIGHT_FWD, CH_RIGHT_BWD, scaleDuty(duty[MOTOR_SIDE_RIGHT]), speeds[MOTOR_SIDE_RIGHT] >= 0.0f);
 }
 
 void Motors::stop() {
-    // Полная остановка - сначала отключаем ШИМ, потом все пины в LOW
-    analogWrite(MOTOR_LEFT_FWD, 0);
-    analogWrite(MOTOR_LEFT_BWD, 0);
-    analogWrite(MOTOR_RIGHT_FWD, 0);
-    analogWrite(MOTOR_RIGHT_BWD, 0);
+    coast();
+}
+
+void Motors::coast() {
+    // Скважность 0 на всех INx - мост закрыт, свободный выбег
+    pulseActive = false;
+    writeChannel(CH_LEFT_FWD, 0);
+    writeChannel(CH_LEFT_BWD, 0);
+    writeChannel(CH_RIGHT_FWD, 0);
+    writeChannel(CH_RIGHT_BWD, 0);
+}
+
+void Motors::brake(int strength) {
+    /*
+     * L298N: IN1 = IN2 = 1 замыкает обмотку через верхние ключи.
+     * Одинаковый ШИМ на обоих входах чередует замыкание и выбег
+     * (каналы одного таймера синхронны). Без таблицы калибровки -
+     * мертвой зоны у торможения нет.
+     */
+    pulseActive = false;
+    uint16_t duty = (uint16_t)((constrain(strength, 0, 255) * (uint32_t)MOTOR_PWM_MAX) / 255);
+    writeChannel(CH_LEFT_FWD, duty);
+    writeChannel(CH_LEFT_BWD, duty);
+    writeChannel(CH_RIGHT_FWD, duty);
+    writeChannel(CH_RIGHT_BWD, duty);
+}
+
+void Motors::reversePulse(int strength, uint16_t durationMs, int holdStrength) {
+    uint16_t duty = (uint16_t)((constrain(strength, 0, 255) * (uint32_t)MOTOR_PWM_MAX) / 255);
+    
+    // Против последнего направления; калибровка не нужна - ток максимальный
+    writeMotor(CH_LEFT_FWD, CH_LEFT_BWD, duty, !lastForward[MOTOR_SIDE_LEFT]);
+    writeMotor(CH_RIGHT_FWD, CH_RIGHT_BWD, duty, !lastForward[MOTOR_SIDE_RIGHT]);
     
-    // Затем явно устанавливаем LOW
-    digitalWrite(MOTOR_LEFT_FWD, LOW);
-    digitalWrite(MOTOR_LEFT_BWD, LOW);
-    digitalWrite(MOTOR_RIGHT_FWD, LOW);
-    digitalWrite(MOTOR_RIGHT_BWD, LOW);
+    pulseActive = true;
+    pulseEndTime = millis() + durationMs;
+    pulseHoldStrength = (uint8_t)constrain(holdStrength, 0, 255);
+}
+
+void Motors::update() {
+    if (pulseActive && (long)(millis() - pulseEndTime) >= 0) {
+        // Импульс закончен - удерживаем торможением, чтобы не уехать назад
+        brake(pulseHoldStrength);
+    }
 }
 
 void Motors::moveForward(int speed) {
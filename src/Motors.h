@@ -4,8 +4,38 @@
 #include <Arduino.h>
 #include "Config.h"
 
+// Индексы моторов для калибровки
+#define MOTOR_SIDE_LEFT   0
+#define MOTOR_SIDE_RIGHT  1
+
 // Класс для управления моторами
+// ШИМ на пинах INx через каналы LEDC (MOTOR_PWM_FREQ, MOTOR_PWM_BITS).
+// Команда скорости проходит через таблицу калибровки каждого мотора,
+// которая убирает мертвую зону и выравнивает нелинейность.
 class Motors {
+private:
+    // Команда 0..255 → скважность 0..MOTOR_PWM_MAX для каждого мотора
+    uint16_t lut[2][256];
+    
+    // Последняя записанная скважность каждого канала (IN1..IN4)
+    uint16_t lastDuty[4];
+    
+    // Направление последней команды каждого мотора (для импульса реверса)
+    bool lastForward[2];
+    
+    // Импульс реверса: до этого момента, затем торможение
+    bool pulseActive;
+    unsigned long pulseEndTime;
+    uint8_t pulseHoldStrength;
+    
+    // Компенсация напряжения питания (1.0 - номинал)
+    float supplyScale;
+    
+    uint16_t scaleDuty(uint16_t duty) const;
+    void buildTable(int side, const uint8_t* curvePercent);
+    void writeChannel(int channel, uint16_t duty);
+    void writeMotor(int fwdChannel, int bwdChannel, uint16_t duty, bool forward);
+    
 public:
     Motors();
     
@@ -15,9 +45,37 @@ public:
     // Установить скорость моторов (от -255 до +255)
     void setSpeed(int leftSpeed, int rightSpeed);
     
-    // Остановка моторов
+    // Установить скорость в долях (от -1.0 до +1.0) - без округления до 255 шагов,
+    // для регуляторов скорости
+    void setSpeedNormalized(float left, float right);
+    
+    // Заменить калибровку мотора (MOTOR_CURVE_POINTS значений в %)
+    void setCalibration(int side, const uint8_t* curvePercent);
+    
+    // Множитель скважности для ходовых команд (BATTERY_NOMINAL_V / напряжение).
+    // Торможение и импульс реверса не масштабируются.
+    void setSupplyScale(float scale);
+    
+    // Остановка моторов (выбег)
     void stop();
     
+    // Выбег: все INx в 0, моторы отключены
+    void coast();
+    
+    // Торможение замыканием обмоток: оба INx мотора в 1.
+    // strength 0..255 - доля времени замыкания (255 - постоянно)
+    void brake(int strength = 255);
+    
+    // Импульс реверса против последнего направления каждого мотора
+    // на durationMs, затем торможение с силой holdStrength.
+    // Любая другая команда прерывает импульс.
+    void reversePulse(int strength, uint16_t durationMs, int holdStrength = 255);
+    
+    // Вызывать в каждом цикле: завершает импульс реверса по времени
+    void update();
+    
+    bool isPulsing() const { return pulseActive; }
+    
     // Движение вперед
     void moveForward(int speed);
     
@@ -0,0 +1,70 @@
+#include "Profiler.h"
+
+const char* profileStageName(ProfileStage stage) {
+    switch (stage) {
+        case PROF_UPDATE:       return "update";
+        case PROF_ENCODERS:     return "encoders";
+        case PROF_SENSORS_READ: return "sensors.read";
+        case PROF_POSITION:     return "position";
+        case PROF_PID:          return "pid";
+        case PROF_STEER:        return "steer";
+        case PROF_MOTORS:       return "motors";
+        default:                return "?";
+    }
+}
+
+#ifdef USE_PROFILER
+
+ProfileStats Profiler::stats[PROF_STAGE_COUNT];
+
+uint32_t Profiler::cyclesPerMicrosecond() {
+#if defined(__XTENSA__)
+    return getCpuFrequencyMhz();
+#else
+    return 1000;  // Наносекунды
+#endif
+}
+
+void Profiler::record(ProfileStage stage, uint32_t elapsed) {
+    ProfileStats& s = stats[stage];
+
+    if (s.count == 0 || elapsed < s.minCycles) s.minCycles = elapsed;
+    if (elapsed > s.maxCycles) s.maxCycles = elapsed;
+    s.totalCycles += elapsed;
+    s.count++;
+
+    // log2 длительности - номер старшего бита
+    int bucket = elapsed ? 31 - __builtin_clz(elapsed) : 0;
+    s.histogram[bucket]++;
+}
+
+void Profiler::reset() {
+    memset(stats, 0, sizeof(stats));
+}
+
+void Profiler::print() {
+    float perUs = (float)cyclesPerMicrosecond();
+
+    Serial.printf("[PROF] Этапы цикла, мкс (%lu тактов/мкс):\n", (unsigned long)cyclesPerMicrosecond());
+    for (int i = 0; i < PROF_STAGE_COUNT; i++) {
+        const ProfileStats& s = stats[i];
+        if (s.count == 0) continue;
+
+        Serial.printf("  %-13s n=%-7lu min %7.2f  mean %7.2f  max %8.2f\n",
+                      profileStageName((ProfileStage)i), (unsigned long)s.count,
+                      s.minCycles / perUs, (float)s.totalCycles / s.count / perUs,
+                      s.maxCycles / perUs);
+
+        // Гистограмма: верхняя граница корзины и число замеров
+        for (int b = 0; b < PROFILER_BUCKETS; b++) {
+            if (s.histogram[b] == 0) continue;
+            float upper = (float)(2.0 * (1UL << b)) / perUs;
+            int bar = (int)(40UL * s.histogram[b] / s.count);
+            Serial.printf("    < %9.2f: %-7lu ", upper, (unsigned long)s.histogram[b]);
+            for (int k = 0; k < bar; k++) Serial.print('#');
+            Serial.println();
+        }
+    }
+}
+
+#endif // USE_PROFILER
@@ -0,0 +1,95 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// Этапы цикла управления, которые замеряет профайлер
+enum ProfileStage {
+    PROF_UPDATE,         // LineFollower::update() целиком
+    PROF_ENCODERS,       // encoders->update()
+    PROF_SENSORS_READ,   // sensors.read()
+    PROF_POSITION,       // sensors.calculatePosition()
+    PROF_PID,            // pid.calculate()
+    PROF_STEER,          // Геометрическое руление (pure pursuit / Stanley)
+    PROF_MOTORS,         // Профиль движения + motors.setSpeedNormalized()
+    PROF_STAGE_COUNT
+};
+
+#ifdef USE_PROFILER
+
+#if !defined(__XTENSA__)
+#include <chrono>
+#endif
+
+// Корзины гистограммы: корзина k - длительность [2^k, 2^(k+1)) тактов
+#define PROFILER_BUCKETS 32
+
+// Статистика одного этапа
+struct ProfileStats {
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t histogram[PROFILER_BUCKETS];
+};
+
+// Профайлер по счетчику тактов CCOUNT.
+// Замеры и печать - только из задачи робота (одно ядро, свой CCOUNT),
+// поэтому без блокировок.
+class Profiler {
+private:
+    static ProfileStats stats[PROF_STAGE_COUNT];
+
+public:
+    // Текущее значение счетчика тактов. На хосте (без Xtensa) - наносекунды
+    static inline uint32_t cycles() {
+#if defined(__XTENSA__)
+        uint32_t ccount;
+        __asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+        return ccount;
+#else
+        return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // Тактов в микросекунде
+    static uint32_t cyclesPerMicrosecond();
+
+    // Учесть один замер этапа
+    static void record(ProfileStage stage, uint32_t elapsed);
+
+    // Обнулить статистику
+    static void reset();
+
+    // Вывод min/mean/max и гистограммы по всем этапам в Serial
+    static void print();
+};
+
+// Замер от конструктора до выхода из блока
+class ProfileScope {
+private:
+    ProfileStage stage;
+    uint32_t start;
+
+public:
+    explicit ProfileScope(ProfileStage s) : stage(s), start(Profiler::cycles()) {}
+    ~ProfileScope() { Profiler::record(stage, Profiler::cycles() - start); }
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b)  PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(stage)  ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(stage)
+
+#else
+
+// Профайлер выключен - замеры не компилируются
+#define PROFILE_SCOPE(stage)  do {} while (0)
+
+#endif // USE_PROFILER
+
+// Имя этапа для вывода
+const char* profileStageName(ProfileStage stage);
+
+#endif // PROFILER_H
@@ -0,0 +1,58 @@
+#ifndef ROBOT_CONFIG_H
+#define ROBOT_CONFIG_H
+
+#include "Config.h"
+#include "LineFollower.h"
+#include "Motors.h"
+#include "Encoders.h"
+#include "TelemetrySink.h"
+
+#if defined(USE_LINE_FUSION)
+#include "FusedLineSource.h"
+#elif defined(USE_CAMERA_LINK)
+#include "CameraLineSource.h"
+#else
+#include "Sensors.h"
+#endif
+#ifdef USE_BLACKBOX
+#include "BlackBox.h"
+#endif
+#ifdef USE_TELEMETRY
+#include "Telemetry.h"
+#endif
+
+// ═══════════════════════════════════════════════════════════════════════════
+// ПОЛИТИКИ LineFollower ПО НАСТРОЙКАМ Config.h
+// Единственное место, где USE_* выбирают типы; дальше код их не проверяет
+// ═══════════════════════════════════════════════════════════════════════════
+
+// Скорость колес и путь
+#ifdef USE_ENCODERS
+typedef Encoders RobotEncoders;
+#else
+typedef NoEncoders RobotEncoders;
+#endif
+
+// Источник позиции линии
+#if defined(USE_LINE_FUSION)
+typedef FusedLineSource<RobotEncoders> RobotLineSource;  // Камера + TCRT5000
+#elif defined(USE_CAMERA_LINK)
+typedef CameraLineSource RobotLineSource;   // ESP32-CAM по UART
+#else
+typedef LineSensors RobotLineSource;        // Массив TCRT5000
+#endif
+
+// Куда уходят записи состояния
+#if defined(USE_BLACKBOX) && defined(USE_TELEMETRY)
+typedef TelemetryPair<BlackBox, Telemetry> RobotTelemetry;
+#elif defined(USE_BLACKBOX)
+typedef BlackBox RobotTelemetry;
+#elif defined(USE_TELEMETRY)
+typedef Telemetry RobotTelemetry;
+#else
+typedef NullTelemetry RobotTelemetry;
+#endif
+
+typedef BasicLineFollower<RobotLineSource, Motors, RobotEncoders, RobotTelemetry> LineFollower;
+
+#endif // ROBOT_CONFIG_H
@@ -1,6 +1,25 @@
 #include "Sensors.h"
 
-LineSensors::LineSensors() : lastKnownPosition(-999), lastPositionTime(0) {
+// Фронты датчиков из прерываний
+volatile SensorEdge LineSensors::edges[SENSOR_EDGE_BUFFER];
+volatile uint32_t LineSensors::edgeHead = 0;
+volatile uint32_t LineSensors::lastEdgeUs[5] = {0, 0, 0, 0, 0};
+portMUX_TYPE LineSensors::edgeMux = portMUX_INITIALIZER_UNLOCKED;
+
+#define SENSOR_EDGE_MASK (SENSOR_EDGE_BUFFER - 1)
+static_assert((SENSOR_EDGE_BUFFER & SENSOR_EDGE_MASK) == 0, "SENSOR_EDGE_BUFFER - степень двойки");
+
+// Пины в DRAM - читаются из прерывания
+static DRAM_ATTR const uint8_t sensorPins[5] = {SENSOR_1, SENSOR_2, SENSOR_3, SENSOR_4, SENSOR_5};
+
+// Поперечная координата датчика (мм, + вправо)
+static inline float sensorX(int index) {
+    return (index - 2) * SENSOR_SPACING;
+}
+
+LineSensors::LineSensors()
+    : lastKnownPosition(-999), lastPositionTime(0), edgeTail(0), lineMask(0),
+      haveAnchor(false), anchorPosition(0.0), anchorTime(0), anchorInterval(0.0), lateralRate(0.0) {
     // Инициализация массивов калибровки
     for(int i = 0; i < 5; i++) {
         sensorMin[i] = 0;
@@ -14,9 +33,53 @@ void LineSensors::begin() {
     pinMode(SENSOR_3, INPUT);
     pinMode(SENSOR_4, INPUT);
     pinMode(SENSOR_5, INPUT);
+    
+#ifdef USE_SENSOR_EDGES
+    // Начальные уровни, дальше их ведут фронты
+    lineMask = 0;
+    for (int i = 0; i < 5; i++) {
+        if (digitalRead(sensorPins[i]) == LOW) lineMask |= 1 << i;
+    }
+    edgeTail = edgeHead;
+    
+    for (int i = 0; i < 5; i++) {
+        attachInterruptArg(sensorPins[i], edgeISR, (void*)(uintptr_t)i, CHANGE);
+    }
+#endif
+}
+
+void IRAM_ATTR LineSensors::edgeISR(void* arg) {
+    uint8_t index = (uint8_t)(uintptr_t)arg;
+    uint32_t now = micros();
+    
+    // TCRT5000 на пороге компаратора дребезжит: фронты одного датчика чаще
+    // SENSOR_EDGE_MIN_US не пишем, чтобы пачка не забила буфер и ядро 1.
+    // Уровень после отброшенного фронта подхватывает processEdges()
+    if (now - lastEdgeUs[index] < SENSOR_EDGE_MIN_US) return;
+    lastEdgeUs[index] = now;
+    
+    uint8_t level = digitalRead(sensorPins[index]);
+    
+    // Пять прерываний пишут в один буфер
+    portENTER_CRITICAL_ISR(&edgeMux);
+    volatile SensorEdge& edge = edges[edgeHead & SENSOR_EDGE_MASK];
+    edge.time = now;
+    edge.sensor = index;
+    edge.level = level;
+    edgeHead = edgeHead + 1;
+    portEXIT_CRITICAL_ISR(&edgeMux);
 }
 
 void LineSensors::read(int sensors[5]) {
+#ifdef USE_SENSOR_EDGES
+    // Текущие уровни плюс датчики, видевшие линию хотя бы на миг с прошлого чтения
+    uint8_t seenMask = 0;
+    processEdges(seenMask);
+    uint8_t mask = lineMask | seenMask;
+    for (int i = 0; i < 5; i++) {
+        sensors[i] = (mask & (1 << i)) ? 0 : 1;
+    }
+#else
     // Чтение цифровых значений с датчиков
     // 0 = черная линия (LOW), 1 = белое поле (HIGH)
     sensors[0] = digitalRead(SENSOR_1);
@@ -24,6 +87,160 @@ void LineSensors::read(int sensors[5]) {
     sensors[2] = digitalRead(SENSOR_3);
     sensors[3] = digitalRead(SENSOR_4);
     sensors[4] = digitalRead(SENSOR_5);
+#endif
+}
+
+void LineSensors::processEdges(uint8_t& seenMask) {
+    SensorEdge batch[SENSOR_EDGE_BUFFER];
+    int count = 0;
+    
+    portENTER_CRITICAL(&edgeMux);
+    uint32_t head = edgeHead;
+    if (head - edgeTail > SENSOR_EDGE_BUFFER) {
+        edgeTail = head - SENSOR_EDGE_BUFFER;  // Переполнение - старые фронты потеряны
+    }
+    while (edgeTail != head) {
+        volatile SensorEdge& edge = edges[edgeTail & SENSOR_EDGE_MASK];
+        batch[count].time = edge.time;
+        batch[count].sensor = edge.sensor;
+        batch[count].level = edge.level;
+        count++;
+        edgeTail++;
+    }
+    portEXIT_CRITICAL(&edgeMux);
+    
+    for (int i = 0; i < count; i++) {
+        uint8_t bit = 1 << batch[i].sensor;
+        bool onLine = batch[i].level == LOW;
+        if (onLine) seenMask |= bit;
+        
+        // Дребезг компаратора дает повторы уровня - край линии не сдвинулся
+        if (onLine == ((lineMask & bit) != 0)) continue;
+        
+        if (onLine) {
+            lineMask |= bit;
+        } else {
+            lineMask &= ~bit;
+        }
+        addAnchor(batch[i].sensor, onLine, batch[i].time);
+    }
+    
+    // Последний фронт пачки дребезга мог быть отброшен - после затишья
+    // сверяем уровни с выводами, фронт считаем в начале пачки
+    uint32_t now = micros();
+    for (int i = 0; i < 5; i++) {
+        uint32_t edgeTime = lastEdgeUs[i];
+        if (now - edgeTime < SENSOR_EDGE_MIN_US) continue;
+        
+        uint8_t bit = 1 << i;
+        bool onLine = digitalRead(sensorPins[i]) == LOW;
+        if (onLine == ((lineMask & bit) != 0)) continue;
+        
+        if (onLine) {
+            lineMask |= bit;
+            seenMask |= bit;
+        } else {
+            lineMask &= ~bit;
+        }
+        addAnchor(i, onLine, edgeTime);
+    }
+}
+
+void LineSensors::addAnchor(int sensor, bool onLine, uint32_t time) {
+    /*
+     * В момент фронта край линии ровно над датчиком: центр линии на
+     * половину ширины в ту сторону, где остальные датчики на линии
+     * (или откуда линия пришла / куда ушла, если других нет)
+     */
+    float x = sensorX(sensor);
+    float left = 0.0, right = 0.0;
+    for (int i = 0; i < 5; i++) {
+        if (i == sensor || !(lineMask & (1 << i))) continue;
+        if (i < sensor) left += 1.0;
+        else right += 1.0;
+    }
+    
+    float side;
+    if (right > left) {
+        side = 1.0;
+    } else if (left > right) {
+        side = -1.0;
+    } else if (haveAnchor) {
+        side = anchorPosition >= x ? 1.0 : -1.0;
+    } else {
+        return;  // Сторону не определить - ждем следующего фронта
+    }
+    
+    float position = x + side * LINE_WIDTH_MM / 2.0;
+    
+    // Поперечная скорость линии по двум соседним опорным точкам.
+    // Направление знаем по типу фронта: линия наезжает на датчик -
+    // центр идет к нему, съезжает - от него. Если тот же край вернулся
+    // на тот же датчик (линия развернулась), модуль берем прошлый.
+    if (haveAnchor) {
+        float dt = (time - anchorTime) / 1000000.0;
+        if (dt > 0.0005 && dt < SENSOR_EDGE_EXTRAPOLATE_MS / 1000.0) {
+            float direction = onLine ? -side : side;
+            float speed = fabs(position - anchorPosition) / dt;
+            if (speed == 0.0) speed = fabs(lateralRate);
+            lateralRate = direction * constrain(speed, 0.0f, (float)SENSOR_EDGE_MAX_RATE);
+            anchorInterval = dt;
+        } else {
+            lateralRate = 0.0;
+            anchorInterval = 0.0;
+        }
+    }
+    
+    anchorPosition = position;
+    anchorTime = time;
+    haveAnchor = true;
+}
+
+float LineSensors::estimatePosition(uint8_t mask) {
+    /*
+     * Допустимый интервал центра линии по текущей картине:
+     * до каждого датчика на линии не дальше W/2, до соседних
+     * датчиков вне линии - дальше W/2
+     */
+    const float half = LINE_WIDTH_MM / 2.0;
+    float lo = -1000.0, hi = 1000.0;
+    int covered = 0;
+    float centroid = 0.0;
+    
+    for (int i = 0; i < 5; i++) {
+        if (mask & (1 << i)) {
+            if (sensorX(i) - half > lo) lo = sensorX(i) - half;
+            if (sensorX(i) + half < hi) hi = sensorX(i) + half;
+            centroid += sensorX(i);
+            covered++;
+        }
+    }
+    if (covered == 0) return -999;
+    centroid /= covered;
+    
+    for (int i = 0; i < 5; i++) {
+        if (mask & (1 << i)) continue;
+        if (sensorX(i) > centroid) {
+            if (sensorX(i) - half < hi) hi = sensorX(i) - half;
+        } else {
+            if (sensorX(i) + half > lo) lo = sensorX(i) + half;
+        }
+    }
+    
+    // Несовместимая картина (короткое касание, дребезг) - просто центр масс
+    if (lo > hi) return centroid;
+    
+    float estimate = (lo + hi) / 2.0;
+    if (haveAnchor && anchorInterval > 0.0) {
+        // Продолжаем движение от последнего фронта, но не за пределы интервала.
+        // Следующий фронт не пришел за 2.5 прошлых промежутка - линия
+        // остановилась или повернула, остается середина интервала.
+        float dt = (micros() - anchorTime) / 1000000.0;
+        if (dt <= 2.5 * anchorInterval) {
+            estimate = constrain(anchorPosition + lateralRate * dt, lo, hi);
+        }
+    }
+    return estimate;
 }
 
 float LineSensors::calculatePosition(int sensors[5]) {
@@ -33,6 +250,19 @@ float LineSensors::calculatePosition(int sensors[5]) {
      * Возврат: -2.0 ... +2.0 - позиция линии, -999 - линия не найдена
      */
     
+#ifdef USE_SENSOR_EDGES
+    // Позиция по фронтам: точнее центра масс на 5 дискретных точках
+    uint8_t mask = 0;
+    for (int i = 0; i < 5; i++) {
+        if (sensors[i] == 0) mask |= 1 << i;
+    }
+    float edgePosition = estimatePosition(mask);
+    if (edgePosition == -999) return -999;
+    
+    lastKnownPosition = constrain(edgePosition / SENSOR_SPACING, -2.0f, 2.0f);
+    lastPositionTime = millis();
+    return lastKnownPosition;
+#else
     int weights[5] = {-2, -1, 0, 1, 2};
     int lineValues[5];
     
@@ -63,6 +293,7 @@ float LineSensors::calculatePosition(int sensors[5]) {
     lastPositionTime = millis();
     
     return position;
+#endif
 }
 
 void LineSensors::calibrate() {
@@ -99,4 +330,7 @@ void LineSensors::calibrate() {
 void LineSensors::resetPositionMemory() {
     lastKnownPosition = -999;
     lastPositionTime = 0;
+    haveAnchor = false;
+    anchorInterval = 0.0;
+    lateralRate = 0.0;
 }
@@ -3,9 +3,25 @@
 
 #include <Arduino.h>
 #include "Config.h"
+#include "LineSource.h"
+
+// Кольцевой буфер фронтов датчиков (степень двойки)
+#define SENSOR_EDGE_BUFFER 64
+
+// Фронт датчика: момент, номер (0-4), новый уровень (0 = линия)
+struct SensorEdge {
+    uint32_t time;   // micros()
+    uint8_t sensor;
+    uint8_t level;
+};
 
 // Класс для работы с датчиками линии
-class LineSensors {
+// С USE_SENSOR_EDGES каждый фронт датчика ловится прерыванием с меткой
+// времени. read() видит и короткие касания линии между циклами, а позиция
+// строится по моментам пересечения краем линии каждого датчика: край
+// линии в момент фронта известен точно, между фронтами положение
+// продлевается с измеренной поперечной скоростью.
+class LineSensors final : public LineSource {
 private:
     int sensorMin[5];
     int sensorMax[5];
@@ -14,29 +30,54 @@ private:
     float lastKnownPosition;
     unsigned long lastPositionTime;  // Время последнего обнаружения линии
     
+    // Фронты из прерываний (один буфер на пять датчиков)
+    static volatile SensorEdge edges[SENSOR_EDGE_BUFFER];
+    static volatile uint32_t edgeHead;
+    static volatile uint32_t lastEdgeUs[5];  // Последний записанный фронт датчика (антидребезг)
+    static portMUX_TYPE edgeMux;
+    uint32_t edgeTail;
+    
+    // Уровни датчиков по последнему обработанному фронту (бит = 1 - линия)
+    uint8_t lineMask;
+    
+    // Опорные точки: центр линии (мм) в моменты двух последних фронтов
+    bool haveAnchor;
+    float anchorPosition;
+    uint32_t anchorTime;
+    float anchorInterval;    // Время между двумя последними фронтами, с
+    float lateralRate;       // мм/с
+    
+    static void IRAM_ATTR edgeISR(void* arg);
+    void processEdges(uint8_t& seenMask);
+    void addAnchor(int sensor, bool onLine, uint32_t time);
+    float estimatePosition(uint8_t mask);
+    
 public:
+    // Статические буферы прерываний (не входят в sizeof объекта)
+    static const uint32_t staticBytes = sizeof(edges) + sizeof(edgeHead) + sizeof(lastEdgeUs);
+    
     LineSensors();
     
     // Инициализация датчиков
-    void begin();
+    void begin() override;
     
     // Чтение значений с датчиков
-    void read(int sensors[5]);
+    void read(int sensors[5]) override;
     
     // Вычисление позиции линии (-2.0 до +2.0, или -999 если не найдена)
-    float calculatePosition(int sensors[5]);
+    float calculatePosition(int sensors[5]) override;
     
     // Калибровка датчиков
-    void calibrate();
+    void calibrate() override;
     
     // Получить последнюю известную позицию линии
-    float getLastKnownPosition() const { return lastKnownPosition; }
+    float getLastKnownPosition() const override { return lastKnownPosition; }
     
     // Получить время последнего обнаружения линии (мс)
-    unsigned long getLastPositionTime() const { return lastPositionTime; }
+    unsigned long getLastPositionTime() const override { return lastPositionTime; }
     
     // Сбросить память позиции
-    void resetPositionMemory();
+    void resetPositionMemory() override;
     
     // Получить минимальные значения
     void getMin(int min[5]) { 
@@ -0,0 +1,114 @@
+#include "SteeringController.h"
+
+// Путь меньше этого (мм) не дает оценки курса - ждем следующего вызова
+#define STEER_MIN_TRAVEL 2.0f
+
+SteeringController::SteeringController(SteeringMode m)
+    : mode(m), headingError(0.0), lastOffset(0.0), lastDistance(0.0), haveLast(false),
+      lastCurvature(0.0) {
+}
+
+void SteeringController::setMode(SteeringMode m) {
+    if (m < 0 || m >= STEERING_MODE_COUNT) return;
+    mode = m;
+    reset();
+}
+
+void SteeringController::reset() {
+    headingError = 0.0;
+    lastOffset = 0.0;
+    haveLast = false;
+    lastCurvature = 0.0;
+}
+
+float SteeringController::update(float offsetMm, float speed, float distanceMm) {
+    if (mode == STEERING_STANLEY) {
+        /*
+         * Курс относительно линии: смещение под датчиками растет на
+         * tg(θ) мм на каждый мм пути. Фильтруем, шум квантования датчиков велик.
+         */
+        float travelled = distanceMm - lastDistance;
+        if (!haveLast) {
+            lastOffset = offsetMm;
+            lastDistance = distanceMm;
+            haveLast = true;
+        } else if (travelled >= STEER_MIN_TRAVEL) {
+            float slope = (offsetMm - lastOffset) / travelled;
+            headingError += STEER_HEADING_ALPHA * (atanf(slope) - headingError);
+            lastOffset = offsetMm;
+            lastDistance = distanceMm;
+        }
+    }
+    
+    return curvatureFor(offsetMm, speed);
+}
+
+float SteeringController::update(float offsetMm, float headingRad, float speed, float distanceMm) {
+    // Курс измерен; точка отсчета оценки - здесь, если камера пропадет
+    headingError = headingRad;
+    lastOffset = offsetMm;
+    lastDistance = distanceMm;
+    haveLast = true;
+    
+    return curvatureFor(offsetMm, speed);
+}
+
+float SteeringController::curvatureFor(float offsetMm, float speed) {
+    const float lookAhead = SENSOR_OFFSET;
+    float curvature = 0.0;
+    
+    if (mode == STEERING_PURE_PURSUIT) {
+        /*
+         * Дуга из центра оси, касательная к курсу робота и проходящая
+         * через точку линии (lookAhead, offset): κ = 2y / (x² + y²)
+         */
+        curvature = STEER_PP_GAIN * 2.0f * offsetMm / (lookAhead * lookAhead + offsetMm * offsetMm);
+    } else if (mode == STEERING_STANLEY) {
+        if (speed < 0.0f) speed = 0.0f;
+        float steerAngle = headingError + atanf(STEER_STANLEY_K * offsetMm / (STEER_STANLEY_SOFT + speed));
+        steerAngle = constrain(steerAngle, -(float)HALF_PI, (float)HALF_PI);
+        
+        // Угол на точку впереди → кривизна дуги к ней: κ = 2·sin(δ) / L
+        curvature = 2.0f * sinf(steerAngle) / lookAhead;
+    }
+    
+    lastCurvature = curvature;
+    return curvature;
+}
+
+float SteeringController::speedLimit(float curvature) const {
+    float k = fabsf(curvature);
+    if (k < 1e-6f) return 1e9f;
+    return sqrtf(STEER_MAX_LATERAL_ACCEL / k);
+}
+
+float SteeringController::approachSpeed(float curvature, float distanceMm) const {
+    // v² = v_поворота² + 2·a·s: с замедлением FUSION_PREVIEW_DECEL успеваем к дуге
+    float corner = speedLimit(curvature);
+    float s = distanceMm - FUSION_PREVIEW_MARGIN;
+    if (s < 0.0f) s = 0.0f;
+    return sqrtf(corner * corner + 2.0f * FUSION_PREVIEW_DECEL * s);
+}
+
+void SteeringController::wheelCommands(float base, float curvature, int& left, int& right) {
+    float halfTrack = curvature * WHEEL_BASE / 2.0f;
+    float l = base * (1.0f + halfTrack);
+    float r = base * (1.0f - halfTrack);
+    
+    float peak = fabsf(l) > fabsf(r) ? fabsf(l) : fabsf(r);
+    if (peak > MAX_SPEED) {
+        l *= MAX_SPEED / peak;
+        r *= MAX_SPEED / peak;
+    }
+    left = (int)roundf(l);
+    right = (int)roundf(r);
+}
+
+const char* steeringModeName(SteeringMode mode) {
+    switch (mode) {
+        case STEERING_PID:          return "ПИД";
+        case STEERING_PURE_PURSUIT: return "pure pursuit";
+        case STEERING_STANLEY:      return "Stanley";
+        default:                    return "?";
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef STEERING_CONTROLLER_H
+#define STEERING_CONTROLLER_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// Закон рулевого управления
+enum SteeringMode {
+    STEERING_PID = 0,         // ПИД по позиции (коррекция в единицах команды)
+    STEERING_PURE_PURSUIT,    // Дуга через точку линии под датчиками
+    STEERING_STANLEY,         // Курс + atan(k·e / v)
+    STEERING_MODE_COUNT
+};
+
+// Геометрическое рулевое управление для дифференциального шасси.
+// По смещению линии на дистанции SENSOR_OFFSET перед осью вычисляется
+// кривизна траектории; отношение скоростей колес зависит только от нее,
+// поэтому поведение не меняется с базовой скоростью (в отличие от ПИД,
+// чья коррекция в единицах ШИМ настроена на одну скорость).
+class SteeringController {
+private:
+    SteeringMode mode;
+    
+    // Stanley: оценка угла между роботом и линией по изменению смещения с путем
+    float headingError;
+    float lastOffset;
+    float lastDistance;
+    bool haveLast;
+    float lastCurvature;
+    
+    // Кривизна по смещению и текущей оценке курса
+    float curvatureFor(float offsetMm, float speed);
+    
+public:
+    SteeringController(SteeringMode m = STEERING_DEFAULT_MODE);
+    
+    void setMode(SteeringMode m);
+    SteeringMode getMode() const { return mode; }
+    
+    // Сброс памяти (старт, потеря линии)
+    void reset();
+    
+    // Кривизна (1/мм, + вправо) по смещению линии offsetMm (+ вправо)
+    // на датчиках и скорости speed (мм/с); distanceMm - пройденный путь (одометр)
+    float update(float offsetMm, float speed, float distanceMm);
+    
+    // То же, но курс линии headingRad (+ вправо) измерен камерой -
+    // Stanley берет его вместо оценки по пути
+    float update(float offsetMm, float headingRad, float speed, float distanceMm);
+    
+    // Скорость, при которой боковое ускорение на кривизне достигает
+    // STEER_MAX_LATERAL_ACCEL (мм/с)
+    float speedLimit(float curvature) const;
+    
+    // Скорость сейчас, с которой еще можно замедлиться до speedLimit(curvature)
+    // к дуге в distanceMm впереди (мм/с)
+    float approachSpeed(float curvature, float distanceMm) const;
+    
+    // Команды колес для средней команды base и кривизны:
+    //   vL = v·(1 + κ·W/2), vR = v·(1 − κ·W/2)
+    // Если колесо выходит за MAX_SPEED, обе команды уменьшаются с сохранением отношения.
+    static void wheelCommands(float base, float curvature, int& left, int& right);
+    
+    float getCurvature() const { return lastCurvature; }
+};
+
+// Название закона для вывода
+const char* steeringModeName(SteeringMode mode);
+
+#endif // STEERING_CONTROLLER_H
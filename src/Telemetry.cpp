@@ -0,0 +1,87 @@
+#include "Telemetry.h"
+
+#define TELEMETRY_QUEUE_MASK (TELEMETRY_QUEUE - 1)
+static_assert((TELEMETRY_QUEUE & TELEMETRY_QUEUE_MASK) == 0, "TELEMETRY_QUEUE - степень двойки");
+static_assert(TELEMETRY_BATCH <= TELEMETRY_MAX_BATCH, "TELEMETRY_BATCH больше датаграммы");
+
+Telemetry::Telemetry()
+    : queueHead(0), queueTail(0), dropped(0), lastPushTime(0),
+      batchCount(0), sequence(0), lastSendTime(0), connected(false) {
+}
+
+void Telemetry::begin() {
+    if (!host.fromString(TELEMETRY_HOST)) {
+        host = IPAddress(255, 255, 255, 255);
+    }
+
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(true);
+    WiFi.begin(TELEMETRY_WIFI_SSID, TELEMETRY_WIFI_PASSWORD);
+    Serial.printf("[TELEMETRY] Подключение к \"%s\", UDP %s:%d\n",
+                  TELEMETRY_WIFI_SSID, TELEMETRY_HOST, TELEMETRY_PORT);
+}
+
+void Telemetry::record(const BlackBoxRecord& r) {
+    if (r.timeUs - lastPushTime < 1000000UL / TELEMETRY_RATE_HZ) return;
+    lastPushTime = r.timeUs;
+
+    /*
+     * Писатель и читатель на разных ядрах (робот - 1, телеметрия - 0).
+     * volatile не упорядочивает обычные записи структуры, поэтому барьеры:
+     * хвост прочитан раньше, чем пишем в освобожденную ячейку, и запись
+     * закончена раньше, чем читатель увидит новую голову
+     */
+    uint32_t head = queueHead;
+    uint32_t tail = queueTail;
+    __sync_synchronize();
+    if (head - tail >= TELEMETRY_QUEUE) {
+        dropped = dropped + 1;  // Отправка не успевает или нет WiFi
+        return;
+    }
+    queue[head & TELEMETRY_QUEUE_MASK] = r;
+    __sync_synchronize();
+    queueHead = head + 1;
+}
+
+void Telemetry::service() {
+    bool nowConnected = WiFi.status() == WL_CONNECTED;
+    if (nowConnected != connected) {
+        connected = nowConnected;
+        if (connected) {
+            udp.begin(TELEMETRY_PORT);
+            Serial.printf("[TELEMETRY] WiFi подключен, IP %s\n", WiFi.localIP().toString().c_str());
+        } else {
+            Serial.println("[TELEMETRY] WiFi потерян");
+        }
+    }
+
+    // Без WiFi очередь не разбираем - переполнение попадет в dropped
+    if (!connected) return;
+
+    // Голову - до чтения записей, хвост - после их копирования (см. record)
+    uint32_t head = queueHead;
+    __sync_synchronize();
+    while (queueTail != head) {
+        batch[batchCount++] = queue[queueTail & TELEMETRY_QUEUE_MASK];
+        __sync_synchronize();
+        queueTail = queueTail + 1;
+        if (batchCount >= TELEMETRY_BATCH) send();
+    }
+
+    if (batchCount > 0 && millis() - lastSendTime >= TELEMETRY_SEND_MS) {
+        send();
+    }
+}
+
+void Telemetry::send() {
+    size_t length = telemetryPack(packet, sequence, dropped, batch, batchCount);
+
+    // Ошибку отправки не повторяем: номер все равно растет, приемник увидит пропуск
+    udp.beginPacket(host, TELEMETRY_PORT);
+    udp.write(packet, length);
+    udp.endPacket();
+
+    sequence++;
+    batchCount = 0;
+    lastSendTime = millis();
+}
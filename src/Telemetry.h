@@ -0,0 +1,57 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include "Config.h"
+#include "TelemetryFormat.h"
+
+// Телеметрия по WiFi: записи состояния пачками в UDP-датаграммах.
+// record() - из задачи робота (только копия в очередь), подключение к WiFi
+// и отправка - service() из задачи на ядре 0. Очередь на одного писателя
+// и одного читателя, без блокировок; переполнение считается в dropped.
+// Политика TelemetrySink для LineFollower (см. TelemetrySink.h).
+class Telemetry {
+private:
+    BlackBoxRecord queue[TELEMETRY_QUEUE];
+    volatile uint32_t queueHead;   // Пишет задача робота
+    volatile uint32_t queueTail;   // Читает задача телеметрии
+    volatile uint32_t dropped;
+    uint32_t lastPushTime;         // micros() последней записи в очередь
+
+    BlackBoxRecord batch[TELEMETRY_MAX_BATCH];
+    uint16_t batchCount;
+    uint8_t packet[TELEMETRY_PACKET_MAX];   // Датаграмма (в объекте - учтена в бюджете памяти)
+    uint32_t sequence;
+    unsigned long lastSendTime;
+
+    WiFiUDP udp;
+    IPAddress host;
+    bool connected;
+
+    void send();
+
+public:
+    static const bool enabled = true;
+
+    Telemetry();
+
+    // Подключение к TELEMETRY_WIFI_SSID (не ждет соединения)
+    void begin();
+
+    // Запись состояния цикла; прореживается до TELEMETRY_RATE_HZ
+    void record(const BlackBoxRecord& r);
+
+    // События черного ящика по UDP не отправляются
+    void event(BlackBoxReason) {}
+
+    // Вызывать из задачи телеметрии: очередь → пачки → UDP
+    void service();
+
+    bool isConnected() const { return connected; }
+    uint32_t getSequence() const { return sequence; }
+    uint32_t getDropped() const { return dropped; }
+};
+
+#endif // TELEMETRY_H
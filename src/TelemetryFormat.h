@@ -0,0 +1,73 @@
+#ifndef TELEMETRY_FORMAT_H
+#define TELEMETRY_FORMAT_H
+
+#include <stdint.h>
+#include <string.h>
+#include "BlackBoxFormat.h"
+
+/*
+ * Датаграмма телеметрии по UDP. Общая для прошивки и tools/telemetry
+ * (приемник и тестовый отправитель собираются из этого же кода).
+ *
+ *   TelemetryHeader, затем recordCount × BlackBoxRecord (little-endian)
+ *
+ * Запись та же, что у черного ящика. sequence растет на 1 с каждой
+ * датаграммой - пропуски и перестановки видны на приемнике; dropped -
+ * сколько записей робот выбросил сам (очередь переполнена, WiFi не успевал).
+ */
+
+#define TELEMETRY_MAGIC    0x314D4C54UL  // "TLM1"
+#define TELEMETRY_VERSION  1
+
+// Записей в одной датаграмме: заголовок + 64 × 20 байт < 1472 (MTU Ethernet)
+#define TELEMETRY_MAX_BATCH  64
+
+#pragma pack(push, 1)
+
+struct TelemetryHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordCount;
+    uint32_t sequence;
+    uint32_t dropped;         // Накопленное число выброшенных роботом записей
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(TelemetryHeader) == 16, "TelemetryHeader: формат датаграммы");
+
+#define TELEMETRY_PACKET_MAX  (sizeof(TelemetryHeader) + TELEMETRY_MAX_BATCH * sizeof(BlackBoxRecord))
+
+// Собрать датаграмму в buffer (не меньше TELEMETRY_PACKET_MAX).
+// Возврат: длина в байтах
+inline size_t telemetryPack(uint8_t* buffer, uint32_t sequence, uint32_t dropped,
+                            const BlackBoxRecord* records, uint16_t count) {
+    if (count > TELEMETRY_MAX_BATCH) count = TELEMETRY_MAX_BATCH;
+
+    TelemetryHeader header;
+    header.magic = TELEMETRY_MAGIC;
+    header.version = TELEMETRY_VERSION;
+    header.recordCount = count;
+    header.sequence = sequence;
+    header.dropped = dropped;
+
+    memcpy(buffer, &header, sizeof(header));
+    memcpy(buffer + sizeof(header), records, count * sizeof(BlackBoxRecord));
+    return sizeof(header) + count * sizeof(BlackBoxRecord);
+}
+
+// Разобрать датаграмму: заголовок и до TELEMETRY_MAX_BATCH записей в records.
+// Возврат: число записей, -1 - не датаграмма телеметрии
+inline int telemetryUnpack(const uint8_t* data, size_t length, TelemetryHeader& header,
+                           BlackBoxRecord* records) {
+    if (length < sizeof(header)) return -1;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != TELEMETRY_MAGIC || header.version != TELEMETRY_VERSION) return -1;
+    if (header.recordCount > TELEMETRY_MAX_BATCH) return -1;
+    if (length != sizeof(header) + header.recordCount * sizeof(BlackBoxRecord)) return -1;
+
+    memcpy(records, data + sizeof(header), header.recordCount * sizeof(BlackBoxRecord));
+    return header.recordCount;
+}
+
+#endif // TELEMETRY_FORMAT_H
@@ -0,0 +1,55 @@
+#ifndef TELEMETRY_SINK_H
+#define TELEMETRY_SINK_H
+
+#include "BlackBoxFormat.h"
+
+/*
+ * Политика TelemetrySink для LineFollower - куда уходят записи состояния:
+ *
+ *   static const bool enabled;                 // false - запись не собирается
+ *   void begin();
+ *   void record(const BlackBoxRecord& r);      // Каждый цикл управления
+ *   void event(BlackBoxReason reason);         // Потеря линии, таймаут поиска, стоп
+ *
+ * Реализации: BlackBox, Telemetry (UDP), NullTelemetry, TelemetryPair.
+ */
+
+// Ничего не записывать
+class NullTelemetry {
+public:
+    static const bool enabled = false;
+
+    void begin() {}
+    void record(const BlackBoxRecord&) {}
+    void event(BlackBoxReason) {}
+};
+
+// Две политики сразу (черный ящик и UDP)
+template <class First, class Second>
+class TelemetryPair {
+private:
+    First& first;
+    Second& second;
+
+public:
+    static const bool enabled = First::enabled || Second::enabled;
+
+    TelemetryPair(First& a, Second& b) : first(a), second(b) {}
+
+    void begin() {
+        first.begin();
+        second.begin();
+    }
+
+    void record(const BlackBoxRecord& r) {
+        first.record(r);
+        second.record(r);
+    }
+
+    void event(BlackBoxReason reason) {
+        first.event(reason);
+        second.event(reason);
+    }
+};
+
+#endif // TELEMETRY_SINK_H
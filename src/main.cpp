@@ -1,14 +1,27 @@
 #include <Arduino.h>
 #include "Config.h"
-#include "Sensors.h"
-#include "Motors.h"
+#include "RobotConfig.h"
 #include "PIDController.h"
-#include "Encoders.h"
-#include "LineFollower.h"
 #include "ButtonHandler.h"
+#include "Profiler.h"
+#include "MemoryMonitor.h"
+#ifdef USE_BATTERY_MONITOR
+#include "BatteryMonitor.h"
+#endif
 
 // Forward declarations
 void robotTask(void* parameter);
+#ifdef USE_BATTERY_MONITOR
+void batteryTask(void* parameter);
+#endif
+#ifdef USE_BLACKBOX
+void blackBoxTask(void* parameter);
+#endif
+#ifdef USE_TELEMETRY
+void telemetryTask(void* parameter);
+#endif
+void handleCommand(char command, int argument);
+void printHelp();
 
 /*
  * ═══════════════════════════════════════════════════════════════════════════
@@ -39,25 +52,99 @@ void robotTask(void* parameter);
  * ═══════════════════════════════════════════════════════════════════════════
  */
 
-// Создание объектов компонентов
-LineSensors sensors;
+// Создание объектов компонентов (типы - в RobotConfig.h)
+RobotEncoders encoders;
+#ifdef USE_LINE_FUSION
+RobotLineSource sensors(encoders);  // Кадры камеры переносятся по пути колес
+#else
+RobotLineSource sensors;
+#endif
 Motors motors;
 PIDController pid;
 
-#ifdef USE_ENCODERS
-Encoders encoders;
-LineFollower robot(sensors, motors, pid, &encoders);
+#ifdef USE_BLACKBOX
+BlackBox blackBox;
+#endif
+#ifdef USE_TELEMETRY
+Telemetry telemetry;
+#endif
+
+#if defined(USE_BLACKBOX) && defined(USE_TELEMETRY)
+RobotTelemetry telemetrySink(blackBox, telemetry);
+LineFollower robot(sensors, motors, pid, encoders, telemetrySink);
+#elif defined(USE_BLACKBOX)
+LineFollower robot(sensors, motors, pid, encoders, blackBox);
+#elif defined(USE_TELEMETRY)
+LineFollower robot(sensors, motors, pid, encoders, telemetry);
 #else
-LineFollower robot(sensors, motors, pid, nullptr);
+NullTelemetry telemetrySink;
+LineFollower robot(sensors, motors, pid, encoders, telemetrySink);
 #endif
 
 // Обработчик кнопки (адаптировано из примера release-mechanism для ESP32)
 // Кнопка: пин 4 → резистор 10кОм → GND, при нажатии замыкается на 3.3V (Active HIGH)
 ButtonHandler button(BUTTON_PIN, false); // false = кнопка к VCC (Active HIGH)
 
+#ifdef USE_BATTERY_MONITOR
+BatteryMonitor battery;
+#endif
+
 // Флаг для безопасной обработки нажатия кнопки вне ISR
 volatile bool buttonPressed = false;
 
+// Команда из Serial (принимается в loop(), выполняется в задаче робота)
+// и необязательный числовой аргумент после буквы (-1 - нет)
+volatile char pendingCommand = 0;
+volatile int pendingArgument = -1;
+
+// ═══════════════════════════════════════════════════════════════════════════
+// ПАМЯТЬ: СТЕКИ ЗАДАЧ И БЮДЖЕТ
+// ═══════════════════════════════════════════════════════════════════════════
+
+// TCB и стеки задач - статически, в .bss (размеры - в Config.h)
+StaticTaskMemory<ROBOT_TASK_STACK> robotTaskMemory;
+#ifdef USE_BATTERY_MONITOR
+StaticTaskMemory<BATTERY_TASK_STACK> batteryTaskMemory;
+#endif
+#ifdef USE_BLACKBOX
+StaticTaskMemory<BLACKBOX_TASK_STACK> blackBoxTaskMemory;
+#endif
+#ifdef USE_TELEMETRY
+StaticTaskMemory<TELEMETRY_TASK_STACK> telemetryTaskMemory;
+#endif
+
+// Крупные статические объекты прошивки. Сумма проверяется при сборке,
+// таблица печатается командой 'r'
+constexpr MemoryBuffer staticMemory[] = {
+    {"LineFollower", sizeof(robot)},
+    {"LineSource", sizeof(sensors) + RobotLineSource::staticBytes},
+    {"Motors", sizeof(motors)},
+    {"Encoders", sizeof(encoders) + RobotEncoders::staticBytes},
+#ifdef USE_PROFILER
+    {"Profiler", sizeof(ProfileStats) * PROF_STAGE_COUNT},
+#endif
+#ifdef USE_BLACKBOX
+    {"BlackBox", sizeof(blackBox)},
+#endif
+#ifdef USE_TELEMETRY
+    {"Telemetry", sizeof(telemetry)},
+#endif
+    {"RobotTask", sizeof(robotTaskMemory)},
+#ifdef USE_BATTERY_MONITOR
+    {"BatteryTask", sizeof(batteryTaskMemory)},
+#endif
+#ifdef USE_BLACKBOX
+    {"BlackBoxTask", sizeof(blackBoxTaskMemory)},
+#endif
+#ifdef USE_TELEMETRY
+    {"TelemetryTask", sizeof(telemetryTaskMemory)},
+#endif
+};
+const size_t STATIC_MEMORY_COUNT = sizeof(staticMemory) / sizeof(staticMemory[0]);
+
+static_assert(memoryTotal(staticMemory, STATIC_MEMORY_COUNT) <= STATIC_RAM_BUDGET,
+              "Буферы и стеки задач не помещаются в STATIC_RAM_BUDGET (Config.h)");
+
 // ═══════════════════════════════════════════════════════════════════════════
 // ОБРАБОТКА КНОПКИ СТАРТ/СТОП (ButtonHandler с прерываниями)
 // ═══════════════════════════════════════════════════════════════════════════
@@ -74,24 +161,67 @@ void IRAM_ATTR onButtonPressed()
 // ЗАДАЧА РОБОТА (FreeRTOS Task)
 // ═══════════════════════════════════════════════════════════════════════════
 
+// Можно ли стартовать (при критическом разряде батареи - нет)
+bool canStart() {
+#ifdef USE_BATTERY_MONITOR
+    if (battery.isCritical()) {
+        Serial.printf("[BATTERY] Старт запрещен: %.2f В, замените батарею\n", battery.getVoltage());
+        return false;
+    }
+#endif
+    return true;
+}
+
 void robotTask(void* parameter) {
     Serial.println("[TASK] Задача робота запущена на Core 1");
     
+#ifdef USE_BATTERY_MONITOR
+    bool batteryStopDone = false;
+#endif
+    
     while (true) {
+#ifdef USE_BATTERY_MONITOR
+        // Компенсация просадки батареи: ПИД и калибровка работают в "номинальных" вольтах
+        motors.setSupplyScale(battery.getScale());
+        
+        // Защита от переразряда: одна остановка, дальше canStart() не пустит
+        if (battery.isCritical() && !batteryStopDone) {
+            batteryStopDone = true;
+            robot.stop();
+            Serial.printf("[BATTERY] Критический разряд (%.2f В) - остановка\n", battery.getVoltage());
+        }
+#endif
+        
         // Обработка флага кнопки (безопасно, вне ISR)
         if (buttonPressed) {
             buttonPressed = false;
             
             RobotState state = robot.getState();
             if (state == IDLE || state == STOPPED || state == LOST) {
-                robot.start();
-                Serial.println("[BUTTON] Старт!");
+                if (canStart()) {
+                    robot.start();
+                    Serial.println("[BUTTON] Старт!");
+                }
             } else {
+#ifdef USE_BLACKBOX
+                // Остановка кнопкой во время заезда - обычно что-то пошло не так
+                if (state == FOLLOWING || state == SEARCHING_LEFT || state == SEARCHING_RIGHT) {
+                    blackBox.trigger(BLACKBOX_BUTTON_STOP);
+                }
+#endif
                 robot.stop();
                 Serial.println("[BUTTON] Стоп!");
             }
         }
         
+        // Команда из Serial - в этой же задаче, без гонок с robot.update()
+        if (pendingCommand) {
+            char command = pendingCommand;
+            int argument = pendingArgument;
+            pendingCommand = 0;
+            handleCommand(command, argument);
+        }
+        
         // Обновление состояния робота
         robot.update();
         
@@ -100,6 +230,98 @@ void robotTask(void* parameter) {
     }
 }
 
+// ═══════════════════════════════════════════════════════════════════════════
+// SERIAL КОМАНДЫ
+// ═══════════════════════════════════════════════════════════════════════════
+
+void handleCommand(char command, int argument) {
+    switch (command) {
+        case 's': {
+            RobotState state = robot.getState();
+            if (state == IDLE || state == STOPPED || state == LOST) {
+                if (canStart()) robot.start();
+            } else {
+                robot.stop();
+            }
+            break;
+        }
+        case '+':
+            robot.increaseSpeed();
+            break;
+        case '-':
+            robot.decreaseSpeed();
+            break;
+        case 'b':
+            robot.calibrateBraking();
+            break;
+        case 'i':
+            robot.identifyMotors();
+            break;
+        case 'm':
+            robot.setSteeringMode((SteeringMode)((robot.getSteeringMode() + 1) % STEERING_MODE_COUNT));
+            break;
+#ifdef USE_PROFILER
+        case 'p':
+            // Печать и новое окно замеров
+            Profiler::print();
+            Profiler::reset();
+            break;
+#endif
+#ifdef USE_BATTERY_MONITOR
+        case 'v':
+            Serial.printf("[BATTERY] %.2f В (%.2f В/банка), %s, компенсация x%.2f\n",
+                          battery.getVoltage(), battery.getCellVoltage(),
+                          batteryStateName(battery.getState()), battery.getScale());
+            break;
+#endif
+        case 'r':
+            MemoryMonitor::print(staticMemory, STATIC_MEMORY_COUNT);
+            break;
+#ifdef USE_BLACKBOX
+        case 'l':
+            blackBox.list();
+            break;
+        case 'd': {
+            // Двоичный дамп на 115200 идет секунды - только на стоянке
+            RobotState state = robot.getState();
+            if (state == IDLE || state == STOPPED || state == LOST) {
+                blackBox.dump(argument);
+            } else {
+                Serial.println("✗ Дамп черного ящика - только когда робот стоит");
+            }
+            break;
+        }
+#endif
+        case 'h':
+        case '?':
+            printHelp();
+            break;
+        default:
+            break;
+    }
+}
+
+void printHelp() {
+    Serial.println("Команды:");
+    Serial.println("  s - старт / стоп");
+    Serial.println("  + / - - базовая скорость");
+    Serial.println("  b - калибровка торможения (нужны энкодеры и длинная прямая)");
+    Serial.println("  i - идентификация моторов (нужны энкодеры, колеса подняты!)");
+    Serial.println("  m - закон руления: ПИД / pure pursuit / Stanley");
+#ifdef USE_PROFILER
+    Serial.println("  p - профиль цикла управления (и сброс статистики)");
+#endif
+#ifdef USE_BATTERY_MONITOR
+    Serial.println("  v - напряжение батареи");
+#endif
+#ifdef USE_BLACKBOX
+    Serial.println("  l - записи черного ящика");
+    Serial.println("  d [N] - двоичный дамп записи N (без N - последней), см. tools/blackbox");
+#endif
+    Serial.println("  r - память: бюджет, запас стеков задач, куча");
+    Serial.println("  h - эта справка");
+}
+
 // ═══════════════════════════════════════════════════════════════════════════
 // SETUP - ИНИЦИАЛИЗАЦИЯ
 // ═══════════════════════════════════════════════════════════════════════════
@@ -130,11 +352,29 @@ void setup() {
     Serial.println("╠════════════════════════════════════════════╣");
     Serial.printf("║  PID: Kp=%.1f Ki=%.1f Kd=%.1f        ║\n", kp, ki, kd);
     Serial.printf("║  Скорость: базовая=%d макс=%d         ║\n", robot.getBaseSpeed(), MAX_SPEED);
+    Serial.printf("║  Руление: %-16s                ║\n", steeringModeName(robot.getSteeringMode()));
     
-#ifdef USE_ENCODERS
-    Serial.println("║  Энкодеры: ВКЛЮЧЕНЫ                       ║");
+    if (RobotEncoders::available) {
+        Serial.println("║  Энкодеры: ВКЛЮЧЕНЫ                       ║");
+    } else {
+        Serial.println("║  Энкодеры: ОТКЛЮЧЕНЫ                      ║");
+    }
+
+#if defined(USE_LINE_FUSION)
+    Serial.println("║  Линия: КАМЕРА + ДАТЧИКИ TCRT5000         ║");
+#elif defined(USE_CAMERA_LINK)
+    Serial.println("║  Линия: КАМЕРА (UART LineLink)            ║");
 #else
-    Serial.println("║  Энкодеры: ОТКЛЮЧЕНЫ                      ║");
+    Serial.println("║  Линия: ДАТЧИКИ TCRT5000                  ║");
+#endif
+    
+#ifdef USE_TELEMETRY
+    Serial.printf("║  Телеметрия: UDP %-5d %-20s║\n", TELEMETRY_PORT, TELEMETRY_WIFI_SSID);
+#endif
+    
+#ifdef USE_BATTERY_MONITOR
+    battery.begin();
+    Serial.printf("║  Батарея: %.2f В (%s)                ║\n", battery.getVoltage(), batteryStateName(battery.getState()));
 #endif
     
     Serial.println("╚════════════════════════════════════════════╝\n");
@@ -142,25 +382,105 @@ void setup() {
     Serial.println("Робот готов к работе!");
     Serial.println("Поместите робота на линию и нажмите кнопку для старта");
     Serial.println("Повторное нажатие кнопки остановит робота\n");
+    printHelp();
     
-    // Создаём задачу FreeRTOS для робота на ядре 1 (ядро 0 для WiFi/BT)
-    xTaskCreatePinnedToCore(
-        robotTask,        // Функция задачи
-        "RobotTask",      // Название задачи
-        10000,            // Размер стека (байты)
-        NULL,             // Параметры
-        1,                // Приоритет (1 = нормальный)
-        NULL,             // Дескриптор задачи
-        1                 // Ядро процессора (0 или 1)
-    );
+    // Создаём задачу FreeRTOS для робота на ядре 1 (ядро 0 для WiFi/BT).
+    // Стек и TCB - статические, из robotTaskMemory
+    MemoryMonitor::startTask(robotTaskMemory, robotTask, "RobotTask", 1, 1);
     
     Serial.println("[OK] Задача робота создана на Core 1\n");
+    
+#ifdef USE_BATTERY_MONITOR
+    // АЦП опрашивается на ядре 0, чтобы не удлинять цикл управления
+    MemoryMonitor::startTask(batteryTaskMemory, batteryTask, "BatteryTask", 1, 0);
+#endif
+
+#ifdef USE_BLACKBOX
+    // Запись во flash занимает десятки мс - не в задаче робота
+    MemoryMonitor::startTask(blackBoxTaskMemory, blackBoxTask, "BlackBoxTask", 1, 0);
+#endif
+
+#ifdef USE_TELEMETRY
+    // WiFi и UDP - на ядре 0, рядом со стеком WiFi, а не с циклом управления
+    MemoryMonitor::startTask(telemetryTaskMemory, telemetryTask, "TelemetryTask", 1, 0);
+#endif
+
+    // loopTask (здесь выполняется setup) создает ядро Arduino
+    MemoryMonitor::addTask("loopTask", xTaskGetCurrentTaskHandle(), getArduinoLoopTaskStackSize());
+    MemoryMonitor::markStartup();
 }
 
+#ifdef USE_BATTERY_MONITOR
+// ═══════════════════════════════════════════════════════════════════════════
+// ЗАДАЧА КОНТРОЛЯ БАТАРЕИ (Core 0)
+// ═══════════════════════════════════════════════════════════════════════════
+
+void batteryTask(void* parameter) {
+    BatteryState lastState = battery.getState();
+    
+    while (true) {
+        battery.sample();
+        
+        BatteryState state = battery.getState();
+        if (state != lastState) {
+            lastState = state;
+            if (state == BATTERY_LOW) {
+                Serial.printf("[BATTERY] Батарея разряжена: %.2f В\n", battery.getVoltage());
+            }
+        }
+        
+        vTaskDelay(pdMS_TO_TICKS(BATTERY_SAMPLE_MS));
+    }
+}
+#endif
+
+#ifdef USE_BLACKBOX
+// ═══════════════════════════════════════════════════════════════════════════
+// ЗАДАЧА ЗАПИСИ ЧЕРНОГО ЯЩИКА (Core 0)
+// ═══════════════════════════════════════════════════════════════════════════
+
+void blackBoxTask(void* parameter) {
+    while (true) {
+        blackBox.service();
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+}
+#endif
+
+#ifdef USE_TELEMETRY
+// ═══════════════════════════════════════════════════════════════════════════
+// ЗАДАЧА ТЕЛЕМЕТРИИ (Core 0)
+// ═══════════════════════════════════════════════════════════════════════════
+
+void telemetryTask(void* parameter) {
+    while (true) {
+        telemetry.service();
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+#endif
+
 // ═══════════════════════════════════════════════════════════════════════════
 // LOOP - ОСНОВНОЙ ЦИКЛ (минимальная загрузка для кнопки)
 // ═══════════════════════════════════════════════════════════════════════════
 
 void loop() {
-    
+    // Прием команд из Serial; выполняет их задача робота.
+    // Цифры после буквы - аргумент команды ("d3")
+    char command = 0;
+    int argument = -1;
+    while (Serial.available()) {
+        char c = Serial.read();
+        if (c >= '0' && c <= '9' && command) {
+            argument = (argument < 0 ? 0 : argument * 10) + (c - '0');
+        } else if (c != '\n' && c != '\r' && c != ' ') {
+            command = c;
+            argument = -1;
+        }
+    }
+    if (command) {
+        pendingArgument = argument;
+        pendingCommand = command;
+    }
+    delay(10);
 }
@@ -0,0 +1,181 @@
+/*
+ * bbdecode - convert robot black-box recordings to CSV
+ *
+ * Accepts either a recording file copied from LittleFS (starts with the
+ * BBX1 header) or a raw serial capture containing one or more dumps made
+ * with the 'd' command ("[BLACKBOX] BEGIN <index> <size>" + binary bytes).
+ *
+ *   bbdecode [-o out.csv] <capture | recording.bin>...
+ *
+ * Every recording becomes one CSV block (or file out_<index>.csv when
+ * several recordings are decoded with -o). Time is in ms relative to the
+ * trigger (the last record), so the failure is always at t = 0.
+ */
+
+#include <BlackBoxFormat.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static const char* stateNames[] = {
+    "IDLE", "CALIBRATING", "FOLLOWING", "SEARCHING_LEFT", "SEARCHING_RIGHT",
+    "LOST", "STOPPED", "BRAKE_TEST", "SYSID"
+};
+
+static const char* reasonNames[] = {"line_lost", "search_timeout", "button_stop"};
+
+struct Recording {
+    int index;
+    std::vector<uint8_t> bytes;
+};
+
+static bool readFile(const char* path, std::vector<uint8_t>& data) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+        data.insert(data.end(), buffer, buffer + n);
+    }
+    fclose(f);
+    return true;
+}
+
+// Recordings inside a serial capture (or the file itself if it is one)
+static void findRecordings(const std::vector<uint8_t>& data, std::vector<Recording>& out) {
+    uint32_t magic = 0;
+    if (data.size() >= 4) memcpy(&magic, data.data(), 4);
+    if (magic == BLACKBOX_MAGIC) {
+        Recording r;
+        r.index = (int)out.size();
+        r.bytes = data;
+        out.push_back(r);
+        return;
+    }
+
+    const char* marker = "[BLACKBOX] BEGIN ";
+    size_t markerLength = strlen(marker);
+    size_t pos = 0;
+    while (pos + markerLength < data.size()) {
+        if (memcmp(&data[pos], marker, markerLength) != 0) {
+            pos++;
+            continue;
+        }
+        size_t lineEnd = pos;
+        while (lineEnd < data.size() && data[lineEnd] != '\n') lineEnd++;
+        if (lineEnd >= data.size()) break;
+
+        std::string line(data.begin() + pos + markerLength, data.begin() + lineEnd);
+        int index = 0;
+        unsigned size = 0;
+        if (sscanf(line.c_str(), "%d %u", &index, &size) != 2 || lineEnd + 1 + size > data.size()) {
+            fprintf(stderr, "truncated dump at byte %zu\n", pos);
+            break;
+        }
+
+        Recording r;
+        r.index = index;
+        r.bytes.assign(data.begin() + lineEnd + 1, data.begin() + lineEnd + 1 + size);
+        out.push_back(r);
+        pos = lineEnd + 1 + size;
+    }
+}
+
+static bool writeCsv(const Recording& r, FILE* out) {
+    if (r.bytes.size() < sizeof(BlackBoxHeader)) return false;
+
+    BlackBoxHeader header;
+    memcpy(&header, r.bytes.data(), sizeof(header));
+    if (header.magic != BLACKBOX_MAGIC || header.recordSize != sizeof(BlackBoxRecord)) {
+        fprintf(stderr, "recording %d: bad header (version %u, record %u bytes)\n",
+                r.index, header.version, header.recordSize);
+        return false;
+    }
+
+    size_t available = (r.bytes.size() - sizeof(header)) / sizeof(BlackBoxRecord);
+    size_t count = header.recordCount < available ? header.recordCount : available;
+    if (count == 0) return false;
+
+    const uint8_t* base = r.bytes.data() + sizeof(header);
+    BlackBoxRecord last;
+    memcpy(&last, base + (count - 1) * sizeof(BlackBoxRecord), sizeof(last));
+
+    fprintf(stderr, "recording %d: %s, %zu records, %.2f s before trigger\n", r.index,
+            header.reason < BLACKBOX_REASON_COUNT ? reasonNames[header.reason] : "?",
+            count, count * header.periodUs / 1e6);
+
+    fprintf(out, "t_ms,position,correction,cmd_left,cmd_right,speed_left,speed_right,"
+                 "sensors,state,memory,braking,launch\n");
+    for (size_t i = 0; i < count; i++) {
+        BlackBoxRecord rec;
+        memcpy(&rec, base + i * sizeof(BlackBoxRecord), sizeof(rec));
+
+        char sensors[6];
+        for (int s = 0; s < 5; s++) sensors[s] = (rec.sensorMask & (1 << s)) ? '1' : '0';
+        sensors[5] = 0;
+
+        double t = (int32_t)(rec.timeUs - last.timeUs) / 1000.0;
+        fprintf(out, "%.3f,", t);
+        if (rec.position == BLACKBOX_NO_LINE) {
+            fprintf(out, ",");
+        } else {
+            fprintf(out, "%.3f,", rec.position / 1000.0);
+        }
+        fprintf(out, "%.1f,%d,%d,%d,%d,%s,%s,%d,%d,%d\n",
+                rec.correction / 10.0, rec.leftCommand, rec.rightCommand,
+                rec.leftSpeed, rec.rightSpeed, sensors,
+                rec.state < sizeof(stateNames) / sizeof(stateNames[0]) ? stateNames[rec.state] : "?",
+                (rec.flags & BLACKBOX_FLAG_MEMORY) != 0,
+                (rec.flags & BLACKBOX_FLAG_BRAKING) != 0,
+                (rec.flags & BLACKBOX_FLAG_LAUNCH) != 0);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* outPath = nullptr;
+    std::vector<Recording> recordings;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+            continue;
+        }
+        std::vector<uint8_t> data;
+        if (!readFile(argv[i], data)) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+        findRecordings(data, recordings);
+    }
+
+    if (recordings.empty()) {
+        fprintf(stderr, "usage: bbdecode [-o out.csv] <capture | recording.bin>...\n"
+                        "no recordings found\n");
+        return 1;
+    }
+
+    int failed = 0;
+    for (size_t i = 0; i < recordings.size(); i++) {
+        FILE* out = stdout;
+        if (outPath) {
+            std::string path = outPath;
+            if (recordings.size() > 1) {
+                size_t dot = path.rfind('.');
+                std::string suffix = "_" + std::to_string(recordings[i].index);
+                path = dot == std::string::npos ? path + suffix : path.substr(0, dot) + suffix + path.substr(dot);
+            }
+            out = fopen(path.c_str(), "w");
+            if (!out) {
+                fprintf(stderr, "cannot write %s\n", path.c_str());
+                return 1;
+            }
+        }
+        if (!writeCsv(recordings[i], out)) failed++;
+        if (out != stdout) fclose(out);
+    }
+    return failed ? 1 : 0;
+}
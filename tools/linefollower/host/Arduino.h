@@ -0,0 +1,59 @@
+/*
+ * Host stand-in for the parts of the Arduino-ESP32 core that LineFollower
+ * and its helpers use. Time is a variable the test advances (hostMicros),
+ * Serial output is discarded unless hostSerialEcho is set.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PI      3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+
+#define LOW    0x0
+#define HIGH   0x1
+#define INPUT  0x01
+#define RISING 0x01
+#define CHANGE 0x03
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+// One task, no interrupts: critical sections are no-ops
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux)     ((void)(mux))
+#define portEXIT_CRITICAL(mux)      ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux)  ((void)(mux))
+
+extern uint32_t hostMicros;
+extern bool hostSerialEcho;
+
+inline unsigned long micros() { return hostMicros; }
+inline unsigned long millis() { return hostMicros / 1000; }
+inline void delay(unsigned long ms) { hostMicros += ms * 1000; }
+
+class HostSerial {
+public:
+    template <class... Args>
+    void printf(const char* format, Args... args) {
+        if (hostSerialEcho) ::printf(format, args...);
+    }
+    void print(const char* s) { if (hostSerialEcho) fputs(s, stdout); }
+    void print(int v) { if (hostSerialEcho) ::printf("%d", v); }
+    void print(float v) { if (hostSerialEcho) ::printf("%f", v); }
+    void println(const char* s = "") { if (hostSerialEcho) puts(s); }
+};
+
+extern HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
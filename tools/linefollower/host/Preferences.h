@@ -0,0 +1,20 @@
+/*
+ * Host stand-in for the ESP32 NVS Preferences: nothing is stored, so
+ * MotorSysId::load() finds no saved model.
+ */
+
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <stddef.h>
+
+class Preferences {
+public:
+    bool begin(const char*, bool = false) { return true; }
+    void end() {}
+    size_t putBytes(const char*, const void*, size_t length) { return length; }
+    size_t getBytes(const char*, void*, size_t) { return 0; }
+    size_t getBytesLength(const char*) { return 0; }
+};
+
+#endif // HOST_PREFERENCES_H
@@ -0,0 +1,268 @@
+/*
+ * linefollower_test - host test of the LineFollower template
+ *
+ *   make test
+ *
+ * Instantiates BasicLineFollower from src/LineFollowerImpl.h with mock
+ * sensor and motor policies and the firmware's own null policies
+ * (NoEncoders, NullTelemetry), against a host Arduino.h whose clock the
+ * test advances. Checks the launch ramp, steering direction in the PID and
+ * pure pursuit modes, line memory, the search state machine after a line
+ * loss (left, right, LOST, IDLE), re-acquiring the line, and the events a
+ * recording telemetry sink receives.
+ */
+
+#include <LineFollowerImpl.h>
+#include <Encoders.h>
+#include <TelemetrySink.h>
+
+uint32_t hostMicros = 1000000;
+bool hostSerialEcho = false;
+HostSerial Serial;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+// Five digital sensors (0 = line) set by the test, centroid position and
+// line memory like LineSensors without USE_SENSOR_EDGES
+class MockSensors final : public LineSource {
+private:
+    int pattern[5];
+    float lastKnownPosition;
+    unsigned long lastPositionTime;
+
+public:
+    MockSensors() : lastKnownPosition(-999), lastPositionTime(0) { setLine(-999); }
+
+    // Line under sensor index (0..4), -999 - no line
+    void setLine(int index) {
+        for (int i = 0; i < 5; i++) pattern[i] = (i == index) ? 0 : 1;
+    }
+
+    void begin() override {}
+    void read(int sensors[5]) override {
+        for (int i = 0; i < 5; i++) sensors[i] = pattern[i];
+    }
+    float calculatePosition(int sensors[5]) override {
+        float sum = 0.0;
+        int count = 0;
+        for (int i = 0; i < 5; i++) {
+            if (sensors[i] == 0) {
+                sum += i - 2;
+                count++;
+            }
+        }
+        if (count == 0) return -999;
+        lastKnownPosition = sum / count;
+        lastPositionTime = millis();
+        return lastKnownPosition;
+    }
+    void calibrate() override {}
+    float getLastKnownPosition() const override { return lastKnownPosition; }
+    unsigned long getLastPositionTime() const override { return lastPositionTime; }
+    void resetPositionMemory() override {
+        lastKnownPosition = -999;
+        lastPositionTime = 0;
+    }
+};
+
+// Records the last command; the MotorDriver interface LineFollower uses
+class MockMotors {
+public:
+    float left;
+    float right;
+    int stops;
+    int brakes;
+    int pulses;
+
+    MockMotors() : left(0.0), right(0.0), stops(0), brakes(0), pulses(0) {}
+
+    void begin() {}
+    void update() {}
+    void setSpeedNormalized(float l, float r) {
+        left = l;
+        right = r;
+    }
+    void stop() {
+        left = right = 0.0;
+        stops++;
+    }
+    void coast() { left = right = 0.0; }
+    void brake(int = 255) {
+        left = right = 0.0;
+        brakes++;
+    }
+    void reversePulse(int, uint16_t, int = 255) { pulses++; }
+};
+
+// Telemetry sink that keeps counts instead of sending
+class EventLog {
+public:
+    static const bool enabled = true;
+
+    int records;
+    int events[BLACKBOX_REASON_COUNT];
+    uint8_t lastState;
+
+    EventLog() : records(0), lastState(0) {
+        for (int i = 0; i < BLACKBOX_REASON_COUNT; i++) events[i] = 0;
+    }
+
+    void begin() {}
+    void record(const BlackBoxRecord& r) {
+        records++;
+        lastState = r.state;
+    }
+    void event(BlackBoxReason reason) { events[reason]++; }
+};
+
+typedef BasicLineFollower<MockSensors, MockMotors, NoEncoders, NullTelemetry> TestFollower;
+typedef BasicLineFollower<MockSensors, MockMotors, NoEncoders, EventLog> LoggedFollower;
+
+// One control cycle per millisecond, as the robot task runs
+template <class Follower>
+static void run(Follower& robot, unsigned long ms) {
+    for (unsigned long i = 0; i < ms; i++) {
+        hostMicros += 1000;
+        robot.update();
+    }
+}
+
+static void testLaunchAndSteering() {
+    MockSensors sensors;
+    MockMotors motors;
+    PIDController pid;
+    NoEncoders encoders;
+    NullTelemetry telemetry;
+    TestFollower robot(sensors, motors, pid, encoders, telemetry);
+    robot.begin();
+    CHECK(robot.getState() == IDLE);
+
+    sensors.setLine(2);
+    robot.start();
+    CHECK(robot.getState() == FOLLOWING);
+    CHECK(robot.getMotionProfile().isLaunching());
+
+    // Launch ramp: well below base speed at first, then base speed on both wheels
+    run(robot, 20);
+    float base = BASE_SPEED / 255.0f;
+    CHECK(motors.left > 0.0f && motors.left < base / 2.0f);
+    CHECK(fabsf(motors.left - motors.right) < 1e-4f);
+    run(robot, 500);
+    CHECK(!robot.getMotionProfile().isLaunching());
+    CHECK(fabsf(motors.left - base) < 0.01f);
+    CHECK(fabsf(motors.right - base) < 0.01f);
+
+    // Line to the right of centre: left wheel faster (PID)
+    sensors.setLine(3);
+    run(robot, 100);
+    CHECK(robot.getState() == FOLLOWING);
+    CHECK(motors.left > motors.right);
+
+    // Same with pure pursuit
+    robot.setSteeringMode(STEERING_PURE_PURSUIT);
+    sensors.setLine(1);
+    run(robot, 100);
+    CHECK(motors.left < motors.right);
+    sensors.setLine(3);
+    run(robot, 100);
+    CHECK(motors.left > motors.right);
+
+    robot.pause();
+    CHECK(robot.getState() == STOPPED);
+    CHECK(motors.left == 0.0f && motors.right == 0.0f);
+}
+
+static void testLineLossAndSearch() {
+    MockSensors sensors;
+    MockMotors motors;
+    PIDController pid;
+    NoEncoders encoders;
+    NullTelemetry telemetry;
+    TestFollower robot(sensors, motors, pid, encoders, telemetry);
+    robot.begin();
+
+    sensors.setLine(2);
+    robot.start();
+    run(robot, 500);
+
+    // Short gap: last position is remembered, robot keeps following
+    sensors.setLine(-999);
+    run(robot, LINE_MEMORY_TIMEOUT / 2);
+    CHECK(robot.getState() == FOLLOWING);
+    CHECK(motors.left > 0.0f && motors.right > 0.0f);
+
+    // Memory expired: search to the left first (no encoders - no braking)
+    run(robot, LINE_MEMORY_TIMEOUT);
+    CHECK(robot.getState() == SEARCHING_LEFT);
+    CHECK(motors.brakes == 0 && motors.pulses == 0);
+    run(robot, 200);
+    CHECK(motors.left < 0.0f && motors.right > 0.0f);
+
+    // Half the timeout: turn to the right
+    run(robot, SEARCH_TIMEOUT / 2);
+    CHECK(robot.getState() == SEARCHING_RIGHT);
+    run(robot, 300);
+    CHECK(motors.left > 0.0f && motors.right < 0.0f);
+
+    // Timeout: LOST, then IDLE with motors stopped
+    run(robot, SEARCH_TIMEOUT / 2);
+    CHECK(robot.getState() == IDLE);
+    CHECK(motors.stops > 0);
+    CHECK(motors.left == 0.0f && motors.right == 0.0f);
+
+    // Line back in the middle of a search: following again
+    sensors.setLine(2);
+    robot.start();
+    run(robot, 300);
+    sensors.setLine(-999);
+    run(robot, LINE_MEMORY_TIMEOUT + 50);
+    CHECK(robot.getState() == SEARCHING_LEFT);
+    sensors.setLine(0);
+    run(robot, 1);
+    CHECK(robot.getState() == FOLLOWING);
+    run(robot, 100);
+    CHECK(motors.left < motors.right);
+}
+
+static void testTelemetryEvents() {
+    MockSensors sensors;
+    MockMotors motors;
+    PIDController pid;
+    NoEncoders encoders;
+    EventLog log;
+    LoggedFollower robot(sensors, motors, pid, encoders, log);
+    robot.begin();
+
+    sensors.setLine(2);
+    robot.start();
+    run(robot, 100);
+    CHECK(log.records == 100);
+    CHECK(log.lastState == FOLLOWING);
+
+    sensors.setLine(-999);
+    run(robot, LINE_MEMORY_TIMEOUT + SEARCH_TIMEOUT + 50);
+    CHECK(log.events[BLACKBOX_LINE_LOST] == 1);
+    CHECK(log.events[BLACKBOX_SEARCH_TIMEOUT] == 1);
+    CHECK(robot.getState() == IDLE);
+}
+
+int main() {
+    testLaunchAndSteering();
+    testLineLossAndSearch();
+    testTelemetryEvents();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("linefollower_test: all checks passed\n");
+    return 0;
+}
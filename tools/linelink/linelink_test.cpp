@@ -0,0 +1,179 @@
+/*
+ * linelink_test - host test of the LineLink encoder, parser and CRC
+ *
+ *   make test
+ *
+ * Builds lib/LineLink/src as plain C++ and checks the CRC against the
+ * CRC-16/CCITT-FALSE check value, an encode/parse round trip, resync after
+ * line noise, CRC and length errors, and the sequence accounting: gaps are
+ * lost frames, repeats and a camera restart are resyncs, including a restart
+ * after more than 0x8000 frames (told by the camera clock going back).
+ */
+
+#include <LineLink.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+static LineLinkState makeState(uint16_t seq) {
+    LineLinkState s;
+    memset(&s, 0, sizeof(s));
+    s.seq = seq;
+    s.captureUs = 123456789u;
+    s.latencyUs = 42000;
+    s.positionMm = -12.3f;
+    s.headingRad = 0.254f;
+    s.curvature = -3.57f;
+    s.refForwardMm = 180;
+    s.confidence = 87;
+    s.flags = LINE_LINK_FLAG_DETECTED | LINE_LINK_FLAG_JUNCTION;
+    return s;
+}
+
+// Feed bytes, return how many frames completed
+static int feed(LineLinkParser& parser, const uint8_t* data, size_t len) {
+    int frames = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (parser.feed(data[i])) frames++;
+    }
+    return frames;
+}
+
+static int sendFrame(LineLinkParser& parser, uint16_t seq, uint32_t captureUs = 123456789u) {
+    uint8_t frame[LINE_LINK_MAX_FRAME];
+    LineLinkState s = makeState(seq);
+    s.captureUs = captureUs;
+    size_t len = lineLinkEncodeState(s, frame);
+    return feed(parser, frame, len);
+}
+
+static void testCrc() {
+    const char* check = "123456789";
+    CHECK(lineLinkCrc16((const uint8_t*)check, strlen(check)) == 0x29B1);
+    CHECK(lineLinkCrc16((const uint8_t*)check, 0) == 0xFFFF);
+}
+
+static void testRoundTrip() {
+    uint8_t frame[LINE_LINK_MAX_FRAME];
+    LineLinkState in = makeState(7);
+    size_t len = lineLinkEncodeState(in, frame);
+    CHECK(len == LINE_LINK_HEADER_SIZE + LINE_LINK_LINE_STATE_SIZE + LINE_LINK_CRC_SIZE);
+
+    LineLinkParser parser;
+    CHECK(feed(parser, frame, len) == 1);
+    const LineLinkState& out = parser.getState();
+    CHECK(out.seq == 7);
+    CHECK(out.captureUs == in.captureUs);
+    CHECK(out.latencyUs == in.latencyUs);
+    CHECK(fabsf(out.positionMm - in.positionMm) <= 0.05f);
+    CHECK(fabsf(out.headingRad - in.headingRad) <= 0.0005f);
+    CHECK(fabsf(out.curvature - in.curvature) <= 0.005f);
+    CHECK(out.refForwardMm == in.refForwardMm);
+    CHECK(out.confidence == in.confidence);
+    CHECK(out.flags == in.flags);
+    CHECK(parser.getFramesOk() == 1);
+    CHECK(parser.getCrcErrors() == 0);
+}
+
+static void testNoiseAndErrors() {
+    LineLinkParser parser;
+
+    // Garbage, including stray sync bytes, before a valid frame
+    const uint8_t noise[] = {0x00, 0xA5, 0x13, 0xA5, 0xA5, 0x77, 0x5A};
+    CHECK(feed(parser, noise, sizeof(noise)) == 0);
+    CHECK(sendFrame(parser, 1) == 1);
+
+    // Corrupted payload byte: CRC error, next frame still parses
+    uint8_t frame[LINE_LINK_MAX_FRAME];
+    LineLinkState s = makeState(2);
+    size_t len = lineLinkEncodeState(s, frame);
+    frame[LINE_LINK_HEADER_SIZE + 3] ^= 0x10;
+    CHECK(feed(parser, frame, len) == 0);
+    CHECK(parser.getCrcErrors() == 1);
+    CHECK(sendFrame(parser, 3) == 1);
+
+    // Oversized length field: dropped without waiting for its bytes
+    const uint8_t bad[] = {LINE_LINK_SYNC0, LINE_LINK_SYNC1, LINE_LINK_MSG_LINE_STATE,
+                           LINE_LINK_MAX_PAYLOAD + 1, 0, 0};
+    CHECK(feed(parser, bad, sizeof(bad)) == 0);
+    CHECK(sendFrame(parser, 4) == 1);
+    CHECK(parser.getFramesOk() == 3);
+}
+
+static void testSequence() {
+    LineLinkParser parser;
+    CHECK(sendFrame(parser, 100) == 1);
+    CHECK(sendFrame(parser, 101) == 1);
+    CHECK(parser.getFramesLost() == 0);
+
+    // Gap of three
+    CHECK(sendFrame(parser, 105) == 1);
+    CHECK(parser.getFramesLost() == 3);
+
+    // Duplicate
+    CHECK(sendFrame(parser, 105) == 1);
+    CHECK(parser.getFramesLost() == 3);
+    CHECK(parser.getResyncs() == 1);
+
+    // Camera reboot: numbering restarts from zero
+    CHECK(sendFrame(parser, 0) == 1);
+    CHECK(parser.getFramesLost() == 3);
+    CHECK(parser.getResyncs() == 2);
+    CHECK(sendFrame(parser, 1) == 1);
+    CHECK(parser.getFramesLost() == 3);
+
+    // Wrap-around is a normal step
+    LineLinkParser wrap;
+    CHECK(sendFrame(wrap, 0xFFFE) == 1);
+    CHECK(sendFrame(wrap, 0xFFFF) == 1);
+    CHECK(sendFrame(wrap, 0x0001) == 1);
+    CHECK(wrap.getFramesLost() == 1);
+    CHECK(wrap.getResyncs() == 0);
+
+    // Camera clock wrap-around (micros, ~71.6 min) is not a restart
+    LineLinkParser clockWrap;
+    CHECK(sendFrame(clockWrap, 10, 0xFFFF0000u) == 1);
+    CHECK(sendFrame(clockWrap, 12, 0x00001000u) == 1);
+    CHECK(clockWrap.getFramesLost() == 1);
+    CHECK(clockWrap.getResyncs() == 0);
+
+    // Reboot after more than 0x8000 frames: 0x9000 -> 0 looks like a forward
+    // step of 0x7000, the camera clock starting over tells it apart
+    LineLinkParser longRun;
+    CHECK(sendFrame(longRun, 0x9000, 600000000u) == 1);
+    CHECK(sendFrame(longRun, 0, 1500000u) == 1);
+    CHECK(longRun.getFramesLost() == 0);
+    CHECK(longRun.getResyncs() == 1);
+
+    // Same after more than half the clock range (unsigned jump looks forward)
+    LineLinkParser veryLongRun;
+    CHECK(sendFrame(veryLongRun, 0x9000, 3000000000u) == 1);
+    CHECK(sendFrame(veryLongRun, 0, 1500000u) == 1);
+    CHECK(veryLongRun.getFramesLost() == 0);
+    CHECK(veryLongRun.getResyncs() == 1);
+}
+
+int main() {
+    testCrc();
+    testRoundTrip();
+    testNoiseAndErrors();
+    testSequence();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("linelink_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,454 @@
+/*
+ * replay - run recorded camera frames through the LineVision pipeline on a PC
+ *
+ * Reads LVRF containers (/capture-raw?frames=N) and/or binary PGM files,
+ * runs LineDetector (row centroids + ground projection + curve fit), the
+ * legacy three-region scan and the blob labeler + junction classifier on
+ * every frame, and reports time per frame, detection rate, junction counts
+ * and position error against labeled ground truth.
+ *
+ *   replay [options] <file.lvr | frame.pgm>...
+ *
+ *   --labels FILE     CSV: frame,position_percent[,position_mm]; -1 = no line
+ *   --csv FILE        per-frame results
+ *   --repeat N        timing repetitions per frame (default 20)
+ *   --threshold N     binarization threshold (default 128)
+ *   --min-width N     minimum dark run in pixels (default 10)
+ *   --row-step N      scan every N-th row (default 3)
+ *   --inlier MM       curve fit inlier tolerance (default 8)
+ *   --mount H,T,F,O   camera height mm, tilt deg, HFOV deg, offset mm
+ *                     (default 120,35,60,40 - see ROBOT_GEOMETRY.md)
+ *   --dump-pgm PREFIX write every frame as PREFIX_NNNN.pgm (for labeling)
+ */
+
+#include <LineVision.h>
+
+#include <algorithm>
+#include <chrono>
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct Frame {
+    int width;
+    int height;
+    uint32_t timestampUs;
+    std::vector<uint8_t> pixels;
+};
+
+struct Label {
+    bool labeled;
+    bool present;
+    float positionPercent;
+    float positionMm;      // NAN when not labeled
+};
+
+struct Options {
+    const char* labelsPath = NULL;
+    const char* csvPath = NULL;
+    const char* dumpPrefix = NULL;
+    int repeat = 20;
+    int threshold = 128;
+    int minWidth = 10;
+    int rowStep = 3;
+    float inlierMm = 8.0f;
+    float heightMm = 120.0f;
+    float tiltDeg = 35.0f;
+    float hfovDeg = 60.0f;
+    float offsetMm = 40.0f;
+};
+
+// Error accumulator for one pipeline
+struct ErrorStats {
+    int count = 0;
+    double sumAbs = 0.0;
+    double sumSq = 0.0;
+    double maxAbs = 0.0;
+
+    void add(double error) {
+        double a = fabs(error);
+        count++;
+        sumAbs += a;
+        sumSq += error * error;
+        if (a > maxAbs) maxAbs = a;
+    }
+};
+
+// Detection outcome against labels
+struct MatchStats {
+    int truePositive = 0;
+    int falsePositive = 0;
+    int falseNegative = 0;
+    int trueNegative = 0;
+
+    void add(bool detected, bool present) {
+        if (detected && present) truePositive++;
+        else if (detected) falsePositive++;
+        else if (present) falseNegative++;
+        else trueNegative++;
+    }
+};
+
+static bool readFile(const char* path, std::vector<uint8_t>& data) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    fclose(f);
+    return true;
+}
+
+// Next whitespace-separated PGM header token, skipping # comments
+static bool pgmToken(const std::vector<uint8_t>& data, size_t& pos, int& value) {
+    while (pos < data.size()) {
+        if (data[pos] == '#') {
+            while (pos < data.size() && data[pos] != '\n') pos++;
+        } else if (isspace(data[pos])) {
+            pos++;
+        } else {
+            break;
+        }
+    }
+    if (pos >= data.size() || !isdigit(data[pos])) return false;
+    value = 0;
+    while (pos < data.size() && isdigit(data[pos])) {
+        value = value * 10 + (data[pos] - '0');
+        pos++;
+    }
+    return true;
+}
+
+static bool loadPgm(const char* path, const std::vector<uint8_t>& data, std::vector<Frame>& frames) {
+    size_t pos = 2;
+    int width, height, maxValue;
+    if (!pgmToken(data, pos, width) || !pgmToken(data, pos, height) ||
+        !pgmToken(data, pos, maxValue) || maxValue > 255 || width <= 0 || height <= 0) {
+        fprintf(stderr, "%s: unsupported PGM header (need P5, 8-bit)\n", path);
+        return false;
+    }
+    pos++;  // Single whitespace after maxval
+    size_t size = (size_t)width * height;
+    if (data.size() < pos + size) {
+        fprintf(stderr, "%s: truncated PGM\n", path);
+        return false;
+    }
+
+    Frame frame;
+    frame.width = width;
+    frame.height = height;
+    frame.timestampUs = 0;
+    frame.pixels.assign(data.begin() + pos, data.begin() + pos + size);
+    frames.push_back(frame);
+    return true;
+}
+
+static bool loadContainer(const char* path, const std::vector<uint8_t>& data, std::vector<Frame>& frames) {
+    FrameFileHeader header;
+    if (data.size() < FRAME_CONTAINER_FILE_HEADER || !frameDecodeFileHeader(data.data(), header)) {
+        fprintf(stderr, "%s: bad LVRF header\n", path);
+        return false;
+    }
+
+    size_t size = (size_t)header.width * header.height;
+    size_t pos = FRAME_CONTAINER_FILE_HEADER;
+    int loaded = 0;
+    while (pos + FRAME_CONTAINER_FRAME_HEADER <= data.size()) {
+        FrameHeader frameHeader;
+        frameDecodeFrameHeader(data.data() + pos, frameHeader);
+        pos += FRAME_CONTAINER_FRAME_HEADER;
+        if (frameHeader.length != size || pos + size > data.size()) {
+            fprintf(stderr, "%s: frame %d truncated or wrong size, stopping\n", path, loaded);
+            break;
+        }
+
+        Frame frame;
+        frame.width = header.width;
+        frame.height = header.height;
+        frame.timestampUs = frameHeader.timestampUs;
+        frame.pixels.assign(data.begin() + pos, data.begin() + pos + size);
+        frames.push_back(frame);
+        pos += size;
+        loaded++;
+    }
+
+    if (header.frameCount != 0 && (uint32_t)loaded != header.frameCount) {
+        fprintf(stderr, "%s: header says %u frames, read %d\n", path, header.frameCount, loaded);
+    }
+    return loaded > 0;
+}
+
+static bool loadFrames(const char* path, std::vector<Frame>& frames) {
+    std::vector<uint8_t> data;
+    if (!readFile(path, data)) {
+        fprintf(stderr, "%s: cannot read\n", path);
+        return false;
+    }
+    if (data.size() >= 2 && data[0] == 'P' && data[1] == '5') {
+        return loadPgm(path, data, frames);
+    }
+    return loadContainer(path, data, frames);
+}
+
+static bool loadLabels(const char* path, std::vector<Label>& labels) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "%s: cannot read\n", path);
+        return false;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || !isdigit(line[0])) continue;  // Comments and header
+
+        int index = -1;
+        float percent = -1.0f;
+        float mm = NAN;
+        char* field = strtok(line, ",");
+        if (field) index = atoi(field);
+        field = strtok(NULL, ",");
+        if (field) percent = (float)atof(field);
+        field = strtok(NULL, ",\r\n");
+        if (field && *field) mm = (float)atof(field);
+        if (index < 0) continue;
+
+        if ((size_t)index >= labels.size()) {
+            Label none = {false, false, -1.0f, NAN};
+            labels.resize(index + 1, none);
+        }
+        labels[index].labeled = true;
+        labels[index].present = percent >= 0.0f;
+        labels[index].positionPercent = percent;
+        labels[index].positionMm = mm;
+    }
+    fclose(f);
+    return true;
+}
+
+static void writePgm(const char* prefix, int index, const Frame& frame) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s_%04d.pgm", prefix, index);
+    FILE* f = fopen(path, "wb");
+    if (!f) return;
+    fprintf(f, "P5\n%d %d\n255\n", frame.width, frame.height);
+    fwrite(frame.pixels.data(), 1, frame.pixels.size(), f);
+    fclose(f);
+}
+
+static double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+static double mean(const std::vector<double>& values) {
+    if (values.empty()) return 0.0;
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    return sum / values.size();
+}
+
+static void printTiming(const char* name, const std::vector<double>& ns) {
+    printf("  %-10s mean %8.0f ns   p50 %8.0f ns   p99 %8.0f ns   max %8.0f ns\n",
+           name, mean(ns), percentile(ns, 0.5), percentile(ns, 0.99), percentile(ns, 1.0));
+}
+
+static void printErrors(const char* name, const char* unit, const ErrorStats& e) {
+    if (e.count == 0) return;
+    printf("  %-10s mean |e| %6.2f %s   rms %6.2f %s   max %6.2f %s   (%d frames)\n",
+           name, e.sumAbs / e.count, unit, sqrt(e.sumSq / e.count), unit, e.maxAbs, unit, e.count);
+}
+
+static void printMatches(const char* name, const MatchStats& m) {
+    printf("  %-10s hit %d   miss %d   false %d   correct reject %d\n",
+           name, m.truePositive, m.falseNegative, m.falsePositive, m.trueNegative);
+}
+
+static void usage() {
+    fprintf(stderr,
+            "usage: replay [--labels FILE] [--csv FILE] [--repeat N] [--threshold N]\n"
+            "              [--min-width N] [--row-step N] [--inlier MM] [--mount H,T,F,O]\n"
+            "              [--dump-pgm PREFIX] <file.lvr | frame.pgm>...\n");
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    std::vector<const char*> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(arg, "--labels") && hasValue) opt.labelsPath = argv[++i];
+        else if (!strcmp(arg, "--csv") && hasValue) opt.csvPath = argv[++i];
+        else if (!strcmp(arg, "--dump-pgm") && hasValue) opt.dumpPrefix = argv[++i];
+        else if (!strcmp(arg, "--repeat") && hasValue) opt.repeat = atoi(argv[++i]);
+        else if (!strcmp(arg, "--threshold") && hasValue) opt.threshold = atoi(argv[++i]);
+        else if (!strcmp(arg, "--min-width") && hasValue) opt.minWidth = atoi(argv[++i]);
+        else if (!strcmp(arg, "--row-step") && hasValue) opt.rowStep = atoi(argv[++i]);
+        else if (!strcmp(arg, "--inlier") && hasValue) opt.inlierMm = (float)atof(argv[++i]);
+        else if (!strcmp(arg, "--mount") && hasValue) {
+            if (sscanf(argv[++i], "%f,%f,%f,%f", &opt.heightMm, &opt.tiltDeg,
+                       &opt.hfovDeg, &opt.offsetMm) != 4) {
+                usage();
+                return 2;
+            }
+        }
+        else if (arg[0] == '-') {
+            usage();
+            return 2;
+        }
+        else inputs.push_back(arg);
+    }
+    if (inputs.empty()) {
+        usage();
+        return 2;
+    }
+    if (opt.repeat < 1) opt.repeat = 1;
+
+    std::vector<Frame> frames;
+    for (const char* path : inputs) {
+        if (!loadFrames(path, frames)) return 1;
+    }
+
+    std::vector<Label> labels;
+    if (opt.labelsPath && !loadLabels(opt.labelsPath, labels)) return 1;
+
+    FILE* csv = NULL;
+    if (opt.csvPath) {
+        csv = fopen(opt.csvPath, "w");
+        if (!csv) {
+            fprintf(stderr, "%s: cannot write\n", opt.csvPath);
+            return 1;
+        }
+        fprintf(csv, "frame,timestamp_us,detected,position_percent,position_mm,heading_rad,"
+                     "curvature,confidence,region_center,junction,markers,detector_ns,regions_ns,blobs_ns\n");
+    }
+
+    LineDetector detector;
+    detector.setMounting(opt.heightMm, opt.tiltDeg, opt.hfovDeg, opt.offsetMm);
+    detector.setThreshold((uint8_t)opt.threshold);
+    detector.setMinWidth(opt.minWidth);
+    detector.setRowStep(opt.rowStep);
+    detector.setInlierTolerance(opt.inlierMm);
+
+    BlobLabeler labeler;
+    JunctionClassifier classifier;
+
+    std::vector<double> detectorNs, regionsNs, blobsNs;
+    int junctionCounts[JUNCTION_FORK + 1] = {0};
+    int markerFrames = 0;
+    int detectorHits = 0, regionHits = 0;
+    ErrorStats detectorPercent, regionPercent, detectorMm;
+    MatchStats detectorMatch, regionMatch;
+    int labeled = 0;
+
+    typedef std::chrono::steady_clock Clock;
+
+    for (size_t i = 0; i < frames.size(); i++) {
+        const Frame& frame = frames[i];
+        const uint8_t* pixels = frame.pixels.data();
+
+        // First pass gives the result, the rest only refine the timing
+        LineEstimate estimate;
+        Clock::time_point start = Clock::now();
+        for (int r = 0; r < opt.repeat; r++) {
+            detector.detect(pixels, frame.width, frame.height, estimate);
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / opt.repeat;
+        detectorNs.push_back(ns);
+
+        RegionCenters regions;
+        start = Clock::now();
+        for (int r = 0; r < opt.repeat; r++) {
+            scanThreeRegions(pixels, frame.width, frame.height, opt.rowStep,
+                             (uint8_t)opt.threshold, opt.minWidth, regions);
+        }
+        double regionNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / opt.repeat;
+        regionsNs.push_back(regionNs);
+
+        SceneInfo scene;
+        start = Clock::now();
+        for (int r = 0; r < opt.repeat; r++) {
+            labeler.label(pixels, frame.width, frame.height, (uint8_t)opt.threshold);
+            classifier.classify(labeler, scene);
+        }
+        double blobNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / opt.repeat;
+        blobsNs.push_back(blobNs);
+        junctionCounts[scene.junction]++;
+        if (scene.markerLeft || scene.markerRight) markerFrames++;
+
+        int regionCenter = regionMainCenter(regions);
+        bool regionDetected = regionCenter >= 0;
+        float regionPercentValue = regionDetected ? (regionCenter * 100.0f) / frame.width : -1.0f;
+
+        if (estimate.detected) detectorHits++;
+        if (regionDetected) regionHits++;
+
+        if (i < labels.size() && labels[i].labeled) {
+            const Label& label = labels[i];
+            labeled++;
+            detectorMatch.add(estimate.detected, label.present);
+            regionMatch.add(regionDetected, label.present);
+            if (label.present) {
+                if (estimate.detected) {
+                    detectorPercent.add(estimate.positionPercent - label.positionPercent);
+                    if (!isnan(label.positionMm)) detectorMm.add(estimate.positionMm - label.positionMm);
+                }
+                if (regionDetected) regionPercent.add(regionPercentValue - label.positionPercent);
+            }
+        }
+
+        if (csv) {
+            fprintf(csv, "%zu,%u,%d,%d,%.1f,%.4f,%.2f,%d,%d,%s,%s%s,%.0f,%.0f,%.0f\n",
+                    i, frame.timestampUs, estimate.detected ? 1 : 0, estimate.positionPercent,
+                    estimate.positionMm, estimate.headingRad, estimate.curvature,
+                    estimate.confidence, regionCenter, junctionName(scene.junction),
+                    scene.markerLeft ? "L" : "", scene.markerRight ? "R" : "",
+                    ns, regionNs, blobNs);
+        }
+        if (opt.dumpPrefix) writePgm(opt.dumpPrefix, (int)i, frame);
+    }
+    if (csv) fclose(csv);
+
+    int count = (int)frames.size();
+    printf("%d frames, %dx%d", count, frames[0].width, frames[0].height);
+    if (count > 1 && frames.back().timestampUs > frames[0].timestampUs) {
+        double seconds = (frames.back().timestampUs - frames[0].timestampUs) / 1e6;
+        printf(", %.1f fps recorded", (count - 1) / seconds);
+    }
+    printf("\n\nTime per frame (host, %d repetitions):\n", opt.repeat);
+    printTiming("detector", detectorNs);
+    printTiming("regions", regionsNs);
+    printTiming("blobs", blobsNs);
+
+    printf("\nDetection rate:\n");
+    printf("  %-10s %5.1f %%\n", "detector", 100.0 * detectorHits / count);
+    printf("  %-10s %5.1f %%\n", "regions", 100.0 * regionHits / count);
+
+    printf("\nJunctions:\n");
+    for (int j = JUNCTION_CROSS; j <= JUNCTION_FORK; j++) {
+        if (junctionCounts[j] > 0) {
+            printf("  %-12s %d frames\n", junctionName((JunctionType)j), junctionCounts[j]);
+        }
+    }
+    printf("  %-12s %d frames\n", "markers", markerFrames);
+
+    if (labeled > 0) {
+        printf("\nAgainst %d labeled frames:\n", labeled);
+        printMatches("detector", detectorMatch);
+        printMatches("regions", regionMatch);
+        printf("\nPosition error:\n");
+        printErrors("detector", "%", detectorPercent);
+        printErrors("regions", "%", regionPercent);
+        printErrors("detector", "mm", detectorMm);
+    }
+
+    return 0;
+}
@@ -0,0 +1,424 @@
+/*
+ * vision_test - host test of the blob labeler, junction classifier and
+ * contrast exposure controller
+ *
+ *   make test
+ *
+ * Draws synthetic grayscale frames (a straight line, cross, T, corner, fork
+ * and side markers) and checks the BlobLabeler output - union-find merging,
+ * 8-connectivity, minimum area and the area-ordered cut at BLOB_MAX_COUNT -
+ * and the JunctionClassifier junction, exits and marker results. Then runs
+ * ContrastExposure::update against a simulated scene: convergence to the
+ * separation optimum, the clip and underexposure limits, and turning around
+ * when pinned at the lowest or highest light level.
+ */
+
+#include <BlobLabeler.h>
+#include <ContrastExposure.h>
+#include <JunctionClassifier.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+#define FRAME_W 96
+#define FRAME_H 96
+#define FIELD   220
+#define LINE    40
+#define THRESHOLD 128
+
+// Line width in the synthetic frames
+#define LW 10
+
+static uint8_t frame[160 * 120];
+
+static void clear(int w, int h) {
+    memset(frame, FIELD, w * h);
+}
+
+// Dark rectangle, inclusive corners
+static void rect(int w, int x0, int y0, int x1, int y1) {
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) frame[y * w + x] = LINE;
+    }
+}
+
+// Vertical line through the middle, rows y0..y1
+static void stem(int y0, int y1) {
+    rect(FRAME_W, 43, y0, 43 + LW - 1, y1);
+}
+
+static void classify(BlobLabeler& labeler, SceneInfo& scene) {
+    labeler.label(frame, FRAME_W, FRAME_H, THRESHOLD);
+    JunctionClassifier classifier;
+    classifier.classify(labeler, scene);
+}
+
+static void testMerging() {
+    BlobLabeler labeler;
+    int count;
+
+    // U: two bars labeled apart row by row, joined by the bottom rows
+    clear(FRAME_W, FRAME_H);
+    rect(FRAME_W, 10, 0, 19, 59);
+    rect(FRAME_W, 40, 0, 49, 59);
+    rect(FRAME_W, 10, 60, 49, 69);
+    CHECK(labeler.label(frame, FRAME_W, FRAME_H, THRESHOLD) == 1);
+    const Blob* blobs = labeler.getBlobs(count);
+    CHECK(blobs[0].area == 2 * 10 * 60 + 40 * 10);
+    CHECK(blobs[0].minX == 10 && blobs[0].maxX == 49);
+    CHECK(blobs[0].minY == 0 && blobs[0].maxY == 69);
+    CHECK(blobs[0].edges == BLOB_EDGE_TOP);
+
+    // W: three bars, the middle one joining late - chained unions
+    clear(FRAME_W, FRAME_H);
+    rect(FRAME_W, 0, 0, 9, 79);
+    rect(FRAME_W, 30, 0, 39, 79);
+    rect(FRAME_W, 60, 0, 69, 89);
+    rect(FRAME_W, 0, 80, 39, 84);
+    rect(FRAME_W, 35, 85, 69, 89);
+    CHECK(labeler.label(frame, FRAME_W, FRAME_H, THRESHOLD) == 1);
+
+    // Diagonal staircases both ways: pixels touching only at corners
+    // (8-connectivity)
+    clear(FRAME_W, FRAME_H);
+    for (int i = 0; i < 20; i++) frame[(10 + i) * FRAME_W + 10 + i] = LINE;
+    for (int i = 0; i < 20; i++) frame[(50 + i) * FRAME_W + 80 - i] = LINE;
+    CHECK(labeler.label(frame, FRAME_W, FRAME_H, THRESHOLD) == 2);
+    blobs = labeler.getBlobs(count);
+    CHECK(blobs[0].area == 20 && blobs[1].area == 20);
+    CHECK(blobs[0].elongation > 10.0f);
+
+    // One clear pixel between runs: separate blobs, below minArea dropped
+    clear(FRAME_W, FRAME_H);
+    rect(FRAME_W, 10, 10, 19, 19);
+    rect(FRAME_W, 21, 10, 30, 19);
+    rect(FRAME_W, 50, 50, 51, 50);
+    CHECK(labeler.label(frame, FRAME_W, FRAME_H, THRESHOLD) == 2);
+    labeler.setMinArea(1);
+    CHECK(labeler.label(frame, FRAME_W, FRAME_H, THRESHOLD) == 3);
+}
+
+static void testTruncation() {
+    // 20 bars 4 rows high with widths 2..21 in shuffled order on a 160x120
+    // frame: the 16 largest are kept, largest first
+    const int w = 160;
+    const int h = 120;
+    clear(w, h);
+    for (int i = 0; i < 20; i++) {
+        int width = 2 + (i * 7) % 20;
+        rect(w, 5 + i * 3, i * 6, 5 + i * 3 + width - 1, i * 6 + 3);
+    }
+
+    BlobLabeler labeler;
+    CHECK(labeler.label(frame, w, h, THRESHOLD) == BLOB_MAX_COUNT);
+    int count;
+    const Blob* blobs = labeler.getBlobs(count);
+    CHECK(count == BLOB_MAX_COUNT);
+    CHECK(blobs[0].area == 4 * 21);
+    CHECK(blobs[BLOB_MAX_COUNT - 1].area == 4 * (21 - BLOB_MAX_COUNT + 1));
+    for (int i = 1; i < count; i++) CHECK(blobs[i].area < blobs[i - 1].area);
+    CHECK(!labeler.isTruncated());
+
+    // Runs of the dropped bars point nowhere, kept ones at their blob
+    int dropped = 0;
+    for (int i = 0; i < 20; i++) {
+        int runs;
+        const BlobRun* row = labeler.getRowRuns(i * 6, runs);
+        CHECK(runs == 1);
+        int width = 2 + (i * 7) % 20;
+        if (row[0].blob < 0) {
+            dropped++;
+            CHECK(width < 21 - BLOB_MAX_COUNT + 1);
+        } else {
+            CHECK(blobs[row[0].blob].area == 4 * width);
+        }
+    }
+    CHECK(dropped == 20 - BLOB_MAX_COUNT);
+}
+
+static void testStraightLine() {
+    BlobLabeler labeler;
+    SceneInfo scene;
+    clear(FRAME_W, FRAME_H);
+    stem(0, FRAME_H - 1);
+    classify(labeler, scene);
+
+    CHECK(scene.junction == JUNCTION_NONE);
+    CHECK(scene.exits == JUNCTION_EXIT_AHEAD);
+    CHECK(scene.junctionRow == -1);
+    CHECK(scene.mainBlob == 0);
+    CHECK(scene.lineWidthPx == LW);
+    CHECK(!scene.markerLeft && !scene.markerRight);
+
+    // Empty frame
+    clear(FRAME_W, FRAME_H);
+    classify(labeler, scene);
+    CHECK(scene.junction == JUNCTION_NONE);
+    CHECK(scene.exits == 0);
+    CHECK(scene.mainBlob == -1);
+}
+
+static void testCrossAndT() {
+    BlobLabeler labeler;
+    SceneInfo scene;
+
+    clear(FRAME_W, FRAME_H);
+    stem(0, FRAME_H - 1);
+    rect(FRAME_W, 0, 40, FRAME_W - 1, 49);
+    classify(labeler, scene);
+    CHECK(scene.junction == JUNCTION_CROSS);
+    CHECK(scene.exits == (JUNCTION_EXIT_LEFT | JUNCTION_EXIT_RIGHT | JUNCTION_EXIT_AHEAD));
+    CHECK(scene.junctionRow == 49);
+    CHECK(scene.lineWidthPx == LW);
+    CHECK(strcmp(junctionName(scene.junction), "cross") == 0);
+
+    // Nothing above the bar
+    clear(FRAME_W, FRAME_H);
+    stem(40, FRAME_H - 1);
+    rect(FRAME_W, 0, 40, FRAME_W - 1, 49);
+    classify(labeler, scene);
+    CHECK(scene.junction == JUNCTION_T);
+    CHECK(scene.exits == (JUNCTION_EXIT_LEFT | JUNCTION_EXIT_RIGHT));
+    CHECK(scene.junctionRow == 49);
+}
+
+static void testCornerAndBranch() {
+    BlobLabeler labeler;
+    SceneInfo scene;
+
+    // 90-degree corner to the left
+    clear(FRAME_W, FRAME_H);
+    stem(40, FRAME_H - 1);
+    rect(FRAME_W, 0, 40, 43 + LW - 1, 49);
+    classify(labeler, scene);
+    CHECK(scene.junction == JUNCTION_TURN_LEFT);
+    CHECK(scene.exits == JUNCTION_EXIT_LEFT);
+
+    // And to the right
+    clear(FRAME_W, FRAME_H);
+    stem(40, FRAME_H - 1);
+    rect(FRAME_W, 43, 40, FRAME_W - 1, 49);
+    classify(labeler, scene);
+    CHECK(scene.junction == JUNCTION_TURN_RIGHT);
+    CHECK(scene.exits == JUNCTION_EXIT_RIGHT);
+
+    // Line continues: a branch, not a corner
+    clear(FRAME_W, FRAME_H);
+    stem(0, FRAME_H - 1);
+    rect(FRAME_W, 43, 40, FRAME_W - 1, 49);
+    classify(labeler, scene);
+    CHECK(scene.junction == JUNCTION_BRANCH_RIGHT);
+    CHECK(scene.exits == (JUNCTION_EXIT_RIGHT | JUNCTION_EXIT_AHEAD));
+}
+
+static void testFork() {
+    // Stem up to row 60, then two arms spreading half a pixel per row
+    BlobLabeler labeler;
+    SceneInfo scene;
+    clear(FRAME_W, FRAME_H);
+    stem(60, FRAME_H - 1);
+    for (int y = 0; y < 60; y++) {
+        int offset = (60 - y) / 2;
+        rect(FRAME_W, 43 - offset, y, 43 - offset + LW - 1, y);
+        rect(FRAME_W, 43 + offset, y, 43 + offset + LW - 1, y);
+    }
+    classify(labeler, scene);
+
+    int count;
+    labeler.getBlobs(count);
+    CHECK(count == 1);
+    CHECK(scene.junction == JUNCTION_FORK);
+    CHECK(scene.exits == (JUNCTION_EXIT_LEFT | JUNCTION_EXIT_RIGHT));
+    // Arms separate once they are more than a line width apart
+    CHECK(scene.junctionRow >= 35 && scene.junctionRow < 60);
+}
+
+static void testMarkers() {
+    BlobLabeler labeler;
+    SceneInfo scene;
+
+    clear(FRAME_W, FRAME_H);
+    stem(0, FRAME_H - 1);
+    rect(FRAME_W, 70, 40, 70 + LW - 1, 40 + LW - 1);
+    classify(labeler, scene);
+    CHECK(scene.junction == JUNCTION_NONE);
+    CHECK(scene.mainBlob == 0);
+    CHECK(scene.markerRight && !scene.markerLeft);
+
+    clear(FRAME_W, FRAME_H);
+    stem(0, FRAME_H - 1);
+    rect(FRAME_W, 15, 40, 15 + LW - 1, 40 + LW - 1);
+    classify(labeler, scene);
+    CHECK(scene.markerLeft && !scene.markerRight);
+
+    // Too long to be a marker (a parallel line), or too small (a speck)
+    clear(FRAME_W, FRAME_H);
+    stem(0, FRAME_H - 1);
+    rect(FRAME_W, 70, 10, 70 + LW - 1, 70);
+    rect(FRAME_W, 15, 40, 17, 42);
+    classify(labeler, scene);
+    CHECK(!scene.markerLeft && !scene.markerRight);
+
+    // Marker larger than the visible line: the main line is still the one
+    // reaching the bottom edge
+    clear(FRAME_W, FRAME_H);
+    stem(80, FRAME_H - 1);
+    rect(FRAME_W, 65, 20, 65 + 2 * LW - 1, 20 + 2 * LW - 1);
+    classify(labeler, scene);
+    int count;
+    const Blob* blobs = labeler.getBlobs(count);
+    CHECK(count == 2);
+    CHECK(scene.mainBlob == 1);
+    CHECK(blobs[scene.mainBlob].edges & BLOB_EDGE_BOTTOM);
+}
+
+// Contrast statistics of a scene whose separation peaks at one light level
+static ContrastStats sceneStats(int exposure, int gain, float bestLevel) {
+    float level = exposure * ContrastExposure::gainMultiplier(gain);
+    float d = (level - bestLevel) / bestLevel;
+    ContrastStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.valid = true;
+    stats.linePeak = 30;
+    stats.fieldPeak = 200;
+    stats.separation = (int)(150.0f - 100.0f * d * d);
+    return stats;
+}
+
+static void testExposureConvergence() {
+    const float best = 2000.0f;   // Above maxExposure: needs some gain
+    ContrastExposure controller;
+    controller.setLimits(8, 600, 12);
+    controller.setSettleFrames(0);
+    controller.reset(100, 0);
+
+    int exposure = 100;
+    int gain = 0;
+    int lateWrites = 0;
+    for (int f = 0; f < 600; f++) {
+        ContrastStats stats = sceneStats(exposure, gain, best);
+        int e, g;
+        if (controller.update(stats, e, g)) {
+            CHECK(e >= 8 && e <= 600 && g >= 0 && g <= 12);
+            exposure = e;
+            gain = g;
+            if (f >= 500) lateWrites++;
+        }
+    }
+    float level = exposure * ContrastExposure::gainMultiplier(gain);
+    CHECK(fabsf(level - best) < 0.2f * best);
+    CHECK(gain > 0);
+    // Converged: only the occasional probe, not a write every frame
+    CHECK(lateWrites < 20);
+}
+
+static void testExposureLimits() {
+    ContrastExposure controller;
+    controller.setLimits(8, 600, 12);
+    controller.setSettleFrames(0);
+    int e, g;
+
+    // Clipped field: darker, even while separation keeps improving
+    controller.reset(400, 0);
+    int exposure = 400;
+    for (int i = 0; i < 5; i++) {
+        ContrastStats stats = sceneStats(exposure, 0, 5000.0f);
+        stats.clippedPermille = 100;
+        stats.separation += i * 20;
+        CHECK(controller.update(stats, e, g));
+        CHECK(e < exposure && g == 0);
+        exposure = e;
+    }
+
+    // Dark field: brighter, even while separation drops
+    controller.reset(100, 0);
+    exposure = 100;
+    for (int i = 0; i < 5; i++) {
+        ContrastStats stats = sceneStats(exposure, 0, 50.0f);
+        stats.fieldPeak = 90;
+        stats.separation -= i * 20;
+        CHECK(controller.update(stats, e, g));
+        CHECK(e > exposure);
+        exposure = e;
+    }
+
+    // Stats without a line: no change
+    ContrastStats none;
+    memset(&none, 0, sizeof(none));
+    CHECK(!controller.update(none, e, g));
+}
+
+static void testExposurePinned() {
+    ContrastExposure controller;
+    controller.setLimits(8, 600, 12);
+    controller.setSettleFrames(0);
+    float maxLevel = 600 * ContrastExposure::gainMultiplier(12);
+    int e, g;
+
+    // At the lowest level and told to go darker: no write, then the
+    // search turns around and goes brighter
+    controller.reset(8, 0);
+    ContrastStats stats = sceneStats(8, 0, 2000.0f);
+    stats.clippedPermille = 100;
+    CHECK(!controller.update(stats, e, g));
+    stats.clippedPermille = 0;
+    CHECK(controller.update(stats, e, g));
+    CHECK(e > 8 && g == 0);
+
+    // At the highest level and told to go brighter: turns around to darker
+    controller.reset(600, 12);
+    stats = sceneStats(600, 12, 2000.0f);
+    stats.fieldPeak = 90;
+    CHECK(!controller.update(stats, e, g));
+    stats.fieldPeak = 200;
+    CHECK(controller.update(stats, e, g));
+    CHECK(e * ContrastExposure::gainMultiplier(g) < maxLevel);
+
+    // Flat separation at a limit does not stall the search either
+    controller.reset(600, 12);
+    int exposure = 600;
+    int gain = 12;
+    int writes = 0;
+    for (int f = 0; f < 20; f++) {
+        ContrastStats flat = sceneStats(exposure, gain, 2000.0f);
+        flat.separation = 100;
+        if (controller.update(flat, e, g)) {
+            exposure = e;
+            gain = g;
+            writes++;
+        }
+    }
+    CHECK(writes > 0);
+    CHECK(exposure * ContrastExposure::gainMultiplier(gain) < maxLevel);
+}
+
+int main() {
+    testMerging();
+    testTruncation();
+    testStraightLine();
+    testCrossAndT();
+    testCornerAndBranch();
+    testFork();
+    testMarkers();
+    testExposureConvergence();
+    testExposureLimits();
+    testExposurePinned();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("vision_test: all checks passed\n");
+    return 0;
+}
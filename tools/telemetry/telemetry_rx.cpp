@@ -0,0 +1,224 @@
+/*
+ * telemetry_rx - receive robot UDP telemetry, write CSV, print live stats
+ *
+ *   telemetry_rx [--port N] [--csv FILE] [--quiet]
+ *
+ * Listens on UDP (default 4210, TELEMETRY_PORT in src/Config.h), decodes
+ * datagrams with the firmware's own TelemetryFormat.h and prints once per
+ * second: datagrams and records per second, datagrams lost (sequence gaps),
+ * duplicated or reordered, records dropped on the robot, and the latest
+ * state. Stops on Ctrl+C with a final summary.
+ */
+
+#include <TelemetryFormat.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t running = 1;
+
+static void onSignal(int) {
+    running = 0;
+}
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const char* stateNames[] = {
+    "IDLE", "CALIBRATING", "FOLLOWING", "SEARCHING_LEFT", "SEARCHING_RIGHT",
+    "LOST", "STOPPED", "BRAKE_TEST", "SYSID"
+};
+
+struct Stats {
+    uint64_t packets;
+    uint64_t records;
+    uint64_t lost;          // Sequence numbers never seen (gaps)
+    uint64_t late;          // Older than the newest seen: reordered or duplicate
+    uint64_t invalid;       // Not a telemetry datagram
+    uint32_t robotDropped;  // Latest cumulative count from the robot
+    bool started;
+    uint32_t nextSequence;
+};
+
+static void writeCsvRecord(FILE* csv, uint32_t sequence, const BlackBoxRecord& r) {
+    char sensors[6];
+    for (int s = 0; s < 5; s++) sensors[s] = (r.sensorMask & (1 << s)) ? '1' : '0';
+    sensors[5] = 0;
+
+    fprintf(csv, "%u,%.3f,", sequence, r.timeUs / 1000.0);
+    if (r.position == BLACKBOX_NO_LINE) {
+        fprintf(csv, ",");
+    } else {
+        fprintf(csv, "%.3f,", r.position / 1000.0);
+    }
+    fprintf(csv, "%.1f,%d,%d,%d,%d,%s,%s,%d,%d,%d\n",
+            r.correction / 10.0, r.leftCommand, r.rightCommand, r.leftSpeed, r.rightSpeed,
+            sensors, r.state < sizeof(stateNames) / sizeof(stateNames[0]) ? stateNames[r.state] : "?",
+            (r.flags & BLACKBOX_FLAG_MEMORY) != 0,
+            (r.flags & BLACKBOX_FLAG_BRAKING) != 0,
+            (r.flags & BLACKBOX_FLAG_LAUNCH) != 0);
+}
+
+int main(int argc, char** argv) {
+    int port = 4210;
+    const char* csvPath = nullptr;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csvPath = argv[++i];
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else {
+            fprintf(stderr, "usage: telemetry_rx [--port N] [--csv FILE] [--quiet]\n");
+            return 1;
+        }
+    }
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        perror("socket");
+        return 1;
+    }
+    int yes = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        return 1;
+    }
+
+    // Wake up at least every 200 ms for stats and Ctrl+C
+    struct timeval timeout = {0, 200000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onSignal;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    FILE* csv = nullptr;
+    if (csvPath) {
+        csv = fopen(csvPath, "w");
+        if (!csv) {
+            perror(csvPath);
+            return 1;
+        }
+        fprintf(csv, "sequence,robot_ms,position,correction,cmd_left,cmd_right,speed_left,speed_right,"
+                     "sensors,state,memory,braking,launch\n");
+    }
+
+    fprintf(stderr, "listening on UDP %d%s%s\n", port, csv ? ", writing " : "", csv ? csvPath : "");
+
+    Stats total;
+    memset(&total, 0, sizeof(total));
+    Stats window = total;
+    double windowStart = now();
+    double start = windowStart;
+    BlackBoxRecord last;
+    bool haveLast = false;
+
+    static uint8_t buffer[65536];
+    static BlackBoxRecord records[TELEMETRY_MAX_BATCH];
+
+    while (running) {
+        ssize_t length = recv(sock, buffer, sizeof(buffer), 0);
+        if (length >= 0) {
+            TelemetryHeader header;
+            int count = telemetryUnpack(buffer, (size_t)length, header, records);
+            if (count < 0) {
+                total.invalid++;
+                window.invalid++;
+            } else {
+                total.packets++;
+                window.packets++;
+                total.records += count;
+                window.records += count;
+                total.robotDropped = header.dropped;
+
+                // Gaps are lost, anything behind the newest is late
+                if (!total.started) {
+                    total.started = true;
+                    total.nextSequence = header.sequence + 1;
+                } else if ((int32_t)(header.sequence - total.nextSequence) >= 0) {
+                    uint32_t gap = header.sequence - total.nextSequence;
+                    total.lost += gap;
+                    window.lost += gap;
+                    total.nextSequence = header.sequence + 1;
+                } else {
+                    total.late++;
+                    window.late++;
+                    // Arrived after all
+                    if (total.lost > 0) total.lost--;
+                    if (window.lost > 0) window.lost--;
+                }
+
+                if (csv) {
+                    for (int i = 0; i < count; i++) writeCsvRecord(csv, header.sequence, records[i]);
+                }
+                if (count > 0) {
+                    last = records[count - 1];
+                    haveLast = true;
+                }
+            }
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            perror("recv");
+            break;
+        }
+
+        double t = now();
+        if (t - windowStart >= 1.0) {
+            double seconds = t - windowStart;
+            if (!quiet) {
+                fprintf(stderr, "%6.1f s  %5.0f pkt/s  %6.0f rec/s  lost %llu  late %llu  robot dropped %u",
+                        t - start, window.packets / seconds, window.records / seconds,
+                        (unsigned long long)window.lost, (unsigned long long)window.late,
+                        total.robotDropped);
+                if (haveLast) {
+                    fprintf(stderr, "  | %s pos ",
+                            last.state < sizeof(stateNames) / sizeof(stateNames[0]) ? stateNames[last.state] : "?");
+                    if (last.position == BLACKBOX_NO_LINE) {
+                        fprintf(stderr, "-");
+                    } else {
+                        fprintf(stderr, "%+.2f", last.position / 1000.0);
+                    }
+                    fprintf(stderr, " L%d R%d", last.leftCommand, last.rightCommand);
+                }
+                fprintf(stderr, "\n");
+            }
+            if (csv) fflush(csv);
+            memset(&window, 0, sizeof(window));
+            windowStart = t;
+        }
+    }
+
+    uint64_t expected = total.packets + total.lost;
+    fprintf(stderr, "\n%llu datagrams, %llu records, lost %llu (%.2f%%), late %llu, invalid %llu, robot dropped %u\n",
+            (unsigned long long)total.packets, (unsigned long long)total.records,
+            (unsigned long long)total.lost, expected ? 100.0 * total.lost / expected : 0.0,
+            (unsigned long long)total.late, (unsigned long long)total.invalid, total.robotDropped);
+
+    if (csv) fclose(csv);
+    close(sock);
+    return 0;
+}
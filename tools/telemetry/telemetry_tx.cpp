@@ -0,0 +1,132 @@
+/*
+ * telemetry_tx - loopback sender for testing telemetry_rx without a robot
+ *
+ *   telemetry_tx [--host IP] [--port N] [--rate HZ] [--batch N]
+ *                [--seconds S] [--loss PERCENT] [--reorder PERCENT]
+ *
+ * Generates records of a robot weaving over the line and packs them with
+ * the firmware's telemetryPack() (src/TelemetryFormat.h), so the receiver
+ * is tested against the exact datagram layout the robot sends. --loss
+ * skips datagrams (sequence numbers still advance) and --reorder swaps a
+ * datagram with the next one, to check the receiver's loss accounting.
+ */
+
+#include <TelemetryFormat.h>
+
+#include <arpa/inet.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+static void sleepSeconds(double s) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)s;
+    ts.tv_nsec = (long)((s - ts.tv_sec) * 1e9);
+    nanosleep(&ts, nullptr);
+}
+
+int main(int argc, char** argv) {
+    const char* host = "127.0.0.1";
+    int port = 4210;
+    int rate = 100;
+    int batch = 32;
+    double seconds = 5.0;
+    double lossPercent = 0.0;
+    double reorderPercent = 0.0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--host") == 0 && hasValue) host = argv[++i];
+        else if (strcmp(argv[i], "--port") == 0 && hasValue) port = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rate") == 0 && hasValue) rate = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--batch") == 0 && hasValue) batch = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seconds") == 0 && hasValue) seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "--loss") == 0 && hasValue) lossPercent = atof(argv[++i]);
+        else if (strcmp(argv[i], "--reorder") == 0 && hasValue) reorderPercent = atof(argv[++i]);
+        else {
+            fprintf(stderr, "usage: telemetry_tx [--host IP] [--port N] [--rate HZ] [--batch N]\n"
+                            "                    [--seconds S] [--loss PERCENT] [--reorder PERCENT]\n");
+            return 1;
+        }
+    }
+    if (rate < 1) rate = 1;
+    if (batch < 1) batch = 1;
+    if (batch > TELEMETRY_MAX_BATCH) batch = TELEMETRY_MAX_BATCH;
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        perror("socket");
+        return 1;
+    }
+    int yes = 1;
+    setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &yes, sizeof(yes));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+        fprintf(stderr, "bad host %s\n", host);
+        return 1;
+    }
+
+    srand(1);
+    std::vector<BlackBoxRecord> records(batch);
+    std::vector<uint8_t> held;
+    uint8_t packet[TELEMETRY_PACKET_MAX];
+    uint32_t sequence = 0;
+    unsigned sent = 0, skipped = 0, swapped = 0;
+
+    long total = (long)(seconds * rate);
+    for (long n = 0; n < total; n += batch) {
+        int count = total - n < batch ? (int)(total - n) : batch;
+        for (int i = 0; i < count; i++) {
+            double t = (n + i) / (double)rate;
+            double position = 1.5 * sin(2 * M_PI * 0.5 * t);
+            BlackBoxRecord& r = records[i];
+            memset(&r, 0, sizeof(r));
+            r.timeUs = (uint32_t)(t * 1e6);
+            r.position = fabs(position) > 1.4 ? BLACKBOX_NO_LINE : (int16_t)(position * 1000);
+            r.correction = (int16_t)(position * 300);
+            r.leftCommand = (int16_t)(150 + position * 30);
+            r.rightCommand = (int16_t)(150 - position * 30);
+            r.leftSpeed = (int16_t)(r.leftCommand * 6);
+            r.rightSpeed = (int16_t)(r.rightCommand * 6);
+            r.sensorMask = (uint8_t)(1 << (int)lround(position + 2.0));
+            r.state = 2;  // FOLLOWING
+        }
+
+        size_t length = telemetryPack(packet, sequence++, 0, records.data(), (uint16_t)count);
+
+        if (rand() % 10000 < lossPercent * 100) {
+            skipped++;
+        } else if (held.empty() && rand() % 10000 < reorderPercent * 100) {
+            held.assign(packet, packet + length);  // Goes out after the next one
+            swapped++;
+        } else {
+            sendto(sock, packet, length, 0, (struct sockaddr*)&addr, sizeof(addr));
+            sent++;
+            if (!held.empty()) {
+                sendto(sock, held.data(), held.size(), 0, (struct sockaddr*)&addr, sizeof(addr));
+                held.clear();
+                sent++;
+            }
+        }
+        sleepSeconds(count / (double)rate);
+    }
+    if (!held.empty()) {
+        sendto(sock, held.data(), held.size(), 0, (struct sockaddr*)&addr, sizeof(addr));
+        sent++;
+    }
+
+    fprintf(stderr, "sent %u datagrams (%u skipped, %u reordered) to %s:%d\n",
+            sent, skipped, swapped, host, port);
+    close(sock);
+    return 0;
+}